@@ -0,0 +1,139 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Synthetic inputs of realistic size shared by the benchmarks */
+
+#ifndef LIVOX_ROS_DRIVER_BENCHMARK_UTIL_H_
+#define LIVOX_ROS_DRIVER_BENCHMARK_UTIL_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "livox_lidar_def.h"
+#include "comm/comm.h"
+
+namespace livox_ros {
+namespace benchmark_util {
+
+const uint32_t kPointsPerPacket = 96;        /**< Mid-360 and HAP packets */
+const uint32_t kMid360PointsPerFrame = 20000; /**< 200k points/s at 10 Hz */
+const uint32_t kHapPointsPerFrame = 45200;    /**< 452k points/s at 10 Hz */
+const uint64_t kPointIntervalNs = 5000;
+
+/** Deterministic points in the Mid-360 field of view, depth in mm and angles in degree */
+inline void SyntheticPoint(uint32_t index, double& depth, double& zenith, double& azimuth) {
+  azimuth = fmod(index * 137.50776405, 360.0);
+  zenith = 90.0 - (-7.0 + 59.0 * fmod(index * 0.61803398875, 1.0));
+  depth = 5000.0 + 3000.0 * (0.5 + 0.5 * sin(azimuth * 4.0 * M_PI / 180.0));
+}
+
+/** Raw packets of one frame as PubHandler hands them to LidarPubHandler */
+inline std::vector<RawPacket> MakeRawPackets(uint8_t data_type, uint32_t points_num, bool extrinsic_enable) {
+  uint32_t point_size = sizeof(LivoxLidarCartesianHighRawPoint);
+  if (data_type == kLivoxLidarCartesianCoordinateLowData) {
+    point_size = sizeof(LivoxLidarCartesianLowRawPoint);
+  } else if (data_type == kLivoxLidarSphericalCoordinateData) {
+    point_size = sizeof(LivoxLidarSpherPoint);
+  }
+
+  std::vector<RawPacket> packets((points_num + kPointsPerPacket - 1) / kPointsPerPacket);
+  uint32_t index = 0;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    RawPacket& packet = packets[i];
+    packet.lidar_type = kLivoxLidarType;
+    packet.handle = 0x0C01A8C0;
+    packet.extrinsic_enable = extrinsic_enable;
+    packet.point_num = std::min(kPointsPerPacket, points_num - index);
+    packet.data_type = data_type;
+    packet.line_num = kLineNumberMid360;
+    packet.time_stamp = 1000000000ULL + index * kPointIntervalNs;
+    packet.point_interval = kPointIntervalNs;
+    packet.time_type = 0;
+    packet.recv_time = packet.time_stamp;
+    packet.raw_data.resize(packet.point_num * point_size);
+
+    for (uint32_t j = 0; j < packet.point_num; ++j, ++index) {
+      double depth = 0.0;
+      double zenith = 0.0;
+      double azimuth = 0.0;
+      SyntheticPoint(index, depth, zenith, azimuth);
+      double x = depth * sin(zenith * M_PI / 180.0) * cos(azimuth * M_PI / 180.0);
+      double y = depth * sin(zenith * M_PI / 180.0) * sin(azimuth * M_PI / 180.0);
+      double z = depth * cos(zenith * M_PI / 180.0);
+      uint8_t* raw = packet.raw_data.data() + j * point_size;
+      if (data_type == kLivoxLidarCartesianCoordinateHighData) {
+        LivoxLidarCartesianHighRawPoint point = {static_cast<int32_t>(x), static_cast<int32_t>(y),
+                                                 static_cast<int32_t>(z), static_cast<uint8_t>(index), 0};
+        memcpy(raw, &point, sizeof(point));
+      } else if (data_type == kLivoxLidarCartesianCoordinateLowData) {
+        LivoxLidarCartesianLowRawPoint point = {static_cast<int16_t>(x / 10.0), static_cast<int16_t>(y / 10.0),
+                                                static_cast<int16_t>(z / 10.0), static_cast<uint8_t>(index), 0};
+        memcpy(raw, &point, sizeof(point));
+      } else {
+        LivoxLidarSpherPoint point = {static_cast<uint32_t>(depth), static_cast<uint16_t>(zenith * 100.0),
+                                      static_cast<uint16_t>(azimuth * 100.0), static_cast<uint8_t>(index), 0};
+        memcpy(raw, &point, sizeof(point));
+      }
+    }
+  }
+  return packets;
+}
+
+/** Decoded points of one frame */
+inline std::vector<PointXyzlt> MakePoints(uint32_t points_num) {
+  std::vector<PointXyzlt> points(points_num);
+  for (uint32_t i = 0; i < points_num; ++i) {
+    double depth = 0.0;
+    double zenith = 0.0;
+    double azimuth = 0.0;
+    SyntheticPoint(i, depth, zenith, azimuth);
+    points[i].x = static_cast<float>(depth / 1000.0 * sin(zenith * M_PI / 180.0) * cos(azimuth * M_PI / 180.0));
+    points[i].y = static_cast<float>(depth / 1000.0 * sin(zenith * M_PI / 180.0) * sin(azimuth * M_PI / 180.0));
+    points[i].z = static_cast<float>(depth / 1000.0 * cos(zenith * M_PI / 180.0));
+    points[i].intensity = static_cast<float>(i % 256);
+    points[i].tag = 0;
+    points[i].line = static_cast<uint8_t>(i % kLineNumberMid360);
+    points[i].offset_time = 1000000000ULL + i * kPointIntervalNs;
+  }
+  return points;
+}
+
+/** Reports throughput as points/s and cost as time/point, printed in ns */
+inline void SetPointCounters(benchmark::State& state, uint64_t points_per_iteration) {
+  double points = static_cast<double>(points_per_iteration) * state.iterations();
+  state.counters["points/s"] = benchmark::Counter(points, benchmark::Counter::kIsRate);
+  state.counters["time/point"] = benchmark::Counter(points,
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+}  // namespace benchmark_util
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER_BENCHMARK_UTIL_H_
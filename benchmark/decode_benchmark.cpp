@@ -0,0 +1,122 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Decode and queue kernels of the point cloud path */
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_util.h"
+#include "comm/ldq.h"
+#include "comm/pub_handler.h"
+
+namespace livox_ros {
+namespace {
+
+using benchmark_util::MakePoints;
+using benchmark_util::MakeRawPackets;
+using benchmark_util::SetPointCounters;
+
+/** Decodes the packets of one frame, range(0) is the point number, range(1) 1 to apply the extrinsics */
+void DecodeFrame(benchmark::State& state, uint8_t data_type) {
+  uint32_t points_num = static_cast<uint32_t>(state.range(0));
+  bool apply_extrinsic = state.range(1) != 0;
+  /** extrinsic_enable set means the lidar applies the extrinsics itself */
+  std::vector<RawPacket> packets = MakeRawPackets(data_type, points_num, !apply_extrinsic);
+
+  LidarPubHandler handler;
+  LidarExtParameter param = {};
+  param.lidar_type = kLivoxLidarType;
+  param.param = {1.5f, -2.0f, 90.0f, 100, -50, 200};
+  handler.SetLidarsExtParam(param);
+
+  std::vector<PointXyzlt> points;
+  for (auto _ : state) {
+    for (auto& packet : packets) {
+      handler.PointCloudProcess(packet);
+    }
+    handler.GetLidarPointClouds(points);
+    benchmark::DoNotOptimize(points.data());
+    benchmark::ClobberMemory();
+    points.clear();
+  }
+  SetPointCounters(state, points_num);
+}
+
+void BM_ProcessCartesianHighPoint(benchmark::State& state) {
+  DecodeFrame(state, kLivoxLidarCartesianCoordinateHighData);
+}
+
+void BM_ProcessCartesianLowPoint(benchmark::State& state) {
+  DecodeFrame(state, kLivoxLidarCartesianCoordinateLowData);
+}
+
+void BM_ProcessSphericalPoint(benchmark::State& state) {
+  DecodeFrame(state, kLivoxLidarSphericalCoordinateData);
+}
+
+void DecodeArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"points", "extrinsic"});
+  for (int64_t points : {static_cast<int64_t>(benchmark_util::kPointsPerPacket),
+                         static_cast<int64_t>(benchmark_util::kMid360PointsPerFrame),
+                         static_cast<int64_t>(benchmark_util::kHapPointsPerFrame)}) {
+    bench->Args({points, 1});
+    bench->Args({points, 0});
+  }
+}
+
+BENCHMARK(BM_ProcessCartesianHighPoint)->Apply(DecodeArgs);
+BENCHMARK(BM_ProcessCartesianLowPoint)->Apply(DecodeArgs);
+BENCHMARK(BM_ProcessSphericalPoint)->Apply(DecodeArgs);
+
+/** Pushes a frame into the lidar queue and pops it into the reused Lddc buffer */
+void BM_QueuePushAnyPop(benchmark::State& state) {
+  uint32_t points_num = static_cast<uint32_t>(state.range(0));
+  std::vector<PointXyzlt> points = MakePoints(points_num);
+
+  LidarDataQueue queue = {};
+  InitQueue(&queue, kMinEthPacketQueueSize);
+  StoragePacket storage_packet = {};
+
+  PointPacket packet = {};
+  packet.handle = 0x0C01A8C0;
+  packet.lidar_type = kLivoxLidarType;
+  packet.points_num = points_num;
+  packet.points = points.data();
+
+  for (auto _ : state) {
+    QueuePushAny(&queue, reinterpret_cast<uint8_t*>(&packet), points.front().offset_time);
+    QueuePop(&queue, &storage_packet);
+    benchmark::DoNotOptimize(storage_packet.points.data());
+  }
+  SetPointCounters(state, points_num);
+  DeInitQueue(&queue);
+}
+
+BENCHMARK(BM_QueuePushAnyPop)->ArgName("points")
+    ->Arg(benchmark_util::kMid360PointsPerFrame)->Arg(benchmark_util::kHapPointsPerFrame);
+
+}  // namespace
+}  // namespace livox_ros
+
+BENCHMARK_MAIN();
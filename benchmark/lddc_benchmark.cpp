@@ -0,0 +1,135 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Message fill functions of Lddc */
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_util.h"
+#include "lddc.h"
+
+namespace livox_ros {
+
+/** Exposes the private fill functions, no ros node or publisher is involved */
+class LddcBenchmark {
+ public:
+  static void InitPointcloud2Msg(Lddc& lddc, const StoragePacket& pkg, PointCloud2& cloud, uint64_t& timestamp) {
+    lddc.InitPointcloud2Msg(pkg, cloud, timestamp);
+  }
+
+  static void FillPointsToCustomMsg(Lddc& lddc, CustomMsg& livox_msg, const StoragePacket& pkg) {
+    lddc.FillPointsToCustomMsg(livox_msg, pkg);
+  }
+
+  static void FillPointsToPclMsg(Lddc& lddc, const StoragePacket& pkg, PointCloud& pcl_msg) {
+    lddc.FillPointsToPclMsg(pkg, pcl_msg);
+  }
+};
+
+namespace {
+
+using benchmark_util::MakePoints;
+using benchmark_util::SetPointCounters;
+
+std::unique_ptr<Lddc> MakeLddc(int format) {
+  std::string frame_id = "livox_frame";
+  return std::unique_ptr<Lddc>(new Lddc(format, 0, kSourceRawLidar, kOutputToRos, 10.0, frame_id, false, false));
+}
+
+/** One frame as Lddc pops it, flat points or the chunks of a sliding window */
+StoragePacket MakeStoragePacket(uint32_t points_num, bool use_chunks) {
+  const uint32_t kChunkNum = 4;
+  StoragePacket pkg = {};
+  pkg.lidar_type = kLivoxLidarType;
+  pkg.handle = 0x0C01A8C0;
+  if (use_chunks) {
+    for (uint32_t i = 0; i < kChunkNum; ++i) {
+      pkg.chunks.push_back(std::make_shared<const PointChunk>(MakePoints(points_num / kChunkNum)));
+    }
+    pkg.points_num = points_num / kChunkNum * kChunkNum;
+    pkg.base_time = pkg.chunks.front()->front().offset_time;
+  } else {
+    pkg.points = MakePoints(points_num);
+    pkg.points_num = points_num;
+    pkg.base_time = pkg.points.front().offset_time;
+  }
+  return pkg;
+}
+
+/** Publishing moves the message away, so each iteration fills a fresh one */
+void BM_InitPointcloud2Msg(benchmark::State& state) {
+  StoragePacket pkg = MakeStoragePacket(static_cast<uint32_t>(state.range(0)), state.range(1) != 0);
+  std::unique_ptr<Lddc> lddc = MakeLddc(kPointCloud2Msg);
+  for (auto _ : state) {
+    PointCloud2 cloud;
+    uint64_t timestamp = 0;
+    LddcBenchmark::InitPointcloud2Msg(*lddc, pkg, cloud, timestamp);
+    benchmark::DoNotOptimize(cloud.data.data());
+  }
+  SetPointCounters(state, pkg.points_num);
+}
+
+void BM_FillPointsToCustomMsg(benchmark::State& state) {
+  StoragePacket pkg = MakeStoragePacket(static_cast<uint32_t>(state.range(0)), state.range(1) != 0);
+  std::unique_ptr<Lddc> lddc = MakeLddc(kLivoxCustomMsg);
+  for (auto _ : state) {
+    CustomMsg livox_msg;
+    LddcBenchmark::FillPointsToCustomMsg(*lddc, livox_msg, pkg);
+    benchmark::DoNotOptimize(livox_msg.points.data());
+  }
+  SetPointCounters(state, pkg.points_num);
+}
+
+#ifdef BUILDING_ROS1
+void BM_FillPointsToPclMsg(benchmark::State& state) {
+  StoragePacket pkg = MakeStoragePacket(static_cast<uint32_t>(state.range(0)), state.range(1) != 0);
+  std::unique_ptr<Lddc> lddc = MakeLddc(kPclPxyziMsg);
+  for (auto _ : state) {
+    PointCloud cloud;
+    LddcBenchmark::FillPointsToPclMsg(*lddc, pkg, cloud);
+    benchmark::DoNotOptimize(cloud.points.data());
+  }
+  SetPointCounters(state, pkg.points_num);
+}
+#endif
+
+void FillArgs(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"points", "chunks"});
+  for (int64_t points : {static_cast<int64_t>(benchmark_util::kMid360PointsPerFrame),
+                         static_cast<int64_t>(benchmark_util::kHapPointsPerFrame)}) {
+    bench->Args({points, 0});
+    bench->Args({points, 1});
+  }
+}
+
+BENCHMARK(BM_InitPointcloud2Msg)->Apply(FillArgs);
+BENCHMARK(BM_FillPointsToCustomMsg)->Apply(FillArgs);
+#ifdef BUILDING_ROS1
+BENCHMARK(BM_FillPointsToPclMsg)->Apply(FillArgs);
+#endif
+
+}  // namespace
+}  // namespace livox_ros
+
+BENCHMARK_MAIN();
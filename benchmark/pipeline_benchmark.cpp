@@ -0,0 +1,373 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** End-to-end point cloud path of a DriverNode fed by the mock SDK, one child process per lidar count */
+
+#include <dirent.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "livox_lidar_api.h"
+#include "livox_lidar_def.h"
+
+#include "driver_node.h"
+#include "lddc.h"
+#include "comm/frame_trace.h"
+
+using livox_ros::FrameTrace;
+using livox_ros::FrameTraceRecord;
+
+namespace {
+
+typedef struct {
+  std::vector<uint32_t> lidar_counts;
+  int xfer_format;
+  uint32_t point_rate;
+  double warmup_sec;
+  double duration_sec;
+} PipelineConfig;
+
+typedef struct {
+  std::string name;
+  uint64_t ticks;
+} ThreadTicks;
+
+/** Latencies between consecutive trace stages and of the whole path */
+const char* const kLatencyNames[] = {
+  "receive->decode", "decode->pack", "pack->queue", "queue->pop", "pop->publish", "end-to-end"
+};
+const size_t kLatencyNum = sizeof(kLatencyNames) / sizeof(kLatencyNames[0]);
+
+class PipelineStats {
+ public:
+  void OnFrame(const FrameTraceRecord& record) {
+    if (!is_measuring_.load()) {
+      return;
+    }
+    if (record.is_dropped) {
+      ++dropped_frames_;
+      dropped_points_ += record.points_num;
+      return;
+    }
+    ++traced_frames_;
+    for (size_t i = 0; i + 1 < livox_ros::kTraceStageNum; ++i) {
+      latencies_[i].push_back(record.stage_time[i + 1] - record.stage_time[i]);
+    }
+    latencies_[kLatencyNum - 1].push_back(
+        record.stage_time[livox_ros::kTracePublished] - record.stage_time[livox_ros::kTraceReceived]);
+  }
+
+  static void OnPacket(uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                       void* client_data) {
+    (void)handle;
+    (void)dev_type;
+    PipelineStats* self = static_cast<PipelineStats*>(client_data);
+    if (data == nullptr || data->data_type == kLivoxLidarImuData || !self->is_measuring_.load()) {
+      return;
+    }
+    self->input_packets_.fetch_add(1, std::memory_order_relaxed);
+    self->input_points_.fetch_add(data->dot_num, std::memory_order_relaxed);
+  }
+
+  void OnMessage(uint64_t points_num) {
+    if (!is_measuring_.load()) {
+      return;
+    }
+    output_messages_.fetch_add(1, std::memory_order_relaxed);
+    output_points_.fetch_add(points_num, std::memory_order_relaxed);
+  }
+
+  std::atomic<bool> is_measuring_{false};
+  std::atomic<uint64_t> input_packets_{0};
+  std::atomic<uint64_t> input_points_{0};
+  std::atomic<uint64_t> output_messages_{0};
+  std::atomic<uint64_t> output_points_{0};
+
+  /** written by the FrameTrace sink under its lock, read after tracing stopped */
+  uint64_t traced_frames_ = 0;
+  uint64_t dropped_frames_ = 0;
+  uint64_t dropped_points_ = 0;
+  std::vector<uint64_t> latencies_[kLatencyNum];
+};
+
+std::vector<uint32_t> ParseCounts(const char* arg) {
+  std::vector<uint32_t> counts;
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    uint32_t count = static_cast<uint32_t>(strtoul(item.c_str(), nullptr, 0));
+    if (count > 0 && count <= livox_ros::kMaxSourceLidar) {
+      counts.push_back(count);
+    }
+  }
+  return counts;
+}
+
+/** The ips of lidar_configs are announced by the mock sdk and configured by the driver */
+std::string WriteMockConfig(uint32_t lidar_count, uint32_t point_rate) {
+  std::string path = "/tmp/livox_pipeline_benchmark_" + std::to_string(getpid()) + ".json";
+  std::ofstream file(path);
+  file << "{\n"
+       << "  \"lidar_summary_info\": { \"lidar_type\": 8 },\n"
+       << "  \"MID360\": {\n"
+       << "    \"lidar_net_info\": { \"cmd_data_port\": 56100, \"push_msg_port\": 56200,"
+       << " \"point_data_port\": 56300, \"imu_data_port\": 56400, \"log_data_port\": 56500 },\n"
+       << "    \"host_net_info\": { \"cmd_data_ip\": \"127.0.0.1\", \"cmd_data_port\": 56101,"
+       << " \"push_msg_ip\": \"127.0.0.1\", \"push_msg_port\": 56201,"
+       << " \"point_data_ip\": \"127.0.0.1\", \"point_data_port\": 56301,"
+       << " \"imu_data_ip\": \"127.0.0.1\", \"imu_data_port\": 56401,"
+       << " \"log_data_ip\": \"\", \"log_data_port\": 56501 }\n"
+       << "  },\n"
+       << "  \"mock_sdk\": { \"lidar_count\": 0, \"device_type\": 9, \"points_per_packet\": 96,"
+       << " \"point_rate\": " << point_rate << ", \"imu_rate\": 200, \"loss_rate\": 0.0, \"seed\": 1 },\n"
+       << "  \"lidar_configs\": [\n";
+  for (uint32_t i = 0; i < lidar_count; ++i) {
+    file << "    { \"ip\": \"192.168.1." << (100 + i) << "\", \"pcl_data_type\": 1, \"pattern_mode\": 0,"
+         << " \"extrinsic_parameter\": { \"roll\": 0.0, \"pitch\": 0.0, \"yaw\": 0.0, \"x\": 0, \"y\": 0, \"z\": 0 } }"
+         << (i + 1 < lidar_count ? ",\n" : "\n");
+  }
+  file << "  ]\n}\n";
+  return path;
+}
+
+/** utime + stime of every thread of this process, by tid */
+std::map<int, ThreadTicks> ReadThreadTicks() {
+  std::map<int, ThreadTicks> threads;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return threads;
+  }
+  struct dirent* entry = nullptr;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    std::string task = std::string("/proc/self/task/") + entry->d_name;
+    std::ifstream stat_file(task + "/stat");
+    std::string stat;
+    std::getline(stat_file, stat);
+    size_t pos = stat.rfind(')');
+    if (pos == std::string::npos) {
+      continue;
+    }
+    /** fields after the command name start at the state, utime and stime are the 12th and 13th */
+    std::stringstream fields(stat.substr(pos + 2));
+    std::string field;
+    uint64_t ticks = 0;
+    for (int i = 0; i < 13 && fields >> field; ++i) {
+      if (i == 11 || i == 12) {
+        ticks += strtoull(field.c_str(), nullptr, 10);
+      }
+    }
+    ThreadTicks& thread = threads[atoi(entry->d_name)];
+    std::ifstream comm_file(task + "/comm");
+    std::getline(comm_file, thread.name);
+    thread.ticks = ticks;
+  }
+  closedir(dir);
+  return threads;
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, double percent) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(percent / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void PrintResult(const PipelineConfig& config, uint32_t lidar_count, PipelineStats& stats,
+                 const std::map<int, ThreadTicks>& begin_ticks, const std::map<int, ThreadTicks>& end_ticks) {
+  double duration = config.duration_sec;
+  printf("\n== %u lidar(s), %s, %.1f s ==\n", lidar_count,
+         config.xfer_format == 1 ? "CustomMsg" : "PointCloud2", duration);
+  printf("input:  %10.0f points/s  %8.0f packets/s\n",
+         stats.input_points_.load() / duration, stats.input_packets_.load() / duration);
+  printf("output: %10.0f points/s  %8.1f msgs/s\n",
+         stats.output_points_.load() / duration, stats.output_messages_.load() / duration);
+  printf("frames: %lu published, %lu dropped on full queues (%lu points)\n",
+         static_cast<unsigned long>(stats.traced_frames_), static_cast<unsigned long>(stats.dropped_frames_),
+         static_cast<unsigned long>(stats.dropped_points_));
+
+  printf("%-16s %10s %10s %10s %10s\n", "latency(us)", "p50", "p99", "p99.9", "max");
+  for (size_t i = 0; i < kLatencyNum; ++i) {
+    std::vector<uint64_t>& samples = stats.latencies_[i];
+    std::sort(samples.begin(), samples.end());
+    printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", kLatencyNames[i],
+           Percentile(samples, 50.0) / 1e3, Percentile(samples, 99.0) / 1e3,
+           Percentile(samples, 99.9) / 1e3, samples.empty() ? 0.0 : samples.back() / 1e3);
+  }
+
+  double ticks_per_sec = static_cast<double>(sysconf(_SC_CLK_TCK));
+  printf("%-16s %8s\n", "thread", "cpu(%)");
+  for (const auto& end : end_ticks) {
+    auto begin = begin_ticks.find(end.first);
+    uint64_t ticks = end.second.ticks - (begin != begin_ticks.end() ? begin->second.ticks : 0);
+    if (ticks == 0) {
+      continue;
+    }
+    printf("%-16s %8.1f\n", end.second.name.c_str(), ticks / ticks_per_sec / duration * 100.0);
+  }
+  fflush(stdout);
+}
+
+int RunPipeline(const PipelineConfig& config, uint32_t lidar_count) {
+  std::string config_path = WriteMockConfig(lidar_count, config.point_rate);
+  PipelineStats stats;
+
+  rclcpp::init(0, nullptr);
+  rclcpp::NodeOptions options;
+  options.parameter_overrides({
+    {"xfer_format", config.xfer_format},
+    {"multi_topic", 0},
+    {"data_src", 0},
+    {"publish_freq", 10.0},
+    {"frame_id", "livox_frame"},
+    {"user_config_path", config_path}
+  });
+  auto driver_node = std::make_shared<livox_ros::DriverNode>(options);
+  auto bench_node = std::make_shared<rclcpp::Node>("livox_pipeline_benchmark");
+
+  rclcpp::SubscriptionBase::SharedPtr subscription;
+  rclcpp::QoS qos(256);
+  if (config.xfer_format == 1) {
+    subscription = bench_node->create_subscription<livox_ros::CustomMsg>("livox/lidar", qos,
+        [&stats](livox_ros::CustomMsg::ConstSharedPtr msg) { stats.OnMessage(msg->point_num); });
+  } else {
+    subscription = bench_node->create_subscription<livox_ros::PointCloud2>("livox/lidar", qos,
+        [&stats](livox_ros::PointCloud2::ConstSharedPtr msg) { stats.OnMessage(msg->width * msg->height); });
+  }
+
+  uint16_t observer_id = LivoxLidarAddPointCloudObserver(PipelineStats::OnPacket, &stats);
+  FrameTrace::GetInstance().SetSink([&stats](const FrameTraceRecord& record) { stats.OnFrame(record); });
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(driver_node);
+  executor.add_node(bench_node);
+  std::thread spin_thread([&executor]() {
+    pthread_setname_np(pthread_self(), "bench_spin");
+    executor.spin();
+  });
+
+  std::this_thread::sleep_for(std::chrono::duration<double>(config.warmup_sec));
+  std::map<int, ThreadTicks> begin_ticks = ReadThreadTicks();
+  stats.is_measuring_.store(true);
+  std::this_thread::sleep_for(std::chrono::duration<double>(config.duration_sec));
+  stats.is_measuring_.store(false);
+  std::map<int, ThreadTicks> end_ticks = ReadThreadTicks();
+
+  FrameTrace::GetInstance().SetSink(nullptr);
+  LivoxLidarRemovePointCloudObserver(observer_id);
+  PrintResult(config, lidar_count, stats, begin_ticks, end_ticks);
+
+  executor.cancel();
+  spin_thread.join();
+  subscription.reset();
+  bench_node.reset();
+  driver_node.reset();
+  rclcpp::shutdown();
+  remove(config_path.c_str());
+  return 0;
+}
+
+void PrintUsage(const char* name) {
+  printf("Usage: %s [options]\n"
+         "  -l, --lidars N[,N...]    lidar counts, each run in its own process (1,2,4,8,16,32)\n"
+         "  -f, --format N           xfer_format, 0 PointCloud2, 1 CustomMsg (0)\n"
+         "  -r, --point-rate N       points per second of each lidar, 0 for the device rate (0)\n"
+         "  -w, --warmup SEC         excluded from the results, covers the poll thread start delay (5)\n"
+         "  -d, --duration SEC       measured time of each run (10)\n",
+         name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  PipelineConfig config;
+  config.lidar_counts = {1, 2, 4, 8, 16, 32};
+  config.xfer_format = 0;
+  config.point_rate = 0;
+  config.warmup_sec = 5.0;
+  config.duration_sec = 10.0;
+
+  const struct option long_options[] = {
+    {"lidars", required_argument, nullptr, 'l'},
+    {"format", required_argument, nullptr, 'f'},
+    {"point-rate", required_argument, nullptr, 'r'},
+    {"warmup", required_argument, nullptr, 'w'},
+    {"duration", required_argument, nullptr, 'd'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "l:f:r:w:d:h", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'l': config.lidar_counts = ParseCounts(optarg); break;
+      case 'f': config.xfer_format = atoi(optarg); break;
+      case 'r': config.point_rate = static_cast<uint32_t>(strtoul(optarg, nullptr, 0)); break;
+      case 'w': config.warmup_sec = atof(optarg); break;
+      case 'd': config.duration_sec = atof(optarg); break;
+      default:
+        PrintUsage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (config.lidar_counts.empty() || config.duration_sec <= 0.0) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  /** the sdk and the driver singletons are initialised once per process */
+  int result = 0;
+  for (uint32_t lidar_count : config.lidar_counts) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+      _exit(RunPipeline(config, lidar_count));
+    } else if (pid < 0) {
+      perror("fork");
+      return 1;
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      printf("run with %u lidar(s) failed\n", lidar_count);
+      result = 1;
+    }
+  }
+  return result;
+}
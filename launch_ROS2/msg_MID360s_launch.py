@@ -9,7 +9,8 @@ xfer_format   = 1    # 0-Pointcloud2(PointXYZRTL), 1-customized pointcloud forma
 multi_topic   = 0    # 0-All LiDARs share the same topic, 1-One LiDAR one topic
 data_src      = 0    # 0-lidar, others-Invalid data src
 publish_freq  = 10.0 # freqency of publish, 5.0, 10.0, 20.0, 50.0, etc.
-output_type   = 0
+output_type   = 0    # 0-publish, 1-write to bag_file_path, 2-publish and write to bag_file_path
+bag_file_path = 'livox_ros_driver2_bag' # a directory that must not exist yet
 frame_id      = 'livox_frame'
 lvx_file_path = '/home/livox/livox_test.lvx'
 cmdline_bd_code = 'livox0000000001'
@@ -25,6 +26,7 @@ livox_ros2_params = [
     {"data_src": data_src},
     {"publish_freq": publish_freq},
     {"output_data_type": output_type},
+    {"bag_file_path": bag_file_path},
     {"frame_id": frame_id},
     {"lvx_file_path": lvx_file_path},
     {"user_config_path": user_config_path},
@@ -0,0 +1,238 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "bag_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef BUILDING_ROS2
+#include <rosbag2_compression/compression_options.hpp>
+#include <rosbag2_compression/sequential_compression_writer.hpp>
+#include <rosbag2_cpp/converter_options.hpp>
+#include <rosbag2_storage/storage_options.hpp>
+#include <rosbag2_storage/topic_metadata.hpp>
+#endif
+
+namespace livox_ros {
+
+BagWriter::BagWriter() : is_open_(false), is_quit_(false) {
+  memset(&statistics_, 0, sizeof(statistics_));
+}
+
+BagWriter::~BagWriter() { Close(); }
+
+#ifdef BUILDING_ROS1
+bool BagWriter::Open(const std::string& file_name) {
+  if (is_open_) {
+    return true;
+  }
+  bag_ = std::make_unique<BagBackend>();
+  try {
+    bag_->open(file_name, rosbag::bagmode::Write);
+  } catch (const std::exception& e) {
+    std::cout << "open bag file failed: " << file_name << ", " << e.what() << std::endl;
+    bag_ = nullptr;
+    return false;
+  }
+  Start(file_name);
+  return true;
+}
+#elif defined BUILDING_ROS2
+bool BagWriter::Open(const std::string& uri, const std::string& storage_id,
+                     const std::string& compression_format) {
+  if (is_open_) {
+    return true;
+  }
+  if (compression_format.empty()) {
+    bag_ = std::make_unique<BagBackend>();
+  } else {
+    rosbag2_compression::CompressionOptions compression_options;
+    compression_options.compression_format = compression_format;
+    compression_options.compression_mode = rosbag2_compression::CompressionMode::MESSAGE;
+    compression_options.compression_queue_size = 1;
+    compression_options.compression_threads = 0;  // one per core
+    bag_ = std::make_unique<BagBackend>(
+        std::make_unique<rosbag2_compression::SequentialCompressionWriter>(compression_options));
+  }
+
+  rosbag2_storage::StorageOptions storage_options;
+  storage_options.uri = uri;
+  storage_options.storage_id = storage_id;
+  rosbag2_cpp::ConverterOptions converter_options;
+  converter_options.input_serialization_format = "cdr";
+  converter_options.output_serialization_format = "cdr";
+  try {
+    bag_->open(storage_options, converter_options);
+  } catch (const std::exception& e) {
+    std::cout << "open bag failed: " << uri << ", " << e.what() << std::endl;
+    bag_ = nullptr;
+    return false;
+  }
+  topics_.clear();
+  Start(uri);
+  return true;
+}
+
+bool BagWriter::Write(const std::string& topic, const std::string& type_name,
+                      const std::shared_ptr<const rclcpp::SerializedMessage>& msg, uint64_t timestamp) {
+  return Push([this, topic, type_name, msg, timestamp](BagBackend& bag) {
+    if (topics_.insert(topic).second) {
+      rosbag2_storage::TopicMetadata topic_metadata;
+      topic_metadata.name = topic;
+      topic_metadata.type = type_name;
+      topic_metadata.serialization_format = "cdr";
+      bag.create_topic(topic_metadata);
+    }
+#ifdef ROSBAG2_WRITE_SERIALIZED_MESSAGE
+    bag.write(msg, topic, type_name, rclcpp::Time(timestamp));
+#else
+    auto bag_msg = std::make_shared<rosbag2_storage::SerializedBagMessage>();
+    // the bag message borrows the buffer, the capture keeps it alive
+    bag_msg->serialized_data = std::shared_ptr<rcutils_uint8_array_t>(
+        const_cast<rcutils_uint8_array_t*>(&msg->get_rcl_serialized_message()),
+        [msg](rcutils_uint8_array_t*) {});
+    bag_msg->topic_name = topic;
+    bag_msg->time_stamp = timestamp;
+    bag.write(bag_msg);
+#endif
+  }, msg->size());
+}
+#endif
+
+void BagWriter::Start(const std::string& file_name) {
+  file_name_ = file_name;
+  memset(&statistics_, 0, sizeof(statistics_));
+  is_quit_ = false;
+  is_open_ = true;
+  write_thread_ = std::make_shared<std::thread>(&BagWriter::WriteProcess, this);
+}
+
+void BagWriter::Close() {
+  if (!is_open_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_quit_ = true;
+  }
+  condition_.notify_one();
+  if (write_thread_ && write_thread_->joinable()) {
+    write_thread_->join();
+  }
+  write_thread_ = nullptr;
+  bag_ = nullptr;  // closes the bag
+  is_open_ = false;
+  ReportStatistics("bag file closed");
+}
+
+bool BagWriter::Push(WriteFunc&& write, uint64_t size) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open_ || is_quit_) {
+      return false;
+    }
+    if (statistics_.pending_msgs >= kBagWriterMaxPendingMsgs ||
+        statistics_.pending_bytes + size > kBagWriterMaxPendingBytes) {
+      ++statistics_.dropped_msgs;
+      return false;
+    }
+    pending_.push_back(PendingMessage{std::move(write), size});
+    ++statistics_.enqueued_msgs;
+    ++statistics_.pending_msgs;
+    statistics_.pending_bytes += size;
+    statistics_.max_pending_msgs = std::max(statistics_.max_pending_msgs, statistics_.pending_msgs);
+    statistics_.max_pending_bytes = std::max(statistics_.max_pending_bytes, statistics_.pending_bytes);
+  }
+  condition_.notify_one();
+  return true;
+}
+
+void BagWriter::WriteProcess() {
+  auto last_report = std::chrono::steady_clock::now();
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait_for(lock, std::chrono::milliseconds(100),
+                          [this] { return is_quit_ || !pending_.empty(); });
+      if (pending_.empty() && is_quit_) {
+        break;
+      }
+      // the publish thread keeps filling the other buffer while this one is written
+      writing_.swap(pending_);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t written_bytes = 0;
+    for (auto& msg : writing_) {
+      try {
+        msg.write(*bag_);
+      } catch (const std::exception& e) {
+        std::cout << "write bag file failed: " << e.what() << std::endl;
+      }
+      written_bytes += msg.size;
+    }
+    uint64_t write_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      statistics_.written_msgs += writing_.size();
+      statistics_.written_bytes += written_bytes;
+      statistics_.pending_msgs -= writing_.size();
+      statistics_.pending_bytes -= written_bytes;
+      statistics_.max_batch_write_time = std::max(statistics_.max_batch_write_time, write_time);
+    }
+    writing_.clear();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_report >= std::chrono::nanoseconds(kBagWriterReportPeriod)) {
+      ReportStatistics("bag writer");
+      last_report = now;
+    }
+  }
+}
+
+BagWriterStatistics BagWriter::GetStatistics() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void BagWriter::ReportStatistics(const char* prefix) {
+  BagWriterStatistics statistics = GetStatistics();
+  printf("%s, file: %s, written: %lu msgs %lu MB, dropped: %lu, pending: %u (max %u, %lu MB), "
+         "max batch write: %lu ms\n", prefix, file_name_.c_str(),
+         static_cast<unsigned long>(statistics.written_msgs),
+         static_cast<unsigned long>(statistics.written_bytes >> 20),
+         static_cast<unsigned long>(statistics.dropped_msgs),
+         statistics.pending_msgs, statistics.max_pending_msgs,
+         static_cast<unsigned long>(statistics.max_pending_bytes >> 20),
+         static_cast<unsigned long>(statistics.max_batch_write_time / 1000000));
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,144 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Writes messages to a bag file from a dedicated thread, off the publish path */
+
+#ifndef LIVOX_ROS_DRIVER2_BAG_WRITER_H_
+#define LIVOX_ROS_DRIVER2_BAG_WRITER_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/ros_headers.h"
+
+#ifdef BUILDING_ROS2
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+#include <rosbag2_cpp/writer.hpp>
+#endif
+
+namespace livox_ros {
+
+/** Max messages waiting to be written, newer messages are dropped beyond it */
+const uint32_t kBagWriterMaxPendingMsgs = 4096;
+/** Max serialized bytes waiting to be written, about 2s of 4 lidars at 10Hz */
+const uint64_t kBagWriterMaxPendingBytes = 256 * 1024 * 1024;
+/** Period of the backpressure report while recording */
+const uint64_t kBagWriterReportPeriod = 10000000000;  // ns
+
+typedef struct {
+  uint64_t enqueued_msgs;
+  uint64_t written_msgs;
+  uint64_t dropped_msgs;    /**< Dropped because the pending limits were reached */
+  uint64_t written_bytes;
+  uint32_t pending_msgs;
+  uint32_t max_pending_msgs;
+  uint64_t pending_bytes;
+  uint64_t max_pending_bytes;
+  uint64_t max_batch_write_time;  /**< ns, the longest write of one swapped buffer */
+} BagWriterStatistics;
+
+#ifdef BUILDING_ROS1
+using BagBackend = rosbag::Bag;
+#elif defined BUILDING_ROS2
+using BagBackend = rosbag2_cpp::Writer;
+#endif
+
+class BagWriter {
+ public:
+  BagWriter();
+  ~BagWriter();
+  BagWriter(const BagWriter &) = delete;
+  BagWriter &operator=(const BagWriter &) = delete;
+
+#ifdef BUILDING_ROS1
+  bool Open(const std::string& file_name);
+#elif defined BUILDING_ROS2
+  /**
+   * uri is the bag directory, storage_id is a rosbag2 storage plugin, sqlite3 or mcap.
+   * Messages are compressed one by one if compression_format is set, e.g. zstd.
+   */
+  bool Open(const std::string& uri, const std::string& storage_id, const std::string& compression_format);
+#endif
+  /** Writes out the pending messages and closes the bag */
+  void Close();
+  bool IsOpen() const { return is_open_; }
+
+#ifdef BUILDING_ROS1
+  /**
+   * Queues a message without blocking, false if it is dropped because the writer
+   * is behind. The message must not be modified once it is queued.
+   */
+  template <typename MessageT>
+  bool Write(const std::string& topic, const ros::Time& time,
+             const boost::shared_ptr<const MessageT>& msg) {
+    uint64_t size = ros::serialization::serializationLength(*msg);
+    return Push([topic, time, msg](BagBackend& bag) { bag.write(topic, time, msg); }, size);
+  }
+#elif defined BUILDING_ROS2
+  /** Queues an already serialized message, the same bytes may be published live */
+  bool Write(const std::string& topic, const std::string& type_name,
+             const std::shared_ptr<const rclcpp::SerializedMessage>& msg, uint64_t timestamp);
+#endif
+
+  BagWriterStatistics GetStatistics();
+
+ private:
+  typedef std::function<void(BagBackend&)> WriteFunc;
+  typedef struct {
+    WriteFunc write;
+    uint64_t size;
+  } PendingMessage;
+
+  void Start(const std::string& file_name);
+  bool Push(WriteFunc&& write, uint64_t size);
+  void WriteProcess();
+  void ReportStatistics(const char* prefix);
+
+  std::unique_ptr<BagBackend> bag_;
+  std::string file_name_;
+  bool is_open_;
+#ifdef BUILDING_ROS2
+  std::set<std::string> topics_;  /**< Topics created in the bag, only used by the writer thread */
+#endif
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<PendingMessage> pending_;  /**< Filled by the publish thread */
+  std::vector<PendingMessage> writing_;  /**< Swapped with pending_, drained by the writer thread */
+  BagWriterStatistics statistics_;
+  bool is_quit_;
+  std::shared_ptr<std::thread> write_thread_;
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER2_BAG_WRITER_H_
@@ -24,7 +24,7 @@
 
 #include "lidar_common_callback.h"
 
-#include "../lds_lidar.h"
+#include "../lds.h"
 
 #include <string>
 
@@ -46,11 +46,11 @@ void LidarCommonCallback::OnLidarPointClounCb(PointFrame* frame, void* client_da
     return;
   }
 
-  LdsLidar *lds_lidar = static_cast<LdsLidar *>(client_data);
+  Lds *lds = static_cast<Lds *>(client_data);
   
   //printf("Lidar point cloud, lidar_num:%u.\n", frame->lidar_num);
 
-  lds_lidar->StoragePointData(frame);
+  lds->StoragePointData(frame);
 }
 
 void LidarCommonCallback::LidarImuDataCallback(ImuData* imu_data, void *client_data) {
@@ -63,8 +63,18 @@ void LidarCommonCallback::LidarImuDataCallback(ImuData* imu_data, void *client_d
     return;
   }
 
-  LdsLidar *lds_lidar = static_cast<LdsLidar *>(client_data);
-  lds_lidar->StorageImuData(imu_data);
+  Lds *lds = static_cast<Lds *>(client_data);
+  lds->StorageImuData(imu_data);
+}
+
+void LidarCommonCallback::OnLidarDisconnectedCb(uint32_t handle, void* client_data) {
+  if (client_data == nullptr) {
+    printf("Lidar disconnected cb failed, client data is nullptr.\n");
+    return;
+  }
+
+  Lds *lds = static_cast<Lds *>(client_data);
+  lds->OnLidarDisconnected(handle);
 }
 
 } // namespace livox_ros
@@ -33,6 +33,7 @@ class LidarCommonCallback {
  public:
   static void OnLidarPointClounCb(PointFrame* frame, void* client_data);
   static void LidarImuDataCallback(ImuData* imu_data, void *client_data);
+  static void OnLidarDisconnectedCb(uint32_t handle, void* client_data);
 };
 
 } // namespace livox_ros
@@ -25,12 +25,52 @@
 #include "livox_lidar_callback.h"
 
 #include "livox_lidar_api.h"
+#include "../comm/startup_timer.h"
 #include <string>
 #include <thread>
+#include <utility>
 #include <iostream>
 
 namespace livox_ros {
 
+/** Config commands retried on timeout, every lidar and command backs off on its own */
+typedef enum {
+  kConfigCommandWorkMode = 0,
+  kConfigCommandDataType,
+  kConfigCommandScanPattern,
+  kConfigCommandBlindSpot,
+  kConfigCommandDualEmit,
+  kConfigCommandAttitude,
+  kConfigCommandImuData
+} ConfigCommand;
+
+static uint64_t GetRetryKey(const uint32_t handle, ConfigCommand command) {
+  return (static_cast<uint64_t>(handle) << 8) | command;
+}
+
+/** Never resend from the sdk callback thread, the scheduler resends after the backoff */
+static void RetryCommand(LdsLidar* lds_lidar, const uint32_t handle, ConfigCommand command,
+                         const char* name, RetryScheduler::Task task) {
+  if (lds_lidar->config_retry_.Retry(GetRetryKey(handle, command), std::move(task))) {
+    std::cout << name << " timeout, handle: " << handle << ", try again..." << std::endl;
+  } else {
+    std::cout << name << " timeout, handle: " << handle << ", give up" << std::endl;
+  }
+}
+
+static void SetLidarAttitude(const UserLivoxLidarConfig& config, void* client_data) {
+  LivoxLidarInstallAttitude attitude {
+    config.extrinsic_param.roll,
+    config.extrinsic_param.pitch,
+    config.extrinsic_param.yaw,
+    config.extrinsic_param.x,
+    config.extrinsic_param.y,
+    config.extrinsic_param.z
+  };
+  SetLivoxLidarInstallAttitude(config.handle, &attitude,
+                               LivoxLidarCallback::SetAttitudeCallback, client_data);
+}
+
 void LivoxLidarCallback::LidarInfoChangeCallback(const uint32_t handle,
                                            const LivoxLidarInfo* info,
                                            void* client_data) {
@@ -39,8 +79,14 @@ void LivoxLidarCallback::LidarInfoChangeCallback(const uint32_t handle,
     return;
   }
   LdsLidar* lds_lidar = static_cast<LdsLidar*>(client_data);
+  StartupTimer::GetInstance().Mark(handle, kStartupDiscovered);
 
   LidarDevice* lidar_device = GetLidarDevice(handle, client_data);
+  uint8_t reattach_index = 0;
+  if (lidar_device == nullptr && lds_lidar->ReattachLidar(handle, reattach_index)) {
+    // reconnected after its resources were released, configure it again
+    lidar_device = &(lds_lidar->lidars_[reattach_index]);
+  }
   if (lidar_device == nullptr) {
     std::cout << "found lidar not defined in the user-defined config, ip: " << IpNumToString(handle) << std::endl;
     // add lidar device
@@ -91,20 +137,11 @@ void LivoxLidarCallback::LidarInfoChangeCallback(const uint32_t handle,
     } // free lock for set_bits
 
     // set extrinsic params into lidar
-    LivoxLidarInstallAttitude attitude {
-      config.extrinsic_param.roll,
-      config.extrinsic_param.pitch,
-      config.extrinsic_param.yaw,
-      config.extrinsic_param.x,
-      config.extrinsic_param.y,
-      config.extrinsic_param.z
-    };
-    SetLivoxLidarInstallAttitude(config.handle, &attitude,
-                                 LivoxLidarCallback::SetAttitudeCallback, lds_lidar);
+    SetLidarAttitude(config, lds_lidar);
   }
 
   std::cout << "begin to change work mode to 'Normal', handle: " << handle << std::endl;
-  SetLivoxLidarWorkMode(handle, kLivoxLidarNormal, WorkModeChangedCallback, nullptr);
+  SetLivoxLidarWorkMode(handle, kLivoxLidarNormal, WorkModeChangedCallback, lds_lidar);
   EnableLivoxLidarImuData(handle, LivoxLidarCallback::EnableLivoxLidarImuDataCallback, lds_lidar);
   return;
 }
@@ -113,12 +150,20 @@ void LivoxLidarCallback::WorkModeChangedCallback(livox_status status,
                                                  uint32_t handle,
                                                  LivoxLidarAsyncControlResponse *response,
                                                  void *client_data) {
+  if (client_data == nullptr) {
+    std::cout << "work mode changed callback failed, client data is nullptr" << std::endl;
+    return;
+  }
+  LdsLidar* lds_lidar = static_cast<LdsLidar*>(client_data);
+
   if (status != kLivoxLidarStatusSuccess) {
-    std::cout << "failed to change work mode, handle: " << handle << ", try again..."<< std::endl;
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    SetLivoxLidarWorkMode(handle, kLivoxLidarNormal, WorkModeChangedCallback, nullptr);
+    std::cout << "failed to change work mode, handle: " << handle << std::endl;
+    RetryCommand(lds_lidar, handle, kConfigCommandWorkMode, "change work mode", [handle, lds_lidar]() {
+      SetLivoxLidarWorkMode(handle, kLivoxLidarNormal, WorkModeChangedCallback, lds_lidar);
+    });
     return;
   }
+  lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandWorkMode));
   std::cout << "successfully change work mode, handle: " << handle << std::endl;
   return;
 }
@@ -136,18 +181,23 @@ void LivoxLidarCallback::SetDataTypeCallback(livox_status status, uint32_t handl
 
   if (status == kLivoxLidarStatusSuccess) {
     std::lock_guard<std::mutex> lock(lds_lidar->config_mutex_);
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandDataType));
     lidar_device->livox_config.set_bits &= ~((uint32_t)(kConfigDataType));
     if (!lidar_device->livox_config.set_bits) {
-      lidar_device->connect_state = kConnectStateSampling;
+      lds_lidar->StartSampling(lidar_device);
     }
     std::cout << "successfully set data type, handle: " << handle
               << ", set_bit: " << lidar_device->livox_config.set_bits << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    const UserLivoxLidarConfig& config = lidar_device->livox_config;
-    SetLivoxLidarPclDataType(handle, static_cast<LivoxLidarPointDataType>(config.pcl_data_type),
-                             LivoxLidarCallback::SetDataTypeCallback, client_data);
-    std::cout << "set data type timeout, handle: " << handle
-              << ", try again..." << std::endl;
+    RetryCommand(lds_lidar, handle, kConfigCommandDataType, "set data type", [handle, lds_lidar]() {
+      LidarDevice* lidar_device = GetLidarDevice(handle, lds_lidar);
+      if (lidar_device == nullptr) {
+        return;
+      }
+      const UserLivoxLidarConfig& config = lidar_device->livox_config;
+      SetLivoxLidarPclDataType(handle, static_cast<LivoxLidarPointDataType>(config.pcl_data_type),
+                               LivoxLidarCallback::SetDataTypeCallback, lds_lidar);
+    });
   } else {
     std::cout << "failed to set data type, handle: " << handle
               << ", return code: " << response->ret_code
@@ -169,18 +219,23 @@ void LivoxLidarCallback::SetPatternModeCallback(livox_status status, uint32_t ha
 
   if (status == kLivoxLidarStatusSuccess) {
     std::lock_guard<std::mutex> lock(lds_lidar->config_mutex_);
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandScanPattern));
     lidar_device->livox_config.set_bits &= ~((uint32_t)(kConfigScanPattern));
     if (!lidar_device->livox_config.set_bits) {
-      lidar_device->connect_state = kConnectStateSampling;
+      lds_lidar->StartSampling(lidar_device);
     }
     std::cout << "successfully set pattern mode, handle: " << handle
               << ", set_bit: " << lidar_device->livox_config.set_bits << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    const UserLivoxLidarConfig& config = lidar_device->livox_config;
-    SetLivoxLidarScanPattern(handle, static_cast<LivoxLidarScanPattern>(config.pattern_mode),
-                             LivoxLidarCallback::SetPatternModeCallback, client_data);
-    std::cout << "set pattern mode timeout, handle: " << handle
-              << ", try again..." << std::endl;
+    RetryCommand(lds_lidar, handle, kConfigCommandScanPattern, "set pattern mode", [handle, lds_lidar]() {
+      LidarDevice* lidar_device = GetLidarDevice(handle, lds_lidar);
+      if (lidar_device == nullptr) {
+        return;
+      }
+      const UserLivoxLidarConfig& config = lidar_device->livox_config;
+      SetLivoxLidarScanPattern(handle, static_cast<LivoxLidarScanPattern>(config.pattern_mode),
+                               LivoxLidarCallback::SetPatternModeCallback, lds_lidar);
+    });
   } else {
     std::cout << "failed to set pattern mode, handle: " << handle
               << ", return code: " << response->ret_code
@@ -202,18 +257,23 @@ void LivoxLidarCallback::SetBlindSpotCallback(livox_status status, uint32_t hand
 
   if (status == kLivoxLidarStatusSuccess) {
     std::lock_guard<std::mutex> lock(lds_lidar->config_mutex_);
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandBlindSpot));
     lidar_device->livox_config.set_bits &= ~((uint32_t)(kConfigBlindSpot));
     if (!lidar_device->livox_config.set_bits) {
-      lidar_device->connect_state = kConnectStateSampling;
+      lds_lidar->StartSampling(lidar_device);
     }
     std::cout << "successfully set blind spot, handle: " << handle
               << ", set_bit: " << lidar_device->livox_config.set_bits << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    const UserLivoxLidarConfig& config = lidar_device->livox_config;
-    SetLivoxLidarBlindSpot(handle, config.blind_spot_set,
-                           LivoxLidarCallback::SetBlindSpotCallback, client_data);
-    std::cout << "set blind spot timeout, handle: " << handle
-              << ", try again..." << std::endl;
+    RetryCommand(lds_lidar, handle, kConfigCommandBlindSpot, "set blind spot", [handle, lds_lidar]() {
+      LidarDevice* lidar_device = GetLidarDevice(handle, lds_lidar);
+      if (lidar_device == nullptr) {
+        return;
+      }
+      const UserLivoxLidarConfig& config = lidar_device->livox_config;
+      SetLivoxLidarBlindSpot(handle, config.blind_spot_set,
+                             LivoxLidarCallback::SetBlindSpotCallback, lds_lidar);
+    });
   } else {
     std::cout << "failed to set blind spot, handle: " << handle
               << ", return code: " << response->ret_code
@@ -235,18 +295,23 @@ void LivoxLidarCallback::SetDualEmitCallback(livox_status status, uint32_t handl
   LdsLidar* lds_lidar = static_cast<LdsLidar*>(client_data);
   if (status == kLivoxLidarStatusSuccess) {
     std::lock_guard<std::mutex> lock(lds_lidar->config_mutex_);
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandDualEmit));
     lidar_device->livox_config.set_bits &= ~((uint32_t)(kConfigDualEmit));
     if (!lidar_device->livox_config.set_bits) {
-      lidar_device->connect_state = kConnectStateSampling;
+      lds_lidar->StartSampling(lidar_device);
     }
     std::cout << "successfully set dual emit mode, handle: " << handle
               << ", set_bit: " << lidar_device->livox_config.set_bits << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    const UserLivoxLidarConfig& config = lidar_device->livox_config;
-    SetLivoxLidarDualEmit(handle, config.dual_emit_en,
-                          LivoxLidarCallback::SetDualEmitCallback, client_data);
-    std::cout << "set dual emit mode timeout, handle: " << handle
-              << ", try again..." << std::endl;
+    RetryCommand(lds_lidar, handle, kConfigCommandDualEmit, "set dual emit mode", [handle, lds_lidar]() {
+      LidarDevice* lidar_device = GetLidarDevice(handle, lds_lidar);
+      if (lidar_device == nullptr) {
+        return;
+      }
+      const UserLivoxLidarConfig& config = lidar_device->livox_config;
+      SetLivoxLidarDualEmit(handle, config.dual_emit_en,
+                            LivoxLidarCallback::SetDualEmitCallback, lds_lidar);
+    });
   } else {
     std::cout << "failed to set dual emit mode, handle: " << handle
               << ", return code: " << response->ret_code
@@ -267,21 +332,15 @@ void LivoxLidarCallback::SetAttitudeCallback(livox_status status, uint32_t handl
 
   LdsLidar* lds_lidar = static_cast<LdsLidar*>(client_data);
   if (status == kLivoxLidarStatusSuccess) {
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandAttitude));
     std::cout << "successfully set lidar attitude, ip: " << IpNumToString(handle) << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    std::cout << "set lidar attitude timeout, ip: " << IpNumToString(handle)
-              << ", try again..." << std::endl;
-    const UserLivoxLidarConfig& config = lidar_device->livox_config;
-    LivoxLidarInstallAttitude attitude {
-      config.extrinsic_param.roll,
-      config.extrinsic_param.pitch,
-      config.extrinsic_param.yaw,
-      config.extrinsic_param.x,
-      config.extrinsic_param.y,
-      config.extrinsic_param.z
-    };
-    SetLivoxLidarInstallAttitude(config.handle, &attitude,
-                                 LivoxLidarCallback::SetAttitudeCallback, lds_lidar);
+    RetryCommand(lds_lidar, handle, kConfigCommandAttitude, "set lidar attitude", [handle, lds_lidar]() {
+      LidarDevice* lidar_device = GetLidarDevice(handle, lds_lidar);
+      if (lidar_device != nullptr) {
+        SetLidarAttitude(lidar_device->livox_config, lds_lidar);
+      }
+    });
   } else {
     std::cout << "failed to set lidar attitude, ip: " << IpNumToString(handle) << std::endl;
   }
@@ -305,11 +364,12 @@ void LivoxLidarCallback::EnableLivoxLidarImuDataCallback(livox_status status, ui
   }
 
   if (status == kLivoxLidarStatusSuccess) {
+    lds_lidar->config_retry_.Reset(GetRetryKey(handle, kConfigCommandImuData));
     std::cout << "successfully enable Livox Lidar imu, ip: " << IpNumToString(handle) << std::endl;
   } else if (status == kLivoxLidarStatusTimeout) {
-    std::cout << "enable Livox Lidar imu timeout, ip: " << IpNumToString(handle)
-              << ", try again..." << std::endl;
-    EnableLivoxLidarImuData(handle, LivoxLidarCallback::EnableLivoxLidarImuDataCallback, lds_lidar);
+    RetryCommand(lds_lidar, handle, kConfigCommandImuData, "enable Livox Lidar imu", [handle, lds_lidar]() {
+      EnableLivoxLidarImuData(handle, LivoxLidarCallback::EnableLivoxLidarImuDataCallback, lds_lidar);
+    });
   } else {
     std::cout << "failed to enable Livox Lidar imu, ip: " << IpNumToString(handle) << std::endl;
   }
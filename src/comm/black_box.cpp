@@ -0,0 +1,223 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "black_box.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include "comm/packet_recorder.h"
+
+namespace livox_ros {
+
+const uint64_t kBlackBoxMinSize = 1024 * 1024;  /**< 1MB, fits any ethernet packet */
+
+BlackBox::~BlackBox() {
+  Stop();
+}
+
+bool BlackBox::Start(const BlackBoxConfig& config) {
+  if (is_enabled_.load() || config.path.empty()) {
+    return false;
+  }
+  config_ = config;
+  config_.size = std::max(config_.size, kBlackBoxMinSize);
+  if (mkdir(config_.path.c_str(), 0755) != 0 && errno != EEXIST) {
+    std::cout << "create black box directory failed, path: " << config_.path
+              << ", error: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // value-initialised, the pages are committed here and not on the packet path
+  ring_.assign(config_.size, 0);
+  snapshot_.assign(config_.size, 0);
+  head_ = 0;
+  tail_ = 0;
+  record_num_ = 0;
+
+  is_quit_ = false;
+  dump_thread_ = std::make_shared<std::thread>(&BlackBox::DumpProcess, this);
+  is_enabled_.store(true);
+  std::cout << "black box enabled, path: " << config_.path << ", size(bytes): " << config_.size
+            << ", window(ns): " << config_.window_ns << std::endl;
+  return true;
+}
+
+void BlackBox::Stop() {
+  is_enabled_.store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_quit_ = true;
+  }
+  condition_.notify_one();
+  if (dump_thread_ && dump_thread_->joinable()) {
+    dump_thread_->join();
+  }
+  dump_thread_ = nullptr;
+}
+
+void BlackBox::Record(uint32_t handle, uint8_t dev_type, const uint8_t* packet, uint32_t packet_size,
+                      uint64_t recv_time) {
+  uint32_t record_size = (sizeof(RecordHeader) + packet_size + kRecordAlignment - 1) &
+                         ~(kRecordAlignment - 1);
+  if (record_size > ring_.size()) {
+    return;
+  }
+
+  RecordHeader header;
+  memset(&header, 0, sizeof(header));
+  header.record_size = record_size;
+  header.handle = handle;
+  header.dev_type = dev_type;
+  header.packet_size = packet_size;
+  header.recv_time = recv_time;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Evict(record_size, recv_time);
+  CopyIn(head_, &header, sizeof(header));
+  CopyIn(head_ + sizeof(header), packet, packet_size);
+  head_ += record_size;
+  ++record_num_;
+}
+
+void BlackBox::Evict(uint64_t size, uint64_t recv_time) {
+  while (record_num_ > 0) {
+    RecordHeader oldest;
+    CopyOut(tail_, &oldest, sizeof(oldest));
+    bool is_full = head_ - tail_ + size > ring_.size();
+    bool is_expired = config_.window_ns != 0 && oldest.recv_time + config_.window_ns < recv_time;
+    if (!is_full && !is_expired) {
+      break;
+    }
+    tail_ += oldest.record_size;
+    --record_num_;
+  }
+}
+
+void BlackBox::CopyIn(uint64_t pos, const void* src, uint64_t size) {
+  uint64_t offset = pos % ring_.size();
+  uint64_t first = std::min(size, ring_.size() - offset);
+  memcpy(ring_.data() + offset, src, first);
+  memcpy(ring_.data(), static_cast<const uint8_t*>(src) + first, size - first);
+}
+
+void BlackBox::CopyOut(uint64_t pos, void* dst, uint64_t size) const {
+  uint64_t offset = pos % ring_.size();
+  uint64_t first = std::min(size, ring_.size() - offset);
+  memcpy(dst, ring_.data() + offset, first);
+  memcpy(static_cast<uint8_t*>(dst) + first, ring_.data(), size - first);
+}
+
+bool BlackBox::Dump(std::string& file_name) {
+  if (!is_enabled_.load()) {
+    return false;
+  }
+  time_t now = time(nullptr);
+  struct tm local_time;
+  localtime_r(&now, &local_time);
+  char name[64];
+  strftime(name, sizeof(name), "livox_blackbox_%Y%m%d_%H%M%S", &local_time);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_dumping_) {
+      return false;
+    }
+    // the only copy under the packet lock, the file is written by the dump thread
+    snapshot_size_ = head_ - tail_;
+    snapshot_record_num_ = record_num_;
+    CopyOut(tail_, snapshot_.data(), snapshot_size_);
+    snapshot_start_time_ = 0;
+    if (record_num_ > 0) {
+      snapshot_start_time_ = reinterpret_cast<const RecordHeader*>(snapshot_.data())->recv_time;
+    }
+    char index[16];
+    snprintf(index, sizeof(index), "_%03u", dump_index_++);
+    snapshot_path_ = config_.path + "/" + name + index + kRecordFileExtension;
+    file_name = snapshot_path_;
+    is_dumping_ = true;
+  }
+  condition_.notify_one();
+  return true;
+}
+
+void BlackBox::DumpProcess() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_quit_) {
+    condition_.wait(lock, [this] { return is_quit_ || is_dumping_; });
+    if (!is_dumping_) {
+      continue;
+    }
+    lock.unlock();
+    WriteSnapshot();
+    lock.lock();
+    is_dumping_ = false;
+  }
+}
+
+bool BlackBox::WriteSnapshot() {
+  int fd = open(snapshot_path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    std::cout << "create black box file failed, path: " << snapshot_path_
+              << ", error: " << strerror(errno) << std::endl;
+    return false;
+  }
+  RecordFileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kRecordFileMagic;
+  header.version = kRecordFileVersion;
+  header.header_size = sizeof(RecordFileHeader);
+  header.start_time = snapshot_start_time_;
+  header.data_size = snapshot_size_;
+  header.record_num = snapshot_record_num_;
+
+  bool is_ok = write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+  uint64_t written = 0;
+  while (is_ok && written < snapshot_size_) {
+    ssize_t ret = write(fd, snapshot_.data() + written, snapshot_size_ - written);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    is_ok = ret > 0;
+    written += is_ok ? ret : 0;
+  }
+  close(fd);
+  if (!is_ok) {
+    std::cout << "write black box file failed, path: " << snapshot_path_
+              << ", error: " << strerror(errno) << std::endl;
+    return false;
+  }
+  std::cout << "black box dumped to " << snapshot_path_ << ", packets: " << snapshot_record_num_
+            << ", bytes: " << snapshot_size_ << std::endl;
+  return true;
+}
+
+} // namespace livox_ros
@@ -0,0 +1,94 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_BLACK_BOX_H_
+#define LIVOX_ROS_DRIVER_BLACK_BOX_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+
+/**
+ * Pre-trigger ring of the latest raw packets of all lidars, kept as records of the
+ * raw packet record format. A dump copies the ring into a snapshot buffer and writes
+ * it to a record file in the background. Both buffers are allocated at start.
+ */
+class BlackBox {
+ public:
+  BlackBox() {}
+  ~BlackBox();
+  BlackBox(const BlackBox &) = delete;
+  BlackBox &operator=(const BlackBox &) = delete;
+
+  bool Start(const BlackBoxConfig& config);
+  void Stop();
+  bool IsEnabled() const { return is_enabled_.load(std::memory_order_relaxed); }
+
+  void Record(uint32_t handle, uint8_t dev_type, const uint8_t* packet, uint32_t packet_size,
+              uint64_t recv_time);
+
+  /** false if disabled or the previous dump is still being written */
+  bool Dump(std::string& file_name);
+
+ private:
+  void DumpProcess();
+  bool WriteSnapshot();
+  void Evict(uint64_t size, uint64_t recv_time);
+  void CopyIn(uint64_t pos, const void* src, uint64_t size);
+  void CopyOut(uint64_t pos, void* dst, uint64_t size) const;
+
+  BlackBoxConfig config_;
+  std::atomic<bool> is_enabled_{false};
+
+  std::mutex mutex_;
+  std::vector<uint8_t> ring_;
+  uint64_t head_ = 0;         /**< Byte position of the next record, wraps over ring_ */
+  uint64_t tail_ = 0;         /**< Byte position of the oldest record */
+  uint32_t record_num_ = 0;
+
+  std::vector<uint8_t> snapshot_;
+  uint64_t snapshot_size_ = 0;
+  uint32_t snapshot_record_num_ = 0;
+  uint64_t snapshot_start_time_ = 0;
+  std::string snapshot_path_;
+  uint32_t dump_index_ = 0;
+  bool is_dumping_ = false;
+
+  std::condition_variable condition_;
+  bool is_quit_ = false;
+  std::shared_ptr<std::thread> dump_thread_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_BLACK_BOX_H_
@@ -0,0 +1,213 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "clock_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace livox_ros {
+
+const uint64_t kClockSampleInterval = 50000000;  /**< 50ms of device time per sample */
+const size_t kClockMaxSamples = 200;             /**< 10s fitting window */
+const size_t kClockMinFitSamples = 4;
+const int64_t kClockJumpThreshold = 500000000;   /**< 500ms, the device rebooted or a clock stepped */
+const uint64_t kClockJumpConfirmTime = 1000000000; /**< 1s, late packets longer than this are a jump */
+const double kClockOutlierFactor = 3.0;          /**< in robust standard deviations */
+const double kClockMinOutlierBand = 50000.0;     /**< 50us, keeps a quiet link from rejecting everything */
+const double kClockMaxSkew = 0.001;              /**< 1000ppm, beyond any real oscillator */
+
+ClockEstimator::ClockEstimator() {
+  Reset();
+}
+
+void ClockEstimator::Reset() {
+  samples_.clear();
+  interval_min_ = {0, 0};
+  interval_index_ = 0;
+  has_interval_ = false;
+  ref_device_time_ = 0;
+  ref_offset_ = 0;
+  skew_ = 0.0;
+  has_model_ = false;
+  last_device_time_ = 0;
+  last_host_time_ = 0;
+  is_delayed_ = false;
+  delay_start_time_ = 0;
+}
+
+uint64_t ClockEstimator::ToHostTime(uint64_t device_time, uint64_t recv_time) {
+  ClockSample sample = {device_time, static_cast<int64_t>(recv_time - device_time)};
+  if (has_model_ && IsClockJump(sample)) {
+    std::cout << "device clock jumped, clock model reset" << std::endl;
+    Reset();
+  }
+  AddSample(sample);
+
+  uint64_t host_time = device_time + PredictOffset(device_time);
+  if (device_time >= last_device_time_) {
+    // a refit must not step time backwards, late packets keep their own earlier time
+    host_time = std::max(host_time, last_host_time_);
+    last_device_time_ = device_time;
+    last_host_time_ = host_time;
+  }
+  return host_time;
+}
+
+bool ClockEstimator::IsClockJump(const ClockSample& sample) {
+  if (sample.device_time + kClockJumpThreshold < last_device_time_) {
+    return true;
+  }
+  int64_t deviation = sample.offset - PredictOffset(sample.device_time);
+  if (deviation < -kClockJumpThreshold) {
+    return true;  // earlier than any packet could arrive
+  }
+  if (deviation <= kClockJumpThreshold) {
+    is_delayed_ = false;
+    return false;
+  }
+  // late packets are a host stall until they stay late
+  if (!is_delayed_) {
+    is_delayed_ = true;
+    delay_start_time_ = sample.device_time;
+  }
+  return sample.device_time - delay_start_time_ > kClockJumpConfirmTime;
+}
+
+void ClockEstimator::AddSample(const ClockSample& sample) {
+  uint64_t index = sample.device_time / kClockSampleInterval;
+  if (has_interval_ && index == interval_index_) {
+    if (sample.offset < interval_min_.offset) {
+      interval_min_ = sample;
+    }
+    if (samples_.size() >= kClockMinFitSamples) {
+      return;  // refitted once per interval
+    }
+  } else {
+    if (has_interval_) {
+      samples_.push_back(interval_min_);
+      if (samples_.size() > kClockMaxSamples) {
+        samples_.pop_front();
+      }
+    }
+    interval_min_ = sample;
+    interval_index_ = index;
+    has_interval_ = true;
+    if (samples_.size() >= kClockMinFitSamples) {
+      Fit();
+      return;
+    }
+  }
+
+  // too few samples for a slope yet, use the smallest offset seen
+  ClockSample lowest = interval_min_;
+  for (const auto& item : samples_) {
+    if (item.offset < lowest.offset) {
+      lowest = item;
+    }
+  }
+  ref_device_time_ = lowest.device_time;
+  ref_offset_ = lowest.offset;
+  skew_ = 0.0;
+  has_model_ = true;
+}
+
+void ClockEstimator::Fit() {
+  const ClockSample& ref = samples_.front();
+  size_t num = samples_.size();
+  std::vector<double> x(num);
+  std::vector<double> y(num);
+  for (size_t i = 0; i < num; ++i) {
+    x[i] = static_cast<double>(samples_[i].device_time - ref.device_time);
+    y[i] = static_cast<double>(samples_[i].offset - ref.offset);
+  }
+
+  std::vector<bool> inlier(num, true);
+  double slope = 0.0;
+  double intercept = 0.0;
+  for (int pass = 0; pass < 2; ++pass) {
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < num; ++i) {
+      if (!inlier[i]) {
+        continue;
+      }
+      sum_x += x[i];
+      sum_y += y[i];
+      sum_xx += x[i] * x[i];
+      sum_xy += x[i] * y[i];
+      ++count;
+    }
+    double denominator = count * sum_xx - sum_x * sum_x;
+    if (count < kClockMinFitSamples || denominator <= 0.0) {
+      break;
+    }
+    slope = (count * sum_xy - sum_x * sum_y) / denominator;
+    intercept = (sum_y - slope * sum_x) / count;
+    if (pass > 0) {
+      break;
+    }
+
+    // reject samples delayed by a busy host or network, based on the median absolute residual
+    std::vector<double> residuals(num);
+    for (size_t i = 0; i < num; ++i) {
+      residuals[i] = std::fabs(y[i] - (intercept + slope * x[i]));
+    }
+    std::vector<double> sorted = residuals;
+    std::nth_element(sorted.begin(), sorted.begin() + num / 2, sorted.end());
+    double band = std::max(kClockOutlierFactor * 1.4826 * sorted[num / 2], kClockMinOutlierBand);
+    for (size_t i = 0; i < num; ++i) {
+      inlier[i] = residuals[i] <= band;
+    }
+  }
+  slope = std::min(std::max(slope, -kClockMaxSkew), kClockMaxSkew);
+
+  // move the line down onto the fastest packets, those closest to the true emission time
+  double lowest = 0.0;
+  bool first = true;
+  for (size_t i = 0; i < num; ++i) {
+    if (!inlier[i]) {
+      continue;
+    }
+    double residual = y[i] - (intercept + slope * x[i]);
+    if (first || residual < lowest) {
+      lowest = residual;
+      first = false;
+    }
+  }
+
+  ref_device_time_ = ref.device_time;
+  ref_offset_ = ref.offset + static_cast<int64_t>(std::llround(intercept + lowest));
+  skew_ = slope;
+  has_model_ = true;
+}
+
+int64_t ClockEstimator::PredictOffset(uint64_t device_time) const {
+  double elapsed = static_cast<double>(static_cast<int64_t>(device_time - ref_device_time_));
+  return ref_offset_ + static_cast<int64_t>(std::llround(skew_ * elapsed));
+}
+
+} // namespace livox_ros
@@ -0,0 +1,79 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_CLOCK_ESTIMATOR_H_
+#define LIVOX_ROS_DRIVER_CLOCK_ESTIMATOR_H_
+
+#include <stdint.h>
+#include <deque>
+
+namespace livox_ros {
+
+/**
+ * Maps the free running clock of an unsynchronised lidar to the host clock.
+ * The offset between receive time and device time is sampled once per interval at its
+ * minimum, which tracks the lowest transport delay. A least-squares line through the samples,
+ * refitted without outliers and shifted onto their lower envelope, gives the mapping.
+ * Not thread safe.
+ */
+class ClockEstimator {
+ public:
+  ClockEstimator();
+
+  /** Host time of device_time, recv_time is the host time the packet carrying it arrived */
+  uint64_t ToHostTime(uint64_t device_time, uint64_t recv_time);
+  void Reset();
+  /** Rate of change of host time - device time, positive when the device clock runs slow */
+  double GetSkewPpm() const { return has_model_ ? skew_ * 1e6 : 0.0; }
+
+ private:
+  typedef struct {
+    uint64_t device_time;
+    int64_t offset;  /**< host time - device time */
+  } ClockSample;
+
+  bool IsClockJump(const ClockSample& sample);
+  void AddSample(const ClockSample& sample);
+  void Fit();
+  int64_t PredictOffset(uint64_t device_time) const;
+
+  std::deque<ClockSample> samples_;  /**< minimum offset of every sampling interval */
+  ClockSample interval_min_;
+  uint64_t interval_index_;
+  bool has_interval_;
+
+  uint64_t ref_device_time_;  /**< model: offset = ref_offset_ + skew_ * (device time - ref) */
+  int64_t ref_offset_;
+  double skew_;
+  bool has_model_;
+
+  uint64_t last_device_time_;  /**< latest device time, late packets do not move it */
+  uint64_t last_host_time_;    /**< host time of last_device_time_ */
+  bool is_delayed_;
+  uint64_t delay_start_time_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_CLOCK_ESTIMATOR_H_
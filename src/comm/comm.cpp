@@ -23,9 +23,12 @@
 //
 
 #include "comm/comm.h"
+#include "livox_lidar_def.h"
 #include <string.h>
 #include <arpa/inet.h>
 
+#include <algorithm>
+
 namespace livox_ros {
 
 /** Common function --------------------------------------------------------- */
@@ -47,6 +50,45 @@ uint32_t CalculatePacketQueueSize(const double publish_freq) {
   return queue_size;
 }
 
+LidarExtParameter MakeLidarExtParameter(const UserLivoxLidarConfig& config) {
+  LidarExtParameter lidar_param;
+  lidar_param.handle = config.handle;
+  lidar_param.lidar_type = kLivoxLidarType;
+  if (config.pcl_data_type == kLivoxLidarCartesianCoordinateLowData) {
+    // temporary resolution
+    lidar_param.param.roll  = config.extrinsic_param.roll;
+    lidar_param.param.pitch = config.extrinsic_param.pitch;
+    lidar_param.param.yaw   = config.extrinsic_param.yaw;
+    lidar_param.param.x     = config.extrinsic_param.x / 10;
+    lidar_param.param.y     = config.extrinsic_param.y / 10;
+    lidar_param.param.z     = config.extrinsic_param.z / 10;
+  } else {
+    lidar_param.param.roll  = config.extrinsic_param.roll;
+    lidar_param.param.pitch = config.extrinsic_param.pitch;
+    lidar_param.param.yaw   = config.extrinsic_param.yaw;
+    lidar_param.param.x     = config.extrinsic_param.x;
+    lidar_param.param.y     = config.extrinsic_param.y;
+    lidar_param.param.z     = config.extrinsic_param.z;
+  }
+  return lidar_param;
+}
+
+bool IsStreamingEnabled(const StreamingConfig& config) {
+  return (config.packet_num != 0) || (config.interval_ns != 0);
+}
+
+/** Upper bound of the sub-frame rate of one lidar in streaming mode */
+double CalculateStreamingFrequency(const StreamingConfig& config) {
+  double frequency = 0.0;
+  if (config.packet_num != 0) {
+    frequency = static_cast<double>(kMaxEthPacketRate) / config.packet_num;
+  }
+  if (config.interval_ns != 0) {
+    frequency = std::max(frequency, static_cast<double>(kNsPerSecond) / config.interval_ns);
+  }
+  return std::min(frequency, static_cast<double>(kMaxEthPacketRate));
+}
+
 std::string IpNumToString(uint32_t ip_num) {
   struct in_addr ip;
   ip.s_addr = ip_num;
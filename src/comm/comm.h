@@ -49,6 +49,7 @@ const uint32_t kMaxPointPerEthPacket = 100;
 const uint32_t kMinEthPacketQueueSize = 32;     /**< must be 2^n */
 const uint32_t kMaxEthPacketQueueSize = 131072; /**< must be 2^n */
 const uint32_t kImuEthPacketQueueSize = 256;
+const uint32_t kMaxEthPacketRate = 5000;        /**< packets per second of one lidar */
 
 /** Max packet length according to Ethernet MTU */
 const uint32_t KEthPacketMaxLength = 1500;
@@ -62,8 +63,15 @@ const int64_t kPacketTimeGap = 1000000;           /**< 1ms = 1000000ns */
 const int64_t kMaxPacketTimeGap = 1700000;
 /**< the threshold of device disconect */
 const int64_t kDeviceDisconnectThreshold = 1000000000;
+const uint64_t kSilenceCheckInterval = 100000000; /**< 100ms between checks for silent lidars */
 const uint32_t kNsPerSecond = 1000000000; /**< 1s  = 1000000000ns */
 const uint32_t kNsTolerantFrameTimeDeviation = 1000000; /**< 1ms  = 1000000ns */
+const uint64_t kFrameFlushTimeout = 20000000; /**< 20ms, flush a stalled frame this long after its end */
+const double kMaxIntegrationTime = 4.0;  /**< 4s, offsets of custom message points are 32 bit ns */
+const uint32_t kMaxPointChunkPoolSize = 256; /**< chunks kept for reuse across all lidars */
+const uint64_t kMaxPacketReorderWindow = 10000000; /**< 10ms, packets are held at most this long for reordering */
+const uint32_t kMaxPacketReorderNum = 64;          /**< packets held per lidar for reordering */
+const uint64_t kPacketReorderMaxStep = 20000000;   /**< 20ms, later packets are a clock step instead */
 const uint32_t kRatioOfMsToNs = 1000000; /**< 1ms  = 1000000ns */
 
 const int kPathStrMinSize = 4;   /**< Must more than 4 char */
@@ -82,6 +90,10 @@ const uint8_t kLineNumberDefault = 1;
 const uint8_t kLineNumberMid360 = 4;
 const uint8_t kLineNumberHAP = 6;    
 
+/** Frame flags, also carried in rsvd[0] of the livox custom message */
+const uint8_t kFrameFlagPartial = 0x01; /**< Closed by deadline, the lidar stalled or disconnected */
+const uint8_t kFrameFlagPacketLoss = 0x02; /**< Packets of the frame were lost or the packet times have a gap */
+
 // SDK related
 typedef enum {
   kIndustryLidarType = 1,
@@ -104,6 +116,7 @@ typedef enum {
   kConnectStateOn = 1,
   kConnectStateConfig = 2,
   kConnectStateSampling = 3,
+  kConnectStateDisconnected = 4, /**< Silent for kDeviceDisconnectThreshold, its resources are being reclaimed */
 } LidarConnectState;
 
 /** Device data source type */
@@ -111,6 +124,7 @@ typedef enum {
   kSourceRawLidar = 0, /**< Data from raw lidar. */
   kSourceRawHub = 1,   /**< Data from lidar hub. */
   kSourceLvxFile,      /**< Data from parse lvx file. */
+  kSourceRecordFile,   /**< Data from raw packet record files. */
   kSourceUndef,
 } LidarDataSourceType;
 
@@ -167,11 +181,18 @@ typedef struct {
   uint64_t offset_time;
 } PointXyzlt;
 
+/** Decoded points of one publish interval or sub-frame, shared read-only with the queues */
+typedef std::vector<PointXyzlt> PointChunk;
+typedef std::shared_ptr<const PointChunk> PointChunkPtr;
+
 typedef struct {
   uint32_t handle;
   uint8_t lidar_type; ////refer to LivoxLidarType
+  uint8_t flags;      /**< kFrameFlag bits */
   uint32_t points_num;
   PointXyzlt* points;
+  const PointChunkPtr* chunks; /**< Points referenced by chunk instead, when chunk_num is not 0 */
+  uint32_t chunk_num;
 } PointPacket;
 
 typedef struct {
@@ -186,10 +207,32 @@ typedef struct {
   LidarProtoType lidar_type;
   uint32_t handle;
   uint64_t base_time;
+  uint8_t flags;
   uint32_t points_num;
   std::vector<PointXyzlt> points;
+  std::vector<PointChunkPtr> chunks; /**< Used instead of points when not empty */
 } StoragePacket;
 
+/** Sub-frame streaming, a sub-frame is handed off once either limit is reached */
+typedef struct {
+  uint32_t packet_num;  /**< Packets per sub-frame, 0 for no packet limit. */
+  uint64_t interval_ns; /**< Max time span of a sub-frame, 0 for no time limit. */
+} StreamingConfig;
+
+/** Raw packet recording, disabled when path is empty */
+typedef struct {
+  std::string path;             /**< Directory of the segment files. */
+  uint64_t segment_size;        /**< Bytes preallocated per segment. */
+  uint64_t segment_interval_ns; /**< Max time span of a segment, 0 for no time limit. */
+} RecorderConfig;
+
+/** Pre-trigger ring of raw packets, disabled when path is empty */
+typedef struct {
+  std::string path;    /**< Directory the dumps are written to. */
+  uint64_t size;       /**< Bytes of the ring, the same again is preallocated for a dump. */
+  uint64_t window_ns;  /**< Max time span kept in the ring, 0 for no time limit. */
+} BlackBoxConfig;
+
 typedef struct {
   LidarProtoType lidar_type;
   uint32_t handle;
@@ -199,6 +242,9 @@ typedef struct {
   uint8_t line_num;
   uint64_t time_stamp;
   uint64_t point_interval;
+  uint8_t time_type;   /**< refer to TimestampType */
+  uint16_t udp_cnt;    /**< packet counter of the lidar */
+  uint64_t recv_time;  /**< host time the packet was received */
   std::vector<uint8_t> raw_data;
 } RawPacket;
 
@@ -295,6 +341,9 @@ constexpr uint32_t kDeviceTypeLidarMid70 = 6;
 /* Global function for general use */
 bool IsFilePathValid(const char *path_str);
 uint32_t CalculatePacketQueueSize(const double publish_freq);
+bool IsStreamingEnabled(const StreamingConfig& config);
+LidarExtParameter MakeLidarExtParameter(const UserLivoxLidarConfig& config);
+double CalculateStreamingFrequency(const StreamingConfig& config);
 std::string IpNumToString(uint32_t ip_num);
 uint32_t IpStringToNum(std::string ip_string);
 std::string ReplacePeriodByUnderline(std::string str);
@@ -0,0 +1,65 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "deadline_queue.h"
+
+#include <limits>
+
+namespace livox_ros {
+
+void DeadlineQueue::Schedule(uint32_t id, uint64_t deadline_ns) {
+  Cancel(id);
+  ids_[id] = deadlines_.emplace(deadline_ns, id);
+}
+
+void DeadlineQueue::Cancel(uint32_t id) {
+  auto it = ids_.find(id);
+  if (it == ids_.end()) {
+    return;
+  }
+  deadlines_.erase(it->second);
+  ids_.erase(it);
+}
+
+bool DeadlineQueue::IsScheduled(uint32_t id) const {
+  return ids_.find(id) != ids_.end();
+}
+
+uint64_t DeadlineQueue::GetNextDeadline() const {
+  if (deadlines_.empty()) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return deadlines_.begin()->first;
+}
+
+void DeadlineQueue::Advance(uint64_t now_ns, std::vector<uint32_t>& expired_ids) {
+  auto it = deadlines_.begin();
+  while (it != deadlines_.end() && it->first <= now_ns) {
+    expired_ids.push_back(it->second);
+    ids_.erase(it->second);
+    it = deadlines_.erase(it);
+  }
+}
+
+} // namespace livox_ros
@@ -0,0 +1,60 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_DEADLINE_QUEUE_H_
+#define LIVOX_ROS_DRIVER_DEADLINE_QUEUE_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace livox_ros {
+
+/**
+ * Deadlines ordered by time, one pending deadline per id.
+ * Not thread safe, meant to be driven by a single processing thread.
+ */
+class DeadlineQueue {
+ public:
+  /** Schedule or reschedule the deadline of id, in ns of the caller's clock */
+  void Schedule(uint32_t id, uint64_t deadline_ns);
+  void Cancel(uint32_t id);
+  bool IsScheduled(uint32_t id) const;
+
+  /** The earliest pending deadline, UINT64_MAX if nothing is scheduled */
+  uint64_t GetNextDeadline() const;
+
+  /** Collect the ids whose deadline is not later than now_ns, earliest first */
+  void Advance(uint64_t now_ns, std::vector<uint32_t>& expired_ids);
+
+ private:
+  typedef std::multimap<uint64_t, uint32_t> DeadlineMap;
+
+  DeadlineMap deadlines_;                          /**< key:deadline, val:id */
+  std::map<uint32_t, DeadlineMap::iterator> ids_;  /**< key:id, val:its entry in deadlines_ */
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_DEADLINE_QUEUE_H_
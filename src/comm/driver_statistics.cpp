@@ -0,0 +1,96 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "driver_statistics.h"
+
+namespace livox_ros {
+
+DriverStatistics& DriverStatistics::GetInstance() {
+  static DriverStatistics statistics;
+  return statistics;
+}
+
+DriverStatistics::LidarCounters* DriverStatistics::GetLidar(uint32_t handle) {
+  if (handle == 0) {
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    uint32_t slot_handle = lidars_[i].handle.load(std::memory_order_acquire);
+    if (slot_handle == handle) {
+      return &lidars_[i];
+    }
+    if (slot_handle == 0) {
+      if (lidars_[i].handle.compare_exchange_strong(slot_handle, handle, std::memory_order_acq_rel) ||
+          slot_handle == handle) {
+        return &lidars_[i];
+      }
+    }
+  }
+  return nullptr;
+}
+
+void DriverStatistics::Load(const LidarCounters& lidar, uint32_t handle, LidarStatistics& statistics) {
+  statistics.handle = handle;
+  statistics.packets = lidar.packets.load(std::memory_order_relaxed);
+  statistics.points = lidar.points.load(std::memory_order_relaxed);
+  statistics.imu_packets = lidar.imu_packets.load(std::memory_order_relaxed);
+  statistics.frames = lidar.frames.load(std::memory_order_relaxed);
+  statistics.dropped_frames = lidar.dropped_frames.load(std::memory_order_relaxed);
+  statistics.lost_packets = lidar.lost_packets.load(std::memory_order_relaxed);
+  statistics.reordered_packets = lidar.reordered_packets.load(std::memory_order_relaxed);
+  statistics.packet_gaps = lidar.packet_gaps.load(std::memory_order_relaxed);
+  statistics.unrecorded_packets = lidar.unrecorded_packets.load(std::memory_order_relaxed);
+  statistics.time_type = lidar.time_type.load(std::memory_order_relaxed);
+  statistics.clock_drift_ppm = lidar.clock_drift_ppm.load(std::memory_order_relaxed);
+}
+
+std::vector<LidarStatistics> DriverStatistics::GetSnapshot() const {
+  std::vector<LidarStatistics> snapshot;
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    uint32_t handle = lidars_[i].handle.load(std::memory_order_acquire);
+    if (handle == 0) {
+      break;
+    }
+    LidarStatistics statistics;
+    Load(lidars_[i], handle, statistics);
+    snapshot.push_back(statistics);
+  }
+  return snapshot;
+}
+
+bool DriverStatistics::GetLidarSnapshot(uint32_t handle, LidarStatistics& statistics) const {
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    uint32_t slot_handle = lidars_[i].handle.load(std::memory_order_acquire);
+    if (slot_handle == 0) {
+      break;
+    }
+    if (slot_handle == handle) {
+      Load(lidars_[i], handle, statistics);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace livox_ros
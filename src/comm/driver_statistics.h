@@ -0,0 +1,149 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_DRIVER_STATISTICS_H_
+#define LIVOX_ROS_DRIVER_DRIVER_STATISTICS_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+
+/** Counters of one lidar since startup */
+typedef struct {
+  uint32_t handle;
+  uint64_t packets;         /**< point cloud packets */
+  uint64_t points;
+  uint64_t imu_packets;
+  uint64_t frames;          /**< published frames */
+  uint64_t dropped_frames;  /**< frames dropped on a full lidar queue */
+  uint64_t lost_packets;    /**< udp counter holes no late packet filled */
+  uint64_t reordered_packets;
+  uint64_t packet_gaps;     /**< packet time jumps beyond kMaxPacketTimeGap */
+  uint64_t unrecorded_packets;  /**< packets the raw packet recorder had no room for */
+  uint8_t time_type;        /**< of the latest packet, refer to TimestampType */
+  double clock_drift_ppm;   /**< of the device clock against the host clock, unsynchronised lidars only */
+} LidarStatistics;
+
+/** Per-lidar counters of the whole driver, lock-free and safe to update from any thread */
+class DriverStatistics {
+ public:
+  static DriverStatistics& GetInstance();
+
+  void AddPacket(uint32_t handle, uint32_t points_num, uint8_t time_type) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->packets.fetch_add(1, std::memory_order_relaxed);
+      lidar->points.fetch_add(points_num, std::memory_order_relaxed);
+      lidar->time_type.store(time_type, std::memory_order_relaxed);
+    }
+  }
+  void AddImuPacket(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->imu_packets.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void AddFrame(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->frames.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void AddDroppedFrame(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->dropped_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void AddLostPackets(uint32_t handle, uint32_t packets_num) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->lost_packets.fetch_add(packets_num, std::memory_order_relaxed);
+    }
+  }
+  /** A late packet filled a hole counted as lost before */
+  void AddReorderedPacket(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->reordered_packets.fetch_add(1, std::memory_order_relaxed);
+      lidar->lost_packets.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  void AddPacketGap(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->packet_gaps.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void AddUnrecordedPacket(uint32_t handle) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->unrecorded_packets.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  void SetClockDrift(uint32_t handle, double ppm) {
+    LidarCounters* lidar = GetLidar(handle);
+    if (lidar != nullptr) {
+      lidar->clock_drift_ppm.store(ppm, std::memory_order_relaxed);
+    }
+  }
+
+  /** The counters of every lidar seen so far */
+  std::vector<LidarStatistics> GetSnapshot() const;
+  bool GetLidarSnapshot(uint32_t handle, LidarStatistics& statistics) const;
+
+ private:
+  DriverStatistics() = default;
+  DriverStatistics(const DriverStatistics&) = delete;
+  DriverStatistics& operator=(const DriverStatistics&) = delete;
+
+  struct LidarCounters {
+    std::atomic<uint32_t> handle{0};  /**< 0 for a free slot, claimed once and never released */
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> points{0};
+    std::atomic<uint64_t> imu_packets{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> dropped_frames{0};
+    std::atomic<uint64_t> lost_packets{0};
+    std::atomic<uint64_t> reordered_packets{0};
+    std::atomic<uint64_t> packet_gaps{0};
+    std::atomic<uint64_t> unrecorded_packets{0};
+    std::atomic<uint8_t> time_type{0};
+    std::atomic<double> clock_drift_ppm{0.0};
+  };
+
+  LidarCounters* GetLidar(uint32_t handle);
+  static void Load(const LidarCounters& lidar, uint32_t handle, LidarStatistics& statistics);
+
+  LidarCounters lidars_[kMaxSourceLidar];
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER_DRIVER_STATISTICS_H_
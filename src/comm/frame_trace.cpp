@@ -0,0 +1,87 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "frame_trace.h"
+
+#include <string.h>
+
+#include <chrono>
+
+namespace livox_ros {
+
+/** Frames which never complete, e.g. of a format without publisher, are evicted oldest first */
+const size_t kMaxPendingTraceFrames = 1024;
+
+FrameTrace& FrameTrace::GetInstance() {
+  static FrameTrace frame_trace;
+  return frame_trace;
+}
+
+void FrameTrace::SetSink(Sink sink) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = std::move(sink);
+  pending_.clear();
+  is_enabled_.store(static_cast<bool>(sink_));
+}
+
+uint64_t FrameTrace::GetTimeNs() {
+  /** the clock of PubHandler::GetHostTimeNs, which stamps the packet receive time */
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+void FrameTrace::BeginFrame(uint32_t handle, uint64_t base_time, uint32_t points_num, uint64_t received_time,
+                            uint64_t decoded_time) {
+  uint64_t now = GetTimeNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.size() >= kMaxPendingTraceFrames) {
+    pending_.erase(pending_.begin());
+  }
+  FrameTraceRecord& record = pending_[std::make_pair(base_time, handle)];
+  memset(&record, 0, sizeof(record));
+  record.handle = handle;
+  record.base_time = base_time;
+  record.points_num = points_num;
+  record.stage_time[kTraceReceived] = received_time;
+  record.stage_time[kTraceDecoded] = decoded_time;
+  record.stage_time[kTracePacked] = now;
+}
+
+void FrameTrace::MarkFrame(uint32_t handle, uint64_t base_time, FrameTraceStage stage, bool is_dropped) {
+  uint64_t now = GetTimeNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(std::make_pair(base_time, handle));
+  if (it == pending_.end()) {
+    return;
+  }
+  it->second.stage_time[stage] = now;
+  it->second.is_dropped = is_dropped;
+  if (is_dropped || stage == kTracePublished) {
+    if (sink_) {
+      sink_(it->second);
+    }
+    pending_.erase(it);
+  }
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,104 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_FRAME_TRACE_H_
+#define LIVOX_ROS_DRIVER_FRAME_TRACE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace livox_ros {
+
+/** Points a point cloud frame passes on its way to the publisher */
+typedef enum {
+  kTraceReceived = 0, /**< The packet closing the frame was received */
+  kTraceDecoded,      /**< The packet closing the frame was decoded */
+  kTracePacked,       /**< PubHandler handed the frame to Lds */
+  kTraceQueued,       /**< Pushed to the queue of the lidar */
+  kTracePopped,       /**< Popped by Lddc */
+  kTracePublished,    /**< The publish call returned */
+  kTraceStageNum
+} FrameTraceStage;
+
+typedef struct {
+  uint32_t handle;
+  uint64_t base_time;
+  uint32_t points_num;
+  bool is_dropped;                       /**< The lidar queue was full */
+  uint64_t stage_time[kTraceStageNum];   /**< ns, host clock of the packet receive time */
+} FrameTraceRecord;
+
+/** Per-frame stage timestamps for benchmarks, a single relaxed load when no sink is set */
+class FrameTrace {
+ public:
+  using Sink = std::function<void(const FrameTraceRecord& record)>;
+
+  static FrameTrace& GetInstance();
+
+  /** Completed and dropped frames are passed to the sink, nullptr stops tracing */
+  void SetSink(Sink sink);
+  bool IsEnabled() const { return is_enabled_.load(std::memory_order_relaxed); }
+
+  void Begin(uint32_t handle, uint64_t base_time, uint32_t points_num, uint64_t received_time,
+             uint64_t decoded_time) {
+    if (IsEnabled()) {
+      BeginFrame(handle, base_time, points_num, received_time, decoded_time);
+    }
+  }
+  void Mark(uint32_t handle, uint64_t base_time, FrameTraceStage stage) {
+    if (IsEnabled()) {
+      MarkFrame(handle, base_time, stage, false);
+    }
+  }
+  void Drop(uint32_t handle, uint64_t base_time) {
+    if (IsEnabled()) {
+      MarkFrame(handle, base_time, kTraceQueued, true);
+    }
+  }
+
+  static uint64_t GetTimeNs();
+
+ private:
+  FrameTrace() = default;
+  FrameTrace(const FrameTrace&) = delete;
+  FrameTrace& operator=(const FrameTrace&) = delete;
+
+  void BeginFrame(uint32_t handle, uint64_t base_time, uint32_t points_num, uint64_t received_time,
+                  uint64_t decoded_time);
+  void MarkFrame(uint32_t handle, uint64_t base_time, FrameTraceStage stage, bool is_dropped);
+
+  std::atomic<bool> is_enabled_{false};
+  std::mutex mutex_;
+  Sink sink_;
+  std::map<std::pair<uint64_t, uint32_t>, FrameTraceRecord> pending_;  /**< by base time, then handle */
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER_FRAME_TRACE_H_
@@ -0,0 +1,210 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "latency_histogram.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace livox_ros {
+
+namespace {
+
+const char* const kLatencyStageNames[kLatencyStageNum] = {
+  "receive_to_decode", "decode_to_pack", "pack_to_queue", "queue_to_pop", "pop_to_publish", "end_to_end"
+};
+
+/** Percentiles reported for every stage, with their json keys */
+const double kReportPercentiles[] = {50.0, 90.0, 99.0, 99.9};
+const char* const kReportPercentileNames[] = {"p50_us", "p90_us", "p99_us", "p999_us"};
+
+}  // namespace
+
+void LatencyHistogram::Reset() {
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::GetIndex(uint64_t value) {
+  const uint64_t kMaxValue = (1ULL << kMaxValueBits) - 1;
+  if (value > kMaxValue) {
+    value = kMaxValue;
+  }
+  if (value < 2 * kSubBucketNum) {
+    return static_cast<uint32_t>(value);
+  }
+  uint32_t msb = 63 - __builtin_clzll(value);
+  uint32_t shift = msb - kSubBucketBits;
+  uint32_t mantissa = static_cast<uint32_t>(value >> shift);
+  return 2 * kSubBucketNum + (shift - 1) * kSubBucketNum + (mantissa - kSubBucketNum);
+}
+
+uint64_t LatencyHistogram::GetUpperValue(uint32_t index) {
+  if (index < 2 * kSubBucketNum) {
+    return index;
+  }
+  uint32_t shift = (index - 2 * kSubBucketNum) / kSubBucketNum + 1;
+  uint64_t mantissa = (index - 2 * kSubBucketNum) % kSubBucketNum + kSubBucketNum;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percent) const {
+  uint64_t total = GetCount();
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(percent / 100.0 * total + 0.5);
+  rank = std::max<uint64_t>(1, std::min(rank, total));
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    count += counts_[i].load(std::memory_order_relaxed);
+    if (count >= rank) {
+      return std::min(GetUpperValue(i), GetMax());
+    }
+  }
+  return GetMax();
+}
+
+LatencyTracker& LatencyTracker::GetInstance() {
+  static LatencyTracker tracker;
+  return tracker;
+}
+
+void LatencyTracker::Enable() {
+  uint32_t lidar_num = lidar_num_.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < lidar_num; ++i) {
+    for (uint32_t j = 0; j < kLatencyStageNum; ++j) {
+      lidars_[i]->stages[j].Reset();
+    }
+    lidars_[i]->dropped_frames.store(0);
+  }
+  is_enabled_.store(true);
+  FrameTrace::GetInstance().SetSink([this](const FrameTraceRecord& record) { OnFrame(record); });
+}
+
+void LatencyTracker::Disable() {
+  if (is_enabled_.exchange(false)) {
+    FrameTrace::GetInstance().SetSink(nullptr);
+  }
+}
+
+LatencyTracker::LidarLatency* LatencyTracker::GetLidar(uint32_t handle) {
+  uint32_t lidar_num = lidar_num_.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < lidar_num; ++i) {
+    if (lidars_[i]->handle == handle) {
+      return lidars_[i].get();
+    }
+  }
+  if (lidar_num >= kMaxSourceLidar) {
+    return nullptr;
+  }
+  lidars_[lidar_num].reset(new LidarLatency());
+  lidars_[lidar_num]->handle = handle;
+  lidar_num_.store(lidar_num + 1, std::memory_order_release);
+  return lidars_[lidar_num].get();
+}
+
+void LatencyTracker::OnFrame(const FrameTraceRecord& record) {
+  LidarLatency* lidar = GetLidar(record.handle);
+  if (lidar == nullptr) {
+    return;
+  }
+  if (record.is_dropped) {
+    lidar->dropped_frames.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const uint64_t* time = record.stage_time;
+  for (uint32_t i = 0; i < kLatencyEndToEnd; ++i) {
+    /** the receive clock of replayed packets is not the host clock, such deltas are skipped */
+    if (time[i + 1] >= time[i] && time[i] != 0) {
+      lidar->stages[i].Record(time[i + 1] - time[i]);
+    }
+  }
+  if (time[kTracePublished] >= time[kTraceReceived] && time[kTraceReceived] != 0) {
+    lidar->stages[kLatencyEndToEnd].Record(time[kTracePublished] - time[kTraceReceived]);
+  }
+}
+
+std::string LatencyTracker::ToJson() const {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("lidars");
+  writer.StartArray();
+  uint32_t lidar_num = lidar_num_.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < lidar_num; ++i) {
+    const LidarLatency& lidar = *lidars_[i];
+    writer.StartObject();
+    writer.Key("handle");
+    writer.Uint(lidar.handle);
+    writer.Key("ip");
+    writer.String(IpNumToString(lidar.handle).c_str());
+    writer.Key("frames");
+    writer.Uint64(lidar.stages[kLatencyEndToEnd].GetCount());
+    writer.Key("dropped_frames");
+    writer.Uint64(lidar.dropped_frames.load(std::memory_order_relaxed));
+    writer.Key("stages");
+    writer.StartObject();
+    for (uint32_t j = 0; j < kLatencyStageNum; ++j) {
+      const LatencyHistogram& histogram = lidar.stages[j];
+      writer.Key(kLatencyStageNames[j]);
+      writer.StartObject();
+      writer.Key("count");
+      writer.Uint64(histogram.GetCount());
+      for (size_t k = 0; k < sizeof(kReportPercentiles) / sizeof(kReportPercentiles[0]); ++k) {
+        writer.Key(kReportPercentileNames[k]);
+        writer.Double(histogram.GetPercentile(kReportPercentiles[k]) / 1e3);
+      }
+      writer.Key("max_us");
+      writer.Double(histogram.GetMax() / 1e3);
+      writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+  return buffer.GetString();
+}
+
+bool LatencyTracker::DumpToFile(const std::string& path) const {
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    printf("Open latency dump file failed: %s\n", path.c_str());
+    return false;
+  }
+  std::string json = ToJson();
+  bool is_ok = (fwrite(json.data(), 1, json.size(), file) == json.size());
+  fclose(file);
+  return is_ok;
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,118 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_LATENCY_HISTOGRAM_H_
+#define LIVOX_ROS_DRIVER_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "comm/comm.h"
+#include "comm/frame_trace.h"
+
+namespace livox_ros {
+
+/** Log-linear buckets of 32 sub-buckets per power of two (~3% error), lock-free recording */
+class LatencyHistogram {
+ public:
+  static const uint32_t kSubBucketBits = 5;
+  static const uint32_t kSubBucketNum = 1 << kSubBucketBits;
+  static const uint32_t kMaxValueBits = 36;  /**< ~68 s, larger values are clamped */
+  static const uint32_t kBucketNum = 2 * kSubBucketNum + (kMaxValueBits - kSubBucketBits - 1) * kSubBucketNum;
+
+  LatencyHistogram() { Reset(); }
+
+  void Record(uint64_t value) {
+    counts_[GetIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  void Reset();
+  uint64_t GetCount() const { return total_.load(std::memory_order_relaxed); }
+  uint64_t GetMax() const { return max_.load(std::memory_order_relaxed); }
+  /** The upper bound of the bucket holding the percentile */
+  uint64_t GetPercentile(double percent) const;
+
+ private:
+  static uint32_t GetIndex(uint64_t value);
+  static uint64_t GetUpperValue(uint32_t index);
+
+  std::atomic<uint64_t> counts_[kBucketNum];
+  std::atomic<uint64_t> total_;
+  std::atomic<uint64_t> max_;
+};
+
+/** Stage latencies of traced frames */
+typedef enum {
+  kLatencyReceiveToDecode = 0,
+  kLatencyDecodeToPack,
+  kLatencyPackToQueue,
+  kLatencyQueueToPop,
+  kLatencyPopToPublish,
+  kLatencyEndToEnd,     /**< Packet receive to publish return */
+  kLatencyStageNum
+} LatencyStage;
+
+/** Histograms of every lidar and stage, fed by FrameTrace while enabled */
+class LatencyTracker {
+ public:
+  static LatencyTracker& GetInstance();
+
+  void Enable();
+  void Disable();
+  bool IsEnabled() const { return is_enabled_.load(); }
+
+  /** Cumulative since Enable(), percentiles and max in us */
+  std::string ToJson() const;
+  bool DumpToFile(const std::string& path) const;
+
+ private:
+  LatencyTracker() = default;
+  LatencyTracker(const LatencyTracker&) = delete;
+  LatencyTracker& operator=(const LatencyTracker&) = delete;
+
+  struct LidarLatency {
+    uint32_t handle;
+    LatencyHistogram stages[kLatencyStageNum];
+    std::atomic<uint64_t> dropped_frames{0};
+  };
+
+  void OnFrame(const FrameTraceRecord& record);
+  LidarLatency* GetLidar(uint32_t handle);
+
+  std::atomic<bool> is_enabled_{false};
+  /** slots are only claimed by the FrameTrace sink, readers see lidar_num_ after the slot is set up */
+  std::unique_ptr<LidarLatency> lidars_[kMaxSourceLidar];
+  std::atomic<uint32_t> lidar_num_{0};
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER_LATENCY_HISTOGRAM_H_
@@ -68,6 +68,7 @@ bool DeInitQueue(LidarDataQueue *queue) {
 
   if (queue->storage_packet) {
     delete[] queue->storage_packet;
+    queue->storage_packet = nullptr;
   }
 
   queue->rd_idx = 0;
@@ -78,6 +79,28 @@ bool DeInitQueue(LidarDataQueue *queue) {
   return true;
 }
 
+/* Only while the queue is empty, the indices are kept so the reader keeps seeing it empty */
+bool ResizeQueue(LidarDataQueue *queue, uint32_t queue_size) {
+  if (queue == nullptr || queue->storage_packet == nullptr || !QueueIsEmpty(queue)) {
+    return false;
+  }
+
+  if (!IsPowerOf2(queue_size)) {
+    queue_size = RoundupPowerOf2(queue_size);
+  }
+  if (queue_size == queue->size) {
+    return true;
+  }
+
+  StoragePacket *storage_packet = new StoragePacket[queue_size];
+  delete[] queue->storage_packet;
+  queue->storage_packet = storage_packet;
+  queue->size = queue_size;
+  queue->mask = queue_size - 1;
+
+  return true;
+}
+
 void ResetQueue(LidarDataQueue *queue) {
   queue->rd_idx = 0;
   queue->wr_idx = 0;
@@ -97,7 +120,13 @@ bool QueuePrePop(LidarDataQueue *queue, StoragePacket *storage_packet) {
   uint32_t rd_idx = queue->rd_idx & queue->mask;
 
   storage_packet->base_time = queue->storage_packet[rd_idx].base_time;
+  storage_packet->flags = queue->storage_packet[rd_idx].flags;
   storage_packet->points_num = queue->storage_packet[rd_idx].points_num;
+  storage_packet->chunks = queue->storage_packet[rd_idx].chunks;
+  if (!storage_packet->chunks.empty()) {
+    storage_packet->points.clear();
+    return true;
+  }
   storage_packet->points.resize(queue->storage_packet[rd_idx].points_num);
 
   memcpy(storage_packet->points.data(), queue->storage_packet[rd_idx].points.data(), (storage_packet->points_num) * sizeof(PointXyzlt));
@@ -105,6 +134,8 @@ bool QueuePrePop(LidarDataQueue *queue, StoragePacket *storage_packet) {
 }
 
 void QueuePopUpdate(LidarDataQueue *queue) {
+  // drop the chunk references early so the producer can reuse them
+  queue->storage_packet[queue->rd_idx & queue->mask].chunks.clear();
   queue->rd_idx++;
 }
 
@@ -137,9 +168,18 @@ uint32_t QueuePushAny(LidarDataQueue *queue, uint8_t *data, const uint64_t base_
   uint32_t wr_idx = queue->wr_idx & queue->mask;
   PointPacket* lidar_point_data = reinterpret_cast<PointPacket*>(data);
   queue->storage_packet[wr_idx].base_time = base_time;
+  queue->storage_packet[wr_idx].flags = lidar_point_data->flags;
   queue->storage_packet[wr_idx].points_num = lidar_point_data->points_num;
 
   queue->storage_packet[wr_idx].points.clear();
+  queue->storage_packet[wr_idx].chunks.clear();
+  if (lidar_point_data->chunk_num != 0) {
+    // sliding window frames and sub-frames share their chunks, only the references are queued
+    queue->storage_packet[wr_idx].chunks.assign(lidar_point_data->chunks,
+        lidar_point_data->chunks + lidar_point_data->chunk_num);
+    queue->wr_idx++;
+    return 1;
+  }
   queue->storage_packet[wr_idx].points.resize(lidar_point_data->points_num);
   memcpy(queue->storage_packet[wr_idx].points.data(), lidar_point_data->points, sizeof(PointXyzlt) * (lidar_point_data->points_num));
 
@@ -51,6 +51,7 @@ inline static uint32_t RoundupPowerOf2(uint32_t size) {
 /** queue operate function */
 bool InitQueue(LidarDataQueue *queue, uint32_t queue_size);
 bool DeInitQueue(LidarDataQueue *queue);
+bool ResizeQueue(LidarDataQueue *queue, uint32_t queue_size);
 void ResetQueue(LidarDataQueue *queue);
 bool QueuePrePop(LidarDataQueue *queue, StoragePacket *storage_packet);
 void QueuePopUpdate(LidarDataQueue *queue);
@@ -59,6 +59,11 @@ bool LidarImuDataQueue::Empty() {
   return imu_data_queue_.empty();
 }
 
+size_t LidarImuDataQueue::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return imu_data_queue_.size();
+}
+
 void LidarImuDataQueue::Clear() {
   std::list<ImuData> tmp_imu_data_queue;
   {
@@ -64,6 +64,7 @@ class LidarImuDataQueue {
   void Push(ImuData* imu_data);
   bool Pop(ImuData& imu_data);
   bool Empty();
+  size_t Size();
   void Clear();
 
  private:
@@ -0,0 +1,159 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "lvx2_file.h"
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace livox_ros {
+
+const uint64_t kLvx2PrefetchWindow = 32 * 1024 * 1024;  /**< bytes read ahead of the frame iteration */
+
+bool Lvx2File::IsLvx2File(const uint8_t* data, uint64_t size) {
+  if (data == nullptr || size < sizeof(Lvx2PublicHeader)) {
+    return false;
+  }
+  const Lvx2PublicHeader* header = reinterpret_cast<const Lvx2PublicHeader*>(data);
+  return header->magic_code == kLvx2MagicCode && header->version[0] == 2;
+}
+
+bool Lvx2File::Open(const std::string& path) {
+  Close();
+  if (!file_.Open(path)) {
+    return false;
+  }
+  const uint8_t* data = file_.Data();
+  uint64_t headers_size = sizeof(Lvx2PublicHeader) + sizeof(Lvx2PrivateHeader);
+  if (!IsLvx2File(data, file_.Size()) || file_.Size() < headers_size) {
+    std::cout << "not a lvx2 file: " << path << std::endl;
+    file_.Close();
+    return false;
+  }
+
+  const Lvx2PrivateHeader* private_header =
+      reinterpret_cast<const Lvx2PrivateHeader*>(data + sizeof(Lvx2PublicHeader));
+  frame_duration_ = private_header->frame_duration;
+  uint64_t device_offset = headers_size;
+  frame_offset_ = device_offset + private_header->device_count * sizeof(Lvx2DeviceInfo);
+  if (frame_offset_ > file_.Size()) {
+    std::cout << "lvx2 device info truncated: " << path << std::endl;
+    file_.Close();
+    return false;
+  }
+  for (uint8_t i = 0; i < private_header->device_count; ++i) {
+    Lvx2DeviceInfo info;
+    memcpy(&info, data + device_offset + i * sizeof(Lvx2DeviceInfo), sizeof(info));
+    device_infos_[info.lidar_id] = info;
+  }
+
+  read_offset_.store(frame_offset_);
+  is_quit_.store(false);
+  file_.Advise(0, file_.Size(), MADV_SEQUENTIAL);
+  prefetch_thread_ = std::make_shared<std::thread>(&Lvx2File::PrefetchProcess, this);
+  std::cout << "lvx2 file: " << path << ", devices: " << device_infos_.size()
+            << ", frame duration(ms): " << frame_duration_ << std::endl;
+  return true;
+}
+
+void Lvx2File::Close() {
+  is_quit_.store(true);
+  prefetch_condition_.notify_one();
+  if (prefetch_thread_ && prefetch_thread_->joinable()) {
+    prefetch_thread_->join();
+  }
+  prefetch_thread_ = nullptr;
+  file_.Close();
+  device_infos_.clear();
+  frame_duration_ = 0;
+  frame_offset_ = 0;
+}
+
+bool Lvx2File::NextFrame(const uint8_t*& packages, uint64_t& size) {
+  uint64_t file_size = file_.Size();
+  if (frame_offset_ + sizeof(Lvx2FrameHeader) > file_size) {
+    return false;
+  }
+  const Lvx2FrameHeader* header = reinterpret_cast<const Lvx2FrameHeader*>(file_.Data() + frame_offset_);
+  uint64_t begin = frame_offset_ + sizeof(Lvx2FrameHeader);
+  uint64_t end = header->next_offset;
+  if (end <= begin || end > file_size) {
+    end = file_size;  // the last frame of a file that was not closed
+  }
+
+  packages = file_.Data() + begin;
+  size = end - begin;
+  frame_offset_ = end;
+
+  read_offset_.store(begin);
+  prefetch_condition_.notify_one();
+  return true;
+}
+
+bool Lvx2File::NextPackage(const uint8_t*& cursor, const uint8_t* end,
+                           const Lvx2PackageHeader*& header, const uint8_t*& data) {
+  if (cursor + sizeof(Lvx2PackageHeader) > end) {
+    return false;
+  }
+  header = reinterpret_cast<const Lvx2PackageHeader*>(cursor);
+  data = cursor + sizeof(Lvx2PackageHeader);
+  if (header->length > static_cast<uint64_t>(end - data)) {
+    return false;
+  }
+  cursor = data + header->length;
+  return true;
+}
+
+void Lvx2File::PrefetchProcess() {
+  uint64_t prefetched = read_offset_.load();
+  uint64_t released = 0;
+  while (!is_quit_.load()) {
+    uint64_t read_offset = read_offset_.load();
+    uint64_t target = std::min(read_offset + kLvx2PrefetchWindow, file_.Size());
+    if (target > prefetched) {
+      file_.Advise(prefetched, target - prefetched, MADV_WILLNEED);
+      prefetched = target;
+    }
+    // frames are read once, drop what was iterated to keep the page cache footprint flat
+    if (read_offset > released + kLvx2PrefetchWindow) {
+      uint64_t release_end = read_offset - kLvx2PrefetchWindow;
+      file_.Advise(released, release_end - released, MADV_DONTNEED);
+      released = release_end;
+    }
+    if (prefetched >= file_.Size()) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(prefetch_mutex_);
+    prefetch_condition_.wait_for(lock, std::chrono::milliseconds(100), [this, read_offset] {
+      return is_quit_.load() || read_offset_.load() != read_offset;
+    });
+  }
+}
+
+} // namespace livox_ros
@@ -0,0 +1,136 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_LVX2_FILE_H_
+#define LIVOX_ROS_DRIVER_LVX2_FILE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "comm/mapped_file.h"
+
+namespace livox_ros {
+
+const uint32_t kLvx2MagicCode = 0xAC0EA767;
+
+#pragma pack(1)
+
+typedef struct {
+  char signature[16];  /**< "livox_tech" */
+  uint8_t version[4];
+  uint32_t magic_code;
+} Lvx2PublicHeader;
+
+typedef struct {
+  uint32_t frame_duration;  /**< ms */
+  uint8_t device_count;
+} Lvx2PrivateHeader;
+
+typedef struct {
+  uint8_t lidar_sn[16];
+  uint8_t hub_sn[16];
+  uint32_t lidar_id;
+  uint8_t lidar_type;
+  uint8_t device_type;  /**< refer to LivoxLidarDeviceType */
+  uint8_t extrinsic_enable;
+  float roll;   /**< degree */
+  float pitch;
+  float yaw;
+  float x;      /**< m */
+  float y;
+  float z;
+} Lvx2DeviceInfo;
+
+typedef struct {
+  uint64_t current_offset;
+  uint64_t next_offset;
+  uint64_t frame_index;
+} Lvx2FrameHeader;
+
+typedef struct {
+  uint8_t version;
+  uint32_t lidar_id;
+  uint8_t lidar_type;
+  uint8_t timestamp_type;
+  uint8_t timestamp[8];
+  uint16_t udp_counter;
+  uint8_t data_type;
+  uint32_t length;      /**< bytes of point data that follow */
+  uint8_t frame_counter;
+  uint8_t reserve[4];
+} Lvx2PackageHeader;
+
+#pragma pack()
+
+/**
+ * Livox Viewer 2 point cloud file. Frames and packages are iterated in place in a
+ * read-only mapping, a prefetch thread reads ahead of the iteration and releases
+ * the pages behind it.
+ */
+class Lvx2File {
+ public:
+  Lvx2File() {}
+  ~Lvx2File() { Close(); }
+  Lvx2File(const Lvx2File &) = delete;
+  Lvx2File &operator=(const Lvx2File &) = delete;
+
+  static bool IsLvx2File(const uint8_t* data, uint64_t size);
+
+  bool Open(const std::string& path);
+  void Close();
+
+  uint32_t GetFrameDuration() const { return frame_duration_; }
+  const std::map<uint32_t, Lvx2DeviceInfo>& GetDeviceInfos() const { return device_infos_; }
+
+  /** The packages of the next frame, false at the end of the file */
+  bool NextFrame(const uint8_t*& packages, uint64_t& size);
+
+  /** The next package in [cursor, end), cursor is moved past it */
+  static bool NextPackage(const uint8_t*& cursor, const uint8_t* end,
+                          const Lvx2PackageHeader*& header, const uint8_t*& data);
+
+ private:
+  void PrefetchProcess();
+
+  MappedFile file_;
+  std::map<uint32_t, Lvx2DeviceInfo> device_infos_;  /**< key:lidar id */
+  uint32_t frame_duration_ = 0;
+  uint64_t frame_offset_ = 0;
+
+  std::atomic<uint64_t> read_offset_{0};
+  std::atomic<bool> is_quit_{false};
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_condition_;
+  std::shared_ptr<std::thread> prefetch_thread_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_LVX2_FILE_H_
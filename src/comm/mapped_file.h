@@ -0,0 +1,58 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_MAPPED_FILE_H_
+#define LIVOX_ROS_DRIVER_MAPPED_FILE_H_
+
+#include <stdint.h>
+#include <string>
+
+namespace livox_ros {
+
+/** Read-only memory mapping of a whole file */
+class MappedFile {
+ public:
+  MappedFile() {}
+  ~MappedFile() { Close(); }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool Open(const std::string& path);
+  void Close();
+
+  /** Hint the kernel to read ahead the given range, advice is a madvise flag */
+  void Advise(uint64_t offset, uint64_t length, int advice) const;
+
+  const uint8_t* Data() const { return data_; }
+  uint64_t Size() const { return size_; }
+  bool IsOpen() const { return data_ != nullptr; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_MAPPED_FILE_H_
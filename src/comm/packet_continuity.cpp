@@ -0,0 +1,83 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "packet_continuity.h"
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+
+const uint16_t kMaxPacketReorderDistance = 64;  /**< counter steps back still taken as a late packet */
+const uint16_t kMaxPacketCntJump = 0x8000;     /**< forward steps beyond half the counter are backward */
+
+void PacketContinuity::Reset() {
+  next_udp_cnt_ = 0;
+  open_holes_ = 0;
+  last_time_stamp_ = 0;
+  time_type_ = 0;
+  is_first_ = true;
+}
+
+PacketContinuityResult PacketContinuity::Update(uint16_t udp_cnt, uint64_t time_stamp, uint8_t time_type) {
+  PacketContinuityResult result = {0, false, false};
+  if (is_first_ || time_type != time_type_) {
+    // packet times on the new clock are not comparable, the counter carries on
+    if (is_first_) {
+      next_udp_cnt_ = udp_cnt;
+    }
+    last_time_stamp_ = time_stamp;
+    time_type_ = time_type;
+    is_first_ = false;
+  }
+
+  uint16_t ahead = static_cast<uint16_t>(udp_cnt - next_udp_cnt_);
+  if (ahead >= kMaxPacketCntJump) {
+    uint16_t behind = static_cast<uint16_t>(next_udp_cnt_ - udp_cnt);
+    if (behind <= kMaxPacketReorderDistance && open_holes_ > 0) {
+      --open_holes_;
+      result.is_reordered = true;
+      return result;
+    }
+    // the lidar restarted its counter
+    ahead = 0;
+    open_holes_ = 0;
+    last_time_stamp_ = time_stamp;
+  }
+
+  result.lost = ahead;
+  open_holes_ += ahead;
+  if (open_holes_ > kMaxPacketReorderDistance) {
+    open_holes_ = kMaxPacketReorderDistance;
+  }
+  next_udp_cnt_ = static_cast<uint16_t>(udp_cnt + 1);
+
+  if (time_stamp > last_time_stamp_ &&
+      time_stamp - last_time_stamp_ > static_cast<uint64_t>(kMaxPacketTimeGap)) {
+    result.is_gap = true;
+  }
+  last_time_stamp_ = time_stamp;
+  return result;
+}
+
+} // namespace livox_ros
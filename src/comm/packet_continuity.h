@@ -0,0 +1,62 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_PACKET_CONTINUITY_H_
+#define LIVOX_ROS_DRIVER_PACKET_CONTINUITY_H_
+
+#include <stdint.h>
+
+namespace livox_ros {
+
+/** What one packet revealed about the packet stream of its lidar */
+typedef struct {
+  uint32_t lost;      /**< packets skipped by the udp counter before this one */
+  bool is_reordered;  /**< arrived after a later packet, it fills an earlier hole */
+  bool is_gap;        /**< the packet time jumped by more than kMaxPacketTimeGap */
+} PacketContinuityResult;
+
+/**
+ * Follows the udp counter and the timestamps of the point cloud packets of one lidar in
+ * arrival order. Counter holes are lost packets until a late packet fills one, counter
+ * jumps back beyond the reorder distance are a restarted lidar and resynchronise.
+ * Not thread safe.
+ */
+class PacketContinuity {
+ public:
+  PacketContinuity() { Reset(); }
+
+  PacketContinuityResult Update(uint16_t udp_cnt, uint64_t time_stamp, uint8_t time_type);
+  void Reset();
+
+ private:
+  uint16_t next_udp_cnt_;
+  uint32_t open_holes_;       /**< lost packets a late arrival may still fill */
+  uint64_t last_time_stamp_;  /**< of the latest packet in counter order */
+  uint8_t time_type_;
+  bool is_first_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_PACKET_CONTINUITY_H_
@@ -0,0 +1,293 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "packet_recorder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "comm/driver_statistics.h"
+
+namespace livox_ros {
+
+const uint64_t kRecordMinSegmentSize = 1024 * 1024;  /**< 1MB, fits any ethernet packet */
+/** Segments are rotated this far before they are full, the rest takes the packets meanwhile */
+const uint64_t kRecordRotateReserve = 8 * 1024 * 1024;
+const std::chrono::milliseconds kRecordCheckInterval(100);  /**< of the segment time span */
+
+PacketRecorder::PacketRecorder() {}
+
+PacketRecorder::~PacketRecorder() {
+  Stop();
+}
+
+bool PacketRecorder::Start(const RecorderConfig& config) {
+  if (is_recording_.load() || config.path.empty()) {
+    return false;
+  }
+  config_ = config;
+  if (config_.segment_size < kRecordMinSegmentSize) {
+    config_.segment_size = kRecordMinSegmentSize;
+  }
+  if (mkdir(config_.path.c_str(), 0755) != 0 && errno != EEXIST) {
+    std::cout << "create record directory failed, path: " << config_.path
+              << ", error: " << strerror(errno) << std::endl;
+    return false;
+  }
+  if (!PrepareSegment(segments_[0])) {
+    return false;
+  }
+  active_.store(&segments_[0]);
+
+  is_quit_ = false;
+  is_rotate_requested_ = false;
+  is_recording_.store(true);
+  segment_thread_ = std::make_shared<std::thread>(&PacketRecorder::SegmentProcess, this);
+  std::cout << "raw packet recording to " << config_.path << ", segment size(bytes): "
+            << config_.segment_size << ", segment interval(ns): " << config_.segment_interval_ns
+            << std::endl;
+  return true;
+}
+
+void PacketRecorder::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_recording_.load()) {
+      return;
+    }
+    is_recording_.store(false);
+    is_quit_ = true;
+  }
+  condition_.notify_one();
+  if (segment_thread_ && segment_thread_->joinable()) {
+    segment_thread_->join();
+  }
+  segment_thread_ = nullptr;
+
+  active_.store(nullptr);
+  CloseSegment(segments_[0]);
+  CloseSegment(segments_[1]);
+  std::cout << "raw packet recording stopped, dropped packets: " << dropped_count_.load() << std::endl;
+}
+
+void PacketRecorder::Record(uint32_t handle, uint8_t dev_type, const uint8_t* packet,
+                            uint32_t packet_size, uint64_t recv_time) {
+  uint32_t record_size = (sizeof(RecordHeader) + packet_size + kRecordAlignment - 1) &
+                         ~(kRecordAlignment - 1);
+  Segment* segment = AcquireActiveSegment();
+  if (segment == nullptr) {
+    return;
+  }
+
+  uint64_t offset = segment->offset.fetch_add(record_size);
+  if (offset + record_size > segment->capacity) {
+    // only the first packet that does not fit marks the end and wakes the segment thread
+    bool is_first_miss = (offset <= segment->capacity);
+    if (is_first_miss) {
+      segment->data_end.store(offset);
+    }
+    segment->writers.fetch_sub(1);
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    DriverStatistics::GetInstance().AddUnrecordedPacket(handle);
+    if (is_first_miss) {
+      RequestRotation();
+    }
+    return;
+  }
+
+  if (offset == sizeof(RecordFileHeader)) {
+    segment->start_time.store(recv_time);
+    reinterpret_cast<RecordFileHeader*>(segment->base)->start_time = recv_time;
+  }
+  RecordHeader* header = reinterpret_cast<RecordHeader*>(segment->base + offset);
+  header->record_size = record_size;
+  header->handle = handle;
+  header->dev_type = dev_type;
+  header->packet_size = packet_size;
+  header->recv_time = recv_time;
+  memcpy(segment->base + offset + sizeof(RecordHeader), packet, packet_size);
+  segment->last_time.store(recv_time, std::memory_order_relaxed);
+  segment->record_num.fetch_add(1, std::memory_order_relaxed);
+  uint64_t rotate_offset = segment->capacity - std::min(kRecordRotateReserve, segment->capacity / 4);
+  segment->writers.fetch_sub(1);
+
+  if (offset < rotate_offset && offset + record_size >= rotate_offset) {
+    RequestRotation();
+  }
+}
+
+PacketRecorder::Segment* PacketRecorder::AcquireActiveSegment() {
+  Segment* segment = active_.load();
+  while (segment != nullptr) {
+    segment->writers.fetch_add(1);
+    // still active after registering, the segment thread waits for this writer before closing it
+    Segment* active = active_.load();
+    if (active == segment) {
+      return segment;
+    }
+    segment->writers.fetch_sub(1);
+    segment = active;
+  }
+  return nullptr;
+}
+
+void PacketRecorder::RequestRotation() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_rotate_requested_ = true;
+  }
+  condition_.notify_one();
+}
+
+bool PacketRecorder::IsRotationDue(const Segment& segment) const {
+  uint64_t rotate_offset = segment.capacity - std::min(kRecordRotateReserve, segment.capacity / 4);
+  if (segment.offset.load() >= rotate_offset) {
+    return true;
+  }
+  uint64_t start_time = segment.start_time.load();
+  return config_.segment_interval_ns != 0 && start_time != 0 &&
+         segment.last_time.load(std::memory_order_relaxed) - start_time >= config_.segment_interval_ns;
+}
+
+void PacketRecorder::SegmentProcess() {
+  while (true) {
+    Segment* active = active_.load();
+    Segment* standby = (active == &segments_[0]) ? &segments_[1] : &segments_[0];
+    bool is_ready = (standby->base != nullptr) || PrepareSegment(*standby);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // without a standby segment retry later, packets are dropped once the active one is full
+      condition_.wait_for(lock, is_ready ? kRecordCheckInterval : std::chrono::seconds(1),
+                          [this] { return is_quit_ || is_rotate_requested_; });
+      if (is_quit_) {
+        return;
+      }
+      is_rotate_requested_ = false;
+    }
+    if (is_ready && IsRotationDue(*active)) {
+      active_.store(standby);
+      CloseSegment(*active);
+    }
+  }
+}
+
+bool PacketRecorder::PrepareSegment(Segment& segment) {
+  segment.path = MakeSegmentPath();
+  segment.fd = open(segment.path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (segment.fd < 0) {
+    std::cout << "open record segment failed, path: " << segment.path
+              << ", error: " << strerror(errno) << std::endl;
+    return false;
+  }
+  int ret = posix_fallocate(segment.fd, 0, config_.segment_size);
+  if (ret != 0) {
+    std::cout << "preallocate record segment failed, path: " << segment.path
+              << ", error: " << strerror(ret) << std::endl;
+    close(segment.fd);
+    unlink(segment.path.c_str());
+    segment.fd = -1;
+    return false;
+  }
+  // fault the pages in here instead of on the packet path
+  void* base = mmap(nullptr, config_.segment_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, segment.fd, 0);
+  if (base == MAP_FAILED) {
+    std::cout << "map record segment failed, path: " << segment.path
+              << ", error: " << strerror(errno) << std::endl;
+    close(segment.fd);
+    unlink(segment.path.c_str());
+    segment.fd = -1;
+    return false;
+  }
+
+  segment.base = static_cast<uint8_t*>(base);
+  segment.capacity = config_.segment_size;
+  segment.offset.store(sizeof(RecordFileHeader));
+  segment.data_end.store(0);
+  segment.record_num.store(0);
+  segment.start_time.store(0);
+  segment.last_time.store(0);
+  RecordFileHeader* header = reinterpret_cast<RecordFileHeader*>(segment.base);
+  header->magic = kRecordFileMagic;
+  header->version = kRecordFileVersion;
+  header->header_size = sizeof(RecordFileHeader);
+  return true;
+}
+
+void PacketRecorder::CloseSegment(Segment& segment) {
+  if (segment.fd < 0) {
+    return;
+  }
+  // writers that took the segment before it was replaced finish their copy
+  while (segment.writers.load() != 0) {
+    std::this_thread::yield();
+  }
+  uint64_t data_end = segment.data_end.load();
+  if (data_end == 0) {
+    data_end = segment.offset.load();
+  }
+  uint32_t record_num = segment.record_num.load();
+  if (segment.base != nullptr) {
+    RecordFileHeader* header = reinterpret_cast<RecordFileHeader*>(segment.base);
+    header->data_size = data_end - sizeof(RecordFileHeader);
+    header->record_num = record_num;
+    munmap(segment.base, segment.capacity);
+  }
+  if (record_num == 0) {
+    unlink(segment.path.c_str());
+  } else {
+    if (ftruncate(segment.fd, data_end) != 0) {
+      std::cout << "truncate record segment failed, path: " << segment.path << std::endl;
+    }
+    std::cout << "record segment closed: " << segment.path << ", packets: "
+              << record_num << std::endl;
+  }
+  close(segment.fd);
+  segment.fd = -1;
+  segment.base = nullptr;
+  segment.capacity = 0;
+  segment.path.clear();
+}
+
+std::string PacketRecorder::MakeSegmentPath() {
+  time_t now = time(nullptr);
+  struct tm local_time;
+  localtime_r(&now, &local_time);
+  char name[64];
+  strftime(name, sizeof(name), "livox_raw_%Y%m%d_%H%M%S", &local_time);
+  char index[16];
+  snprintf(index, sizeof(index), "_%04u", segment_index_++);
+  return config_.path + "/" + name + index + kRecordFileExtension;
+}
+
+} // namespace livox_ros
@@ -0,0 +1,129 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_PACKET_RECORDER_H_
+#define LIVOX_ROS_DRIVER_PACKET_RECORDER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+
+/** Raw packet log, a segment file is a RecordFileHeader followed by records */
+const uint32_t kRecordFileMagic = 0x43455252;  /**< "RREC" */
+const uint16_t kRecordFileVersion = 1;
+const char kRecordFileExtension[] = ".lrec";
+const uint32_t kRecordAlignment = 8;
+
+#pragma pack(1)
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t header_size;
+  uint64_t start_time;   /**< host time of the first record */
+  uint64_t data_size;    /**< bytes of records, 0 if the segment was not closed */
+  uint32_t record_num;
+  uint8_t rsvd[36];
+} RecordFileHeader;
+
+typedef struct {
+  uint32_t record_size;  /**< header and padded packet, 0 marks the end of the records */
+  uint32_t handle;
+  uint8_t dev_type;      /**< refer to LivoxLidarDeviceType */
+  uint8_t rsvd[3];
+  uint32_t packet_size;  /**< bytes of the LivoxLidarEthernetPacket that follows */
+  uint64_t recv_time;    /**< host time the packet was received */
+} RecordHeader;
+
+#pragma pack()
+
+/**
+ * Appends raw ethernet packets to preallocated, memory-mapped segment files.
+ * Recording a packet reserves its space with an atomic add on the active segment and copies it
+ * there, no lock is taken. A background thread creates, rotates and closes the segments, a
+ * packet finding the active segment full is counted as unrecorded in DriverStatistics.
+ */
+class PacketRecorder {
+ public:
+  PacketRecorder();
+  ~PacketRecorder();
+
+  bool Start(const RecorderConfig& config);
+  void Stop();
+  bool IsRecording() const { return is_recording_.load(std::memory_order_relaxed); }
+
+  /** Thread safe, called by every thread receiving packets */
+  void Record(uint32_t handle, uint8_t dev_type, const uint8_t* packet, uint32_t packet_size,
+              uint64_t recv_time);
+  uint64_t GetDroppedCount() const { return dropped_count_.load(); }
+
+ private:
+  struct Segment {
+    int fd = -1;
+    uint8_t* base = nullptr;
+    uint64_t capacity = 0;
+    std::string path;
+    std::atomic<uint64_t> offset{0};      /**< reserved bytes, runs past capacity once full */
+    std::atomic<uint64_t> data_end{0};    /**< end of the records once a packet did not fit, else 0 */
+    std::atomic<uint32_t> record_num{0};
+    std::atomic<uint32_t> writers{0};     /**< threads between reserving and finishing a record */
+    std::atomic<uint64_t> start_time{0};  /**< receive time of the first record */
+    std::atomic<uint64_t> last_time{0};   /**< receive time of the latest record */
+  };
+
+  Segment* AcquireActiveSegment();
+  void RequestRotation();
+  bool IsRotationDue(const Segment& segment) const;
+  void SegmentProcess();
+  bool PrepareSegment(Segment& segment);
+  void CloseSegment(Segment& segment);
+  std::string MakeSegmentPath();
+
+  RecorderConfig config_;
+  std::atomic<bool> is_recording_{false};
+  std::atomic<uint64_t> dropped_count_{0};
+  uint32_t segment_index_ = 0;
+
+  //the active segment takes the packets, the other one is prepared by the segment thread
+  Segment segments_[2];
+  std::atomic<Segment*> active_{nullptr};
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool is_rotate_requested_ = false;
+  bool is_quit_ = false;
+  std::shared_ptr<std::thread> segment_thread_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_PACKET_RECORDER_H_
@@ -0,0 +1,83 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "packet_reorder_buffer.h"
+
+#include <iterator>
+#include <utility>
+
+namespace livox_ros {
+
+void PacketReorderBuffer::Reset() {
+  packets_.clear();
+  released_time_ = 0;
+  time_type_ = 0;
+  has_released_ = false;
+}
+
+bool PacketReorderBuffer::IsClockChanged(const RawPacket& packet) const {
+  if (!has_released_ && packets_.empty()) {
+    return false;
+  }
+  if (packet.time_type != time_type_) {
+    return true;
+  }
+  // far older than the released packets, the lidar clock stepped back
+  return has_released_ && packet.time_stamp + kPacketReorderMaxStep < released_time_;
+}
+
+bool PacketReorderBuffer::Push(RawPacket&& packet, uint64_t now_time) {
+  if (has_released_ && packet.time_stamp < released_time_) {
+    return false;
+  }
+  time_type_ = packet.time_type;
+
+  // packets almost always arrive in order, search from the back
+  auto it = packets_.end();
+  while (it != packets_.begin() && std::prev(it)->packet.time_stamp > packet.time_stamp) {
+    --it;
+  }
+  packets_.insert(it, PendingPacket{std::move(packet), now_time});
+  return true;
+}
+
+bool PacketReorderBuffer::Pop(RawPacket& packet, uint64_t now_time, bool flush) {
+  if (packets_.empty()) {
+    return false;
+  }
+  const PendingPacket& front = packets_.front();
+  bool is_ready = flush || packets_.size() > kMaxPacketReorderNum ||
+                  packets_.back().packet.time_stamp - front.packet.time_stamp >= window_ns_ ||
+                  now_time - front.push_time >= window_ns_;
+  if (!is_ready) {
+    return false;
+  }
+  packet = std::move(packets_.front().packet);
+  packets_.pop_front();
+  released_time_ = packet.time_stamp;
+  has_released_ = true;
+  return true;
+}
+
+} // namespace livox_ros
@@ -0,0 +1,71 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_PACKET_REORDER_BUFFER_H_
+#define LIVOX_ROS_DRIVER_PACKET_REORDER_BUFFER_H_
+
+#include <stdint.h>
+#include <deque>
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+
+/**
+ * Holds the latest point cloud packets of one lidar sorted by packet time, so a packet
+ * overtaken on the network is decoded before the packets sent after it. A packet is released
+ * once a packet window_ns later has arrived, it waited window_ns on the host clock or the
+ * buffer holds kMaxPacketReorderNum packets. A window of 0 passes packets straight through.
+ * Not thread safe.
+ */
+class PacketReorderBuffer {
+ public:
+  PacketReorderBuffer() { Reset(); }
+
+  void SetWindow(uint64_t window_ns) { window_ns_ = window_ns; }
+  /** False if the packet is older than a released one, it is dropped */
+  bool Push(RawPacket&& packet, uint64_t now_time);
+  /** The earliest packet, if its wait is over or flush is set */
+  bool Pop(RawPacket& packet, uint64_t now_time, bool flush);
+  /** Packets of a new clock can not be ordered with the buffered ones, flush and reset first */
+  bool IsClockChanged(const RawPacket& packet) const;
+  bool IsEmpty() const { return packets_.empty(); }
+  void Reset();
+
+ private:
+  typedef struct {
+    RawPacket packet;
+    uint64_t push_time;  /**< steady clock */
+  } PendingPacket;
+
+  std::deque<PendingPacket> packets_;
+  uint64_t window_ns_ = 0;
+  uint64_t released_time_;  /**< packet time of the latest released packet */
+  uint8_t time_type_;
+  bool has_released_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_PACKET_REORDER_BUFFER_H_
@@ -24,15 +24,17 @@
 
 #include "pub_handler.h"
 #include "livox_lidar_api.h"
+#include <pthread.h>
 #include <cstdlib>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <limits>
 
 namespace livox_ros {
 
-std::atomic<bool> PubHandler::is_timestamp_sync_;
-
 PubHandler &pub_handler() {
   static PubHandler handler;
   return handler;
@@ -56,6 +58,8 @@ void PubHandler::Uninit() {
   } else {
     /* */
   }
+  recorder_.Stop();
+  black_box_.Stop();
 }
 
 void PubHandler::RequestExit() {
@@ -63,20 +67,98 @@ void PubHandler::RequestExit() {
 }
 
 void PubHandler::SetPointCloudConfig(const double publish_freq) {
-  publish_interval_ = (kNsPerSecond / (publish_freq * 10)) * 10;
-  publish_interval_tolerance_ = publish_interval_ - kNsTolerantFrameTimeDeviation;
-  publish_interval_ms_ = publish_interval_ / kRatioOfMsToNs;
-  if (!point_process_thread_) {
-    point_process_thread_ = std::make_shared<std::thread>(&PubHandler::RawDataProcess, this);
+  uint64_t publish_interval = (kNsPerSecond / (publish_freq * 10)) * 10;
+  if (point_process_thread_) {
+    {
+      std::unique_lock<std::mutex> lock(packet_mutex_);
+      pending_publish_interval_.store(publish_interval);
+    }
+    packet_condition_.notify_one();
+    return;
   }
+  publish_interval_ = publish_interval;
+  UpdateWindowSize();
+  point_process_thread_ = std::make_shared<std::thread>(&PubHandler::RawDataProcess, this);
   return;
 }
 
+void PubHandler::ApplyPublishInterval() {
+  uint64_t publish_interval = pending_publish_interval_.exchange(0);
+  if (publish_interval == 0 || publish_interval == publish_interval_) {
+    return;
+  }
+  // every lidar finishes its frame in progress and takes the new interval at its next frame boundary
+  publish_interval_ = publish_interval;
+  UpdateWindowSize();
+  std::cout << "publish interval changed, interval(ns): " << publish_interval_ << std::endl;
+}
+
+void PubHandler::SetStreamingConfig(const StreamingConfig& config) {
+  streaming_config_ = config;
+  if (IsStreamingEnabled(streaming_config_)) {
+    std::cout << "streaming mode, packets per sub-frame: " << streaming_config_.packet_num
+              << ", max sub-frame interval(ns): " << streaming_config_.interval_ns << std::endl;
+  }
+}
+
+void PubHandler::SetIntegrationTime(const double integration_time) {
+  integration_time_ns_ = static_cast<uint64_t>(integration_time * kNsPerSecond);
+  UpdateWindowSize();
+}
+
+void PubHandler::SetReorderWindow(const uint64_t window_ns) {
+  reorder_window_ns_ = std::min(window_ns, kMaxPacketReorderWindow);
+  for (auto& buffer : reorder_buffers_) {
+    buffer.second.SetWindow(reorder_window_ns_);
+  }
+}
+
+void PubHandler::SetReplayClock(bool enable) {
+  is_replay_clock_.store(enable);
+}
+
+void PubHandler::EndReplay() {
+  {
+    std::unique_lock<std::mutex> lock(packet_mutex_);
+    is_replay_ended_.store(true);
+  }
+  packet_condition_.notify_one();
+}
+
+void PubHandler::SetRecorderConfig(const RecorderConfig& config) {
+  if (!config.path.empty()) {
+    recorder_.Start(config);
+  }
+}
+
+void PubHandler::SetBlackBoxConfig(const BlackBoxConfig& config) {
+  if (!config.path.empty()) {
+    black_box_.Start(config);
+  }
+}
+
+void PubHandler::UpdateWindowSize() {
+  window_size_ = 1;
+  if (integration_time_ns_ > publish_interval_) {
+    window_size_ = static_cast<uint32_t>(std::ceil(
+        static_cast<double>(integration_time_ns_) / publish_interval_));
+  }
+  if (window_size_ > 1) {
+    std::cout << "sliding window integration, time(ns): " << integration_time_ns_
+              << ", frames per window: " << window_size_ << std::endl;
+  }
+}
+
 void PubHandler::SetImuDataCallback(ImuDataCallback cb, void* client_data) {
   imu_client_data_ = client_data;
   imu_callback_ = cb;
 }
 
+void PubHandler::SetLidarDisconnectCallback(LidarDisconnectCallback cb, void* client_data) {
+  disconnect_client_data_ = client_data;
+  disconnect_callback_ = cb;
+}
+
 void PubHandler::AddLidarsExtParam(LidarExtParameter& lidar_param) {
   std::unique_lock<std::mutex> lock(packet_mutex_);
   uint32_t id = 0;
@@ -92,40 +174,59 @@ void PubHandler::ClearAllLidarsExtrinsicParams() {
 void PubHandler::SetPointCloudsCallback(PointCloudsCallback cb, void* client_data) {
   pub_client_data_ = client_data;
   points_callback_ = cb;
+}
+
+void PubHandler::AddPointCloudObserver() {
   lidar_listen_id_ = LivoxLidarAddPointCloudObserver(OnLivoxLidarPointCloudCallback, this);
 }
 
+uint32_t PubHandler::GetRawPacketQueueSize() {
+  std::unique_lock<std::mutex> lock(packet_mutex_);
+  return raw_packet_queue_.size();
+}
+
 void PubHandler::OnLivoxLidarPointCloudCallback(uint32_t handle, const uint8_t dev_type,
                                                 LivoxLidarEthernetPacket *data, void *client_data) {
   PubHandler* self = (PubHandler*)client_data;
   if (!self) {
     return;
   }
+  self->PushEthPacket(handle, dev_type, data, GetHostTimeNs());
+}
 
-  if (data->time_type != kTimestampTypeNoSync) {
-    is_timestamp_sync_.store(true);
-  } else {
-    is_timestamp_sync_.store(false);
+void PubHandler::PushEthPacket(uint32_t handle, const uint8_t dev_type,
+                               LivoxLidarEthernetPacket *data, uint64_t recv_time) {
+  if (recorder_.IsRecording()) {
+    recorder_.Record(handle, dev_type, reinterpret_cast<const uint8_t*>(data), data->length, recv_time);
+  }
+  if (black_box_.IsEnabled()) {
+    black_box_.Record(handle, dev_type, reinterpret_cast<const uint8_t*>(data), data->length, recv_time);
   }
 
   if (data->data_type == kLivoxLidarImuData) {
-    if (self->imu_callback_) {
+    DriverStatistics::GetInstance().AddImuPacket(handle);
+    if (imu_callback_) {
       RawImuPoint* imu = (RawImuPoint*) data->data;
       ImuData imu_data;
       imu_data.lidar_type = static_cast<uint8_t>(LidarProtoType::kLivoxLidarType);
       imu_data.handle = handle;
-      imu_data.time_stamp = GetEthPacketTimestamp(data->time_type,
-                                                  data->timestamp, sizeof(data->timestamp));
+      imu_data.time_stamp = GetPacketTimestamp(handle, data->time_type,
+          data->timestamp, sizeof(data->timestamp), recv_time);
       imu_data.gyro_x = imu->gyro_x;
       imu_data.gyro_y = imu->gyro_y;
       imu_data.gyro_z = imu->gyro_z;
       imu_data.acc_x = imu->acc_x;
       imu_data.acc_y = imu->acc_y;
       imu_data.acc_z = imu->acc_z;
-      self->imu_callback_(&imu_data, self->imu_client_data_);
+      imu_callback_(&imu_data, imu_client_data_);
     }
     return;
   }
+  if (data->dot_num == 0) {
+    return;
+  }
+  DriverStatistics::GetInstance().AddPacket(handle, data->dot_num, data->time_type);
+  LIVOX_TRACEPOINT(packet_receive, handle, data->dot_num, data->udp_cnt, recv_time);
   RawPacket packet = {};
   packet.handle = handle;
   packet.lidar_type = LidarProtoType::kLivoxLidarType;
@@ -140,20 +241,41 @@ void PubHandler::OnLivoxLidarPointCloudCallback(uint32_t handle, const uint8_t d
   packet.data_type = data->data_type;
   packet.point_num = data->dot_num;
   packet.point_interval = data->time_interval * 100 / data->dot_num;  //ns
-  packet.time_stamp = GetEthPacketTimestamp(data->time_type,
-                                            data->timestamp, sizeof(data->timestamp));
+  packet.time_stamp = GetPacketTimestamp(handle, data->time_type,
+      data->timestamp, sizeof(data->timestamp), recv_time);
+  packet.time_type = data->time_type;
+  packet.udp_cnt = data->udp_cnt;
+  packet.recv_time = recv_time;
   uint32_t length = data->length - sizeof(LivoxLidarEthernetPacket) + 1;
   packet.raw_data.insert(packet.raw_data.end(), data->data, data->data + length);
   {
-    std::unique_lock<std::mutex> lock(self->packet_mutex_);
-    self->raw_packet_queue_.push_back(packet);
+    std::unique_lock<std::mutex> lock(packet_mutex_);
+    raw_packet_queue_.push_back(std::move(packet));
   }
-    self->packet_condition_.notify_one();
+  packet_condition_.notify_one();
 
   return;
 }
 
 void PubHandler::PublishPointCloud() {
+  for (uint8_t i = 0; i < frame_.lidar_num; ++i) {
+    LIVOX_TRACEPOINT(frame_close, frame_.lidar_point[i].handle, frame_.lidar_point[i].points_num,
+                     frame_.base_time[i]);
+  }
+
+  FrameTrace& frame_trace = FrameTrace::GetInstance();
+  if (frame_trace.IsEnabled()) {
+    for (uint8_t i = 0; i < frame_.lidar_num; ++i) {
+      const PointPacket& lidar_point = frame_.lidar_point[i];
+      auto state = frame_states_.find(lidar_point.handle);
+      if (state == frame_states_.end()) {
+        continue;
+      }
+      frame_trace.Begin(lidar_point.handle, frame_.base_time[i], lidar_point.points_num,
+                        state->second.recent_recv_time, state->second.recent_decode_time);
+    }
+  }
+
   //publish point
   if (points_callback_) {
     points_callback_(&frame_, pub_client_data_);
@@ -161,95 +283,429 @@ void PubHandler::PublishPointCloud() {
   return;
 }
 
-void PubHandler::CheckTimer(uint32_t id) {
+bool PubHandler::PackLidarPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags) {
+  if (IsStreamingEnabled(streaming_config_)) {
+    return PackStreamingPoints(id, process_handler, flags);
+  }
+  if (window_size_ > 1) {
+    return PackWindowPoints(id, process_handler, flags);
+  }
+  frame_.base_time[frame_.lidar_num] = process_handler.GetLidarBaseTime();
+  points_[id].clear();
+  process_handler.GetLidarPointClouds(points_[id]);
+  if (points_[id].empty()) {
+    return false;
+  }
+  flags |= TakeFrameFlags(id);
+  PointPacket& lidar_point = frame_.lidar_point[frame_.lidar_num];
+  lidar_point.lidar_type = LidarProtoType::kLivoxLidarType;  // TODO:
+  lidar_point.handle = id;
+  lidar_point.flags = flags;
+  lidar_point.points_num = points_[id].size();
+  lidar_point.points = points_[id].data();
+  lidar_point.chunks = nullptr;
+  lidar_point.chunk_num = 0;
+  frame_.lidar_num++;
+  return true;
+}
 
-  if (PubHandler::is_timestamp_sync_.load()) { // Enable time synchronization
+bool PubHandler::PackWindowPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags) {
+  std::shared_ptr<PointChunk> chunk = AcquirePointChunk();
+  process_handler.GetLidarPointClouds(*chunk);
+  if (chunk->empty()) {
+    return false;
+  }
+  flags |= TakeFrameFlags(id);
+
+  IntegrationWindow& window = windows_[id];
+  window.chunks.push_back(chunk);
+  // chunks ending before the window are left over from a stalled lidar
+  while (window.chunks.size() > window_size_ ||
+         window.chunks.front()->back().offset_time + integration_time_ns_ < chunk->front().offset_time) {
+    window.chunks.pop_front();
+  }
+  window.frame_chunks.assign(window.chunks.begin(), window.chunks.end());
+
+  uint32_t points_num = 0;
+  for (const auto& window_chunk : window.chunks) {
+    points_num += window_chunk->size();
+  }
+  frame_.base_time[frame_.lidar_num] = window.chunks.front()->front().offset_time;
+  PointPacket& lidar_point = frame_.lidar_point[frame_.lidar_num];
+  lidar_point.lidar_type = LidarProtoType::kLivoxLidarType;
+  lidar_point.handle = id;
+  lidar_point.flags = flags;
+  lidar_point.points_num = points_num;
+  lidar_point.points = nullptr;
+  lidar_point.chunks = window.frame_chunks.data();
+  lidar_point.chunk_num = window.frame_chunks.size();
+  frame_.lidar_num++;
+  return true;
+}
+
+bool PubHandler::PackStreamingPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags) {
+  uint64_t base_time = process_handler.GetLidarBaseTime();
+  std::shared_ptr<PointChunk> chunk = AcquirePointChunk();
+  process_handler.GetLidarPointClouds(*chunk);
+  if (chunk->empty()) {
+    return false;
+  }
+  flags |= TakeFrameFlags(id);
+
+  // sub-frames come at a high rate, the queue takes a reference instead of a copy of the points
+  StreamingState& state = streaming_states_[id];
+  state.chunk = chunk;
+  frame_.base_time[frame_.lidar_num] = base_time;
+  PointPacket& lidar_point = frame_.lidar_point[frame_.lidar_num];
+  lidar_point.lidar_type = LidarProtoType::kLivoxLidarType;
+  lidar_point.handle = id;
+  lidar_point.flags = flags;
+  lidar_point.points_num = chunk->size();
+  lidar_point.points = nullptr;
+  lidar_point.chunks = &state.chunk;
+  lidar_point.chunk_num = 1;
+  frame_.lidar_num++;
+  return true;
+}
+
+uint8_t PubHandler::TakeFrameFlags(uint32_t id) {
+  FrameState& state = frame_states_[id];
+  uint8_t flags = state.frame_flags;
+  state.frame_flags = 0;
+  return flags;
+}
+
+std::shared_ptr<PointChunk> PubHandler::AcquirePointChunk() {
+  for (auto& chunk : chunk_pool_) {
+    if (chunk.use_count() == 1) {
+      // the last reader has released it, synchronize with its reference count decrement
+      std::atomic_thread_fence(std::memory_order_acquire);
+      chunk->clear();
+      return chunk;
+    }
+  }
+  auto chunk = std::make_shared<PointChunk>();
+  if (chunk_pool_.size() < kMaxPointChunkPoolSize) {
+    chunk_pool_.push_back(chunk);
+  }
+  return chunk;
+}
+
+void PubHandler::CheckTimer(uint32_t id) {
+  FrameState& state = frame_states_[id];
+  if (state.is_sync) { // Enable time synchronization
     auto& process_handler = lidar_process_handlers_[id];
-    uint64_t recent_time_ms = process_handler->GetRecentTimeStamp() / kRatioOfMsToNs;
-    if ((recent_time_ms % publish_interval_ms_ != 0) || recent_time_ms == 0) {
+    uint64_t publish_interval = state.publish_interval;
+    uint64_t recent_time = process_handler->GetRecentTimeStamp();
+    uint64_t recent_time_ms = recent_time / kRatioOfMsToNs;
+    if ((recent_time_ms % (publish_interval / kRatioOfMsToNs) != 0) || recent_time_ms == 0) {
+      // arm the deadline of a new frame, the end of the frame in sync time mapped to local time
+      if (!frame_scheduler_.IsScheduled(id) && recent_time != 0) {
+        uint64_t frame_end = (recent_time / publish_interval + 1) * publish_interval;
+        uint64_t time_to_end = std::min(frame_end - recent_time, publish_interval);
+        frame_scheduler_.Schedule(id, GetDeadlineClockNs() + time_to_end + kFrameFlushTimeout);
+      }
       return;
     }
 
     uint64_t diff = process_handler->GetRecentTimeStamp() - process_handler->GetLidarBaseTime();
-    if (diff < publish_interval_tolerance_) {
+    // the first frame after a rate change ends at the first boundary of the new interval
+    uint64_t min_interval = std::min(publish_interval, state.last_publish_interval);
+    if (diff < min_interval - kNsTolerantFrameTimeDeviation) {
       return;
     }
 
-    frame_.base_time[frame_.lidar_num] = process_handler->GetLidarBaseTime();
-    points_[id].clear();
-    process_handler->GetLidarPointClouds(points_[id]);
-    if (points_[id].empty()) {
+    frame_scheduler_.Cancel(id);
+    state.last_publish_interval = publish_interval;
+    state.publish_interval = publish_interval_;  // a new rate starts with the next frame
+    if (!PackLidarPoints(id, *process_handler)) {
       return;
     }
-    PointPacket& lidar_point = frame_.lidar_point[frame_.lidar_num];
-    lidar_point.lidar_type = LidarProtoType::kLivoxLidarType;  // TODO:
-    lidar_point.handle = id;
-    lidar_point.points_num = points_[id].size();
-    lidar_point.points = points_[id].data();
-    frame_.lidar_num++;
     
     if (frame_.lidar_num != 0) {
       PublishPointCloud();
       frame_.lidar_num = 0;
     }
-  } else { // Disable time synchronization
-    auto now_time = std::chrono::high_resolution_clock::now();
+  } else { // Disable time synchronization, frames are cut by the receive time of the packets
+    uint64_t now_time = state.recent_recv_time;
     //First Set
-    static bool first = true;
-    if (first) {
-      last_pub_time_ = now_time;
-      first = false;
+    if (state.is_first) {
+      state.last_pub_time = now_time;
+      state.is_first = false;
       return;
     }
-    if (now_time - last_pub_time_ < std::chrono::nanoseconds(publish_interval_)) {
+    if (now_time - state.last_pub_time < state.publish_interval) {
+      if (!frame_scheduler_.IsScheduled(id)) {
+        uint64_t time_to_end = state.last_pub_time + state.publish_interval - now_time;
+        frame_scheduler_.Schedule(id, GetDeadlineClockNs() + time_to_end + kFrameFlushTimeout);
+      }
       return;
     }
-    last_pub_time_ += std::chrono::nanoseconds(publish_interval_);
-    for (auto &process_handler : lidar_process_handlers_) {
-      frame_.base_time[frame_.lidar_num] = process_handler.second->GetLidarBaseTime();
-      uint32_t handle = process_handler.first;
-      points_[handle].clear();
-      process_handler.second->GetLidarPointClouds(points_[handle]);
-      if (points_[handle].empty()) {
-        continue;
-      }
-      PointPacket& lidar_point = frame_.lidar_point[frame_.lidar_num];
-      lidar_point.lidar_type = LidarProtoType::kLivoxLidarType;  // TODO:
-      lidar_point.handle = handle;
-      lidar_point.points_num = points_[handle].size();
-      lidar_point.points = points_[handle].data();
-      frame_.lidar_num++;
+    AdvanceFrameStart(state, now_time);
+    frame_scheduler_.Cancel(id);
+    if (PackLidarPoints(id, *lidar_process_handlers_[id])) {
+      PublishPointCloud();
     }
-    PublishPointCloud();
     frame_.lidar_num = 0;
   }
   return;
 }
 
+void PubHandler::AdvanceFrameStart(FrameState& state, uint64_t now_time) {
+  state.last_pub_time += state.publish_interval;
+  if (now_time - state.last_pub_time >= state.publish_interval) {
+    state.last_pub_time = now_time;  // the lidar was silent for more than a frame
+  }
+  state.publish_interval = publish_interval_;  // a new rate starts with the next frame
+}
+
+void PubHandler::CheckStreaming(uint32_t id) {
+  uint64_t now_time = GetDeadlineClockNs();
+  StreamingState& state = streaming_states_[id];
+  if (state.packet_count++ == 0) {
+    state.first_packet_time = now_time;
+    if (streaming_config_.interval_ns != 0) {
+      frame_scheduler_.Schedule(id, now_time + streaming_config_.interval_ns);
+    }
+  }
+
+  bool packet_reached = (streaming_config_.packet_num != 0) &&
+                        (state.packet_count >= streaming_config_.packet_num);
+  bool interval_reached = (streaming_config_.interval_ns != 0) &&
+      (now_time - state.first_packet_time >= streaming_config_.interval_ns);
+  if (!packet_reached && !interval_reached) {
+    return;
+  }
+  state.packet_count = 0;
+  frame_scheduler_.Cancel(id);
+
+  if (PackLidarPoints(id, *lidar_process_handlers_[id])) {
+    PublishPointCloud();
+  }
+  frame_.lidar_num = 0;
+}
+
+void PubHandler::CheckFrameDeadlines() {
+  if (frame_scheduler_.GetNextDeadline() > GetDeadlineClockNs()) {
+    return;
+  }
+  expired_ids_.clear();
+  frame_scheduler_.Advance(GetDeadlineClockNs(), expired_ids_);
+  for (uint32_t id : expired_ids_) {
+    FlushExpiredFrame(id);
+  }
+}
+
+void PubHandler::FlushAllFrames() {
+  for (auto& buffer : reorder_buffers_) {
+    ReleasePackets(buffer.first, true);
+  }
+  expired_ids_.clear();
+  frame_scheduler_.Advance(std::numeric_limits<uint64_t>::max(), expired_ids_);
+  for (uint32_t id : expired_ids_) {
+    FlushExpiredFrame(id);
+  }
+}
+
+void PubHandler::AdvanceReplayClock(uint64_t recv_time) {
+  if (recv_time + kDeviceDisconnectThreshold < replay_time_) {
+    // the next record file starts earlier, close the frames of the previous one
+    FlushAllFrames();
+    for (auto& state : frame_states_) {
+      state.second.is_first = true;
+      state.second.last_packet_time = recv_time;  // silence is measured on the clock of the next file
+    }
+    replay_time_ = 0;
+    next_silence_check_ = 0;
+  }
+  replay_time_ = std::max(replay_time_, recv_time);
+}
+
+uint64_t PubHandler::GetDeadlineClockNs() const {
+  // replayed packets are paced by their receive times, deadlines follow them at any replay rate
+  return is_replay_clock_.load() ? replay_time_ : GetSteadyTimeNs();
+}
+
+void PubHandler::FlushExpiredFrame(uint32_t id) {
+  ReleasePackets(id, true);
+  if (frame_scheduler_.IsScheduled(id)) {
+    return;  // the held packets moved the frame on and armed a new deadline
+  }
+  if (IsStreamingEnabled(streaming_config_)) {
+    // the sub-frame reached its time limit, which is a regular close in streaming mode
+    streaming_states_[id].packet_count = 0;
+    if (PackLidarPoints(id, *lidar_process_handlers_[id])) {
+      PublishPointCloud();
+    }
+  } else {
+    // the lidar went silent before a packet closed its frame
+    FrameState& state = frame_states_[id];
+    if (!state.is_sync) {
+      // the frame start moves on the lidar's receive times, the time elapsed since its last packet
+      uint64_t now_time = state.recent_recv_time + (GetDeadlineClockNs() - state.recent_deadline_time);
+      AdvanceFrameStart(state, now_time);
+    }
+    auto process_handler = lidar_process_handlers_.find(id);
+    if (process_handler != lidar_process_handlers_.end() &&
+        PackLidarPoints(id, *process_handler->second, kFrameFlagPartial)) {
+      PublishPointCloud();
+    }
+  }
+  frame_.lidar_num = 0;
+}
+
 void PubHandler::RawDataProcess() {
+  pthread_setname_np(pthread_self(), "livox_pub");
   RawPacket raw_data;
   while (!is_quit_.load()) {
+    bool has_packet = false;
+    bool is_drained = false;
     {
       std::unique_lock<std::mutex> lock(packet_mutex_);
       if (raw_packet_queue_.empty()) {
-        packet_condition_.wait_for(lock, std::chrono::milliseconds(500));
-        if (raw_packet_queue_.empty()) {
-          continue;
+        // sleep until a packet arrives or the earliest frame deadline
+        uint64_t wait_ns = 500 * kRatioOfMsToNs;
+        uint64_t now_ns = GetSteadyTimeNs();
+        // replayed deadlines only come due with the next packet
+        uint64_t next_deadline = is_replay_clock_.load() ? std::numeric_limits<uint64_t>::max()
+                                                         : frame_scheduler_.GetNextDeadline();
+        for (const auto& buffer : reorder_buffers_) {
+          if (!buffer.second.IsEmpty()) {
+            next_deadline = std::min(next_deadline, now_ns + reorder_window_ns_);
+            break;
+          }
+        }
+        if (next_deadline <= now_ns) {
+          wait_ns = 0;
+        } else {
+          wait_ns = std::min(wait_ns, next_deadline - now_ns);
+        }
+        if (wait_ns > 0 && pending_publish_interval_.load() == 0 && !is_replay_ended_.load()) {
+          packet_condition_.wait_for(lock, std::chrono::nanoseconds(wait_ns));
         }
       }
-      raw_data = raw_packet_queue_.front();
-      raw_packet_queue_.pop_front();
+      if (!raw_packet_queue_.empty()) {
+        raw_data = std::move(raw_packet_queue_.front());
+        raw_packet_queue_.pop_front();
+        has_packet = true;
+      }
+      is_drained = raw_packet_queue_.empty();
+    }
+
+    // between two packets, so no frame is cut by a mix of intervals
+    ApplyPublishInterval();
+    if (has_packet) {
+      if (is_replay_clock_.load()) {
+        AdvanceReplayClock(raw_data.recv_time);
+      }
+      uint32_t id = 0;
+      GetLidarId(raw_data.lidar_type, raw_data.handle, id);
+      CheckContinuity(id, raw_data);
+      ReorderPacket(id, std::move(raw_data));
+    }
+
+    // one packet per loop, overdue deadlines and silent lidars are served even while packets queue up
+    if (is_drained) {
+      for (auto& buffer : reorder_buffers_) {
+        ReleasePackets(buffer.first, false);
+      }
     }
-    uint32_t id = 0;
-    GetLidarId(raw_data.lidar_type, raw_data.handle, id);
-    if (lidar_process_handlers_.find(id) == lidar_process_handlers_.end()) {
-      lidar_process_handlers_[id].reset(new LidarPubHandler());
+    CheckFrameDeadlines();
+    CheckSilentLidars();
+    if (is_drained && is_replay_ended_.exchange(false)) {
+      FlushAllFrames();
     }
-    auto &process_handler = lidar_process_handlers_[id];
-    if (lidar_extrinsics_.find(id) != lidar_extrinsics_.end()) {
-        lidar_process_handlers_[id]->SetLidarsExtParam(lidar_extrinsics_[id]);
+  }
+}
+
+void PubHandler::CheckSilentLidars() {
+  // a paused or slow replay does not make its lidars silent
+  uint64_t now_time = GetDeadlineClockNs();
+  if (now_time < next_silence_check_) {
+    return;
+  }
+  next_silence_check_ = now_time + kSilenceCheckInterval;
+
+  silent_ids_.clear();
+  for (const auto& state : frame_states_) {
+    if (state.second.last_packet_time != 0 && now_time > state.second.last_packet_time &&
+        now_time - state.second.last_packet_time > static_cast<uint64_t>(kDeviceDisconnectThreshold)) {
+      silent_ids_.push_back(state.first);
     }
-    process_handler->PointCloudProcess(raw_data);
+  }
+  for (uint32_t id : silent_ids_) {
+    std::cout << "lidar disconnected, no point cloud packets for "
+              << kDeviceDisconnectThreshold / kRatioOfMsToNs << " ms, ip: " << IpNumToString(id) << std::endl;
+    ReleaseLidar(id);
+    if (disconnect_callback_) {
+      disconnect_callback_(id, disconnect_client_data_);
+    }
+  }
+}
+
+void PubHandler::ReleaseLidar(uint32_t id) {
+  // frame deadlines have already flushed the points of the silent lidar
+  frame_scheduler_.Cancel(id);
+  frame_states_.erase(id);
+  streaming_states_.erase(id);
+  reorder_buffers_.erase(id);
+  windows_.erase(id);  // the chunks return to the pool once the queued frames are published
+  points_.erase(id);
+  lidar_process_handlers_.erase(id);
+  {
+    std::lock_guard<std::mutex> lock(clock_mutex_);
+    clock_estimators_.erase(id);
+  }
+}
+
+void PubHandler::ReorderPacket(uint32_t id, RawPacket&& raw_data) {
+  auto it = reorder_buffers_.find(id);
+  if (it == reorder_buffers_.end()) {
+    it = reorder_buffers_.emplace(id, PacketReorderBuffer()).first;
+    it->second.SetWindow(reorder_window_ns_);
+  }
+  PacketReorderBuffer& buffer = it->second;
+  if (buffer.IsClockChanged(raw_data)) {
+    ReleasePackets(id, true);
+    buffer.Reset();
+  }
+  uint32_t handle = raw_data.handle;
+  if (!buffer.Push(std::move(raw_data), GetSteadyTimeNs())) {
+    // later than the window, its hole can no longer be filled in time order
+    DriverStatistics::GetInstance().AddLostPackets(handle, 1);
+    frame_states_[id].frame_flags |= kFrameFlagPacketLoss;
+    return;
+  }
+  ReleasePackets(id, false);
+}
+
+void PubHandler::ReleasePackets(uint32_t id, bool flush) {
+  auto it = reorder_buffers_.find(id);
+  if (it == reorder_buffers_.end()) {
+    return;
+  }
+  uint64_t now_time = GetSteadyTimeNs();
+  RawPacket raw_data;
+  while (it->second.Pop(raw_data, now_time, flush)) {
+    ProcessPacket(id, raw_data);
+  }
+}
+
+void PubHandler::ProcessPacket(uint32_t id, RawPacket& raw_data) {
+  if (lidar_process_handlers_.find(id) == lidar_process_handlers_.end()) {
+    lidar_process_handlers_[id].reset(new LidarPubHandler());
+  }
+  auto &process_handler = lidar_process_handlers_[id];
+  if (lidar_extrinsics_.find(id) != lidar_extrinsics_.end()) {
+      lidar_process_handlers_[id]->SetLidarsExtParam(lidar_extrinsics_[id]);
+  }
+  LIVOX_TRACEPOINT(decode_start, raw_data.handle, raw_data.point_num, raw_data.recv_time);
+  process_handler->PointCloudProcess(raw_data);
+  LIVOX_TRACEPOINT(decode_end, raw_data.handle, raw_data.point_num);
+  UpdateFrameState(id, raw_data);
+  if (IsStreamingEnabled(streaming_config_)) {
+    CheckStreaming(id);
+  } else {
     CheckTimer(id);
   }
 }
@@ -262,6 +718,57 @@ bool PubHandler::GetLidarId(LidarProtoType lidar_type, uint32_t handle, uint32_t
   return false;
 }
 
+void PubHandler::UpdateFrameState(uint32_t id, const RawPacket& raw_data) {
+  FrameState& state = frame_states_[id];
+  if (state.publish_interval == 0) {
+    state.publish_interval = publish_interval_;
+    state.last_publish_interval = publish_interval_;
+  }
+  bool is_sync = (raw_data.time_type != kTimestampTypeNoSync);
+  if (state.is_sync != is_sync) {
+    // the lidar gained or lost time sync, restart framing on the other clock
+    state.is_sync = is_sync;
+    state.is_first = true;
+    state.publish_interval = publish_interval_;
+    state.last_publish_interval = publish_interval_;
+    if (!IsStreamingEnabled(streaming_config_)) {
+      frame_scheduler_.Cancel(id);
+    }
+  }
+  state.recent_recv_time = raw_data.recv_time;
+  state.recent_deadline_time = GetDeadlineClockNs();
+  if (FrameTrace::GetInstance().IsEnabled()) {
+    state.recent_decode_time = GetHostTimeNs();
+  }
+}
+
+void PubHandler::CheckContinuity(uint32_t id, const RawPacket& raw_data) {
+  FrameState& state = frame_states_[id];
+  state.last_packet_time = GetDeadlineClockNs();
+  PacketContinuityResult continuity = state.continuity.Update(raw_data.udp_cnt, raw_data.time_stamp,
+                                                              raw_data.time_type);
+  if (continuity.lost > 0) {
+    DriverStatistics::GetInstance().AddLostPackets(raw_data.handle, continuity.lost);
+    state.frame_flags |= kFrameFlagPacketLoss;
+  }
+  if (continuity.is_reordered) {
+    DriverStatistics::GetInstance().AddReorderedPacket(raw_data.handle);
+  }
+  if (continuity.is_gap) {
+    DriverStatistics::GetInstance().AddPacketGap(raw_data.handle);
+    state.frame_flags |= kFrameFlagPacketLoss;
+  }
+}
+
+uint64_t PubHandler::GetHostTimeNs() {
+  return std::chrono::high_resolution_clock::now().time_since_epoch().count();
+}
+
+uint64_t PubHandler::GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 uint64_t PubHandler::GetEthPacketTimestamp(uint8_t timestamp_type, uint8_t* time_stamp, uint8_t size) {
   LdsStamp time;
   memcpy(time.stamp_bytes, time_stamp, size);
@@ -274,6 +781,23 @@ uint64_t PubHandler::GetEthPacketTimestamp(uint8_t timestamp_type, uint8_t* time
   return std::chrono::high_resolution_clock::now().time_since_epoch().count();
 }
 
+uint64_t PubHandler::GetPacketTimestamp(uint32_t handle, uint8_t timestamp_type, uint8_t* time_stamp,
+                                        uint8_t size, uint64_t recv_time) {
+  if (timestamp_type == kTimestampTypeGptpOrPtp ||
+      timestamp_type == kTimestampTypeGps) {
+    return GetEthPacketTimestamp(timestamp_type, time_stamp, size);
+  }
+
+  // the device clock keeps the cadence of the sensor, receive times carry the host jitter
+  LdsStamp time;
+  memcpy(time.stamp_bytes, time_stamp, size);
+  std::lock_guard<std::mutex> lock(clock_mutex_);
+  ClockEstimator& clock_estimator = clock_estimators_[handle];
+  uint64_t host_time = clock_estimator.ToHostTime(time.stamp, recv_time);
+  DriverStatistics::GetInstance().SetClockDrift(handle, clock_estimator.GetSkewPpm());
+  return host_time;
+}
+
 /*******************************/
 /*  LidarPubHandler Definitions*/
 LidarPubHandler::LidarPubHandler() : is_set_extrinsic_params_(false) {}
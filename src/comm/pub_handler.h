@@ -37,6 +37,15 @@
 
 #include "livox_lidar_api.h"
 #include "comm/comm.h"
+#include "comm/deadline_queue.h"
+#include "comm/clock_estimator.h"
+#include "comm/black_box.h"
+#include "comm/driver_statistics.h"
+#include "comm/frame_trace.h"
+#include "comm/packet_continuity.h"
+#include "comm/packet_reorder_buffer.h"
+#include "comm/packet_recorder.h"
+#include "comm/tracepoint.h"
 
 namespace livox_ros {
 
@@ -75,6 +84,7 @@ class PubHandler {
  public:
   using PointCloudsCallback = std::function<void(PointFrame*, void *)>;
   using ImuDataCallback = std::function<void(ImuData*, void*)>;
+  using LidarDisconnectCallback = std::function<void(uint32_t, void*)>;
   using TimePoint = std::chrono::high_resolution_clock::time_point;
 
   PubHandler() {}
@@ -84,11 +94,32 @@ class PubHandler {
   void Uninit();
   void RequestExit();
   void Init();
+  /** Once running, every lidar takes the new rate over at its next frame boundary */
   void SetPointCloudConfig(const double publish_freq);
+  void SetStreamingConfig(const StreamingConfig& config);
+  void SetIntegrationTime(const double integration_time);
+  void SetReorderWindow(const uint64_t window_ns);
+  /** File data sources: frame deadlines run on the replayed receive times instead of the host clock */
+  void SetReplayClock(bool enable);
+  /** The replay pushed its last packet, flush the frames left open once the queue is drained */
+  void EndReplay();
+  void SetRecorderConfig(const RecorderConfig& config);
+  void SetBlackBoxConfig(const BlackBoxConfig& config);
   void SetPointCloudsCallback(PointCloudsCallback cb, void* client_data);
+  void AddPointCloudObserver();
   void AddLidarsExtParam(LidarExtParameter& extrinsic_params);
   void ClearAllLidarsExtrinsicParams();
   void SetImuDataCallback(ImuDataCallback cb, void* client_data);
+  /** Called from the decode thread once a lidar was silent for kDeviceDisconnectThreshold */
+  void SetLidarDisconnectCallback(LidarDisconnectCallback cb, void* client_data);
+
+  /** Write the black box ring to a record file in the background, false if it is disabled or busy */
+  bool DumpBlackBox(std::string& file_name) { return black_box_.Dump(file_name); }
+
+  /** Feed an ethernet packet as if received from the sdk, used by file data sources */
+  void PushEthPacket(uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket *data,
+                     uint64_t recv_time);
+  uint32_t GetRawPacketQueueSize();
 
  private:
   //thread to process raw data
@@ -100,12 +131,36 @@ class PubHandler {
 
   //publish callback
   void CheckTimer(uint32_t id);
+  void CheckContinuity(uint32_t id, const RawPacket& raw_data);
+  void ReorderPacket(uint32_t id, RawPacket&& raw_data);
+  void ReleasePackets(uint32_t id, bool flush);
+  void ProcessPacket(uint32_t id, RawPacket& raw_data);
+  void UpdateFrameState(uint32_t id, const RawPacket& raw_data);
+  void CheckStreaming(uint32_t id);
+  void CheckFrameDeadlines();
+  void CheckSilentLidars();
+  void ReleaseLidar(uint32_t id);
+  void FlushExpiredFrame(uint32_t id);
+  void FlushAllFrames();
+  void AdvanceReplayClock(uint64_t recv_time);
+  uint64_t GetDeadlineClockNs() const;
+  bool PackLidarPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags = 0);
+  bool PackWindowPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags);
+  bool PackStreamingPoints(uint32_t id, LidarPubHandler& process_handler, uint8_t flags);
+  uint8_t TakeFrameFlags(uint32_t id);
+  std::shared_ptr<PointChunk> AcquirePointChunk();
+  void UpdateWindowSize();
+  void ApplyPublishInterval();
   void PublishPointCloud();
+  static uint64_t GetSteadyTimeNs();
+  static uint64_t GetHostTimeNs();
   static void OnLivoxLidarPointCloudCallback(uint32_t handle, const uint8_t dev_type,
                                              LivoxLidarEthernetPacket *data, void *client_data);
   
   static bool GetLidarId(LidarProtoType lidar_type, uint32_t handle, uint32_t& id);
   static uint64_t GetEthPacketTimestamp(uint8_t timestamp_type, uint8_t* time_stamp, uint8_t size);
+  uint64_t GetPacketTimestamp(uint32_t handle, uint8_t timestamp_type, uint8_t* time_stamp,
+                              uint8_t size, uint64_t recv_time);
 
   PointCloudsCallback points_callback_;
   void* pub_client_data_ = nullptr;
@@ -113,20 +168,78 @@ class PubHandler {
   ImuDataCallback imu_callback_;
   void* imu_client_data_ = nullptr;
 
+  LidarDisconnectCallback disconnect_callback_;
+  void* disconnect_client_data_ = nullptr;
+
   PointFrame frame_;
 
   std::deque<RawPacket> raw_packet_queue_;
 
   //pub config
   uint64_t publish_interval_ = 100000000; //100 ms
-  uint64_t publish_interval_tolerance_ = 100000000; //100 ms
-  uint64_t publish_interval_ms_ = 100; //100 ms
-  TimePoint last_pub_time_;
+  std::atomic<uint64_t> pending_publish_interval_{0};  /**< 0 when there is no rate change */
+
+  //framing state of every lidar, lidars with and without time sync can be mixed
+  struct FrameState {
+    bool is_sync = false;
+    bool is_first = true;
+    uint64_t last_pub_time = 0;     /**< frame start on the host clock, when not synchronised */
+    uint64_t publish_interval = 0;  /**< of the frame in progress, publish_interval_ from its next frame */
+    uint64_t last_publish_interval = 0;  /**< of the previous frame, when synchronised */
+    uint64_t recent_recv_time = 0;  /**< framing clock when not synchronised */
+    uint64_t recent_deadline_time = 0; /**< deadline clock when recent_recv_time was decoded */
+    uint64_t recent_decode_time = 0; /**< host clock, only kept while frames are traced */
+    PacketContinuity continuity;
+    uint64_t last_packet_time = 0;   /**< deadline clock, a lidar silent for too long is released */
+    uint8_t frame_flags = 0;         /**< kFrameFlag bits collected for the next frame */
+  };
+  std::map<uint32_t, FrameState> frame_states_;
+  void AdvanceFrameStart(FrameState& state, uint64_t now_time);
+
+  //streaming config, sub-frames are handed off instead of frames when enabled
+  struct StreamingState {
+    uint32_t packet_count = 0;
+    uint64_t first_packet_time = 0;  /**< deadline clock */
+    PointChunkPtr chunk;             /**< the sub-frame handed off last, the queue shares it */
+  };
+  StreamingConfig streaming_config_ = {0, 0};
+  std::map<uint32_t, StreamingState> streaming_states_;
+
+  //sliding window, every frame integrates the chunks of the last window_size_ publish intervals
+  struct IntegrationWindow {
+    std::deque<PointChunkPtr> chunks;
+    std::vector<PointChunkPtr> frame_chunks;  /**< contiguous references handed off with the frame */
+  };
+  uint64_t integration_time_ns_ = 0;
+  uint32_t window_size_ = 1;
+  std::map<uint32_t, IntegrationWindow> windows_;
+  std::vector<std::shared_ptr<PointChunk>> chunk_pool_;  /**< free once only the pool holds a chunk */
+
+  //frame deadlines, frames are closed even if the lidar stops sending packets
+  DeadlineQueue frame_scheduler_;
+  std::vector<uint32_t> expired_ids_;
+  std::atomic<bool> is_replay_clock_{false};
+  std::atomic<bool> is_replay_ended_{false};
+  uint64_t replay_time_ = 0;  /**< latest receive time taken from the queue when replaying */
+  uint64_t next_silence_check_ = 0;
+  std::vector<uint32_t> silent_ids_;
+
+  //packets are decoded in packet time order, late packets wait in the reorder window
+  uint64_t reorder_window_ns_ = 0;
+  std::map<uint32_t, PacketReorderBuffer> reorder_buffers_;
 
   std::map<uint32_t, std::unique_ptr<LidarPubHandler>> lidar_process_handlers_;
   std::map<uint32_t, std::vector<PointXyzlt>> points_;
   std::map<uint32_t, LidarExtParameter> lidar_extrinsics_;
-  static std::atomic<bool> is_timestamp_sync_;
+
+  //device clocks of unsynchronised lidars mapped to the host clock, used by the sdk threads
+  std::mutex clock_mutex_;
+  std::map<uint32_t, ClockEstimator> clock_estimators_;
+
+  //raw packets are appended to the recorder as received
+  PacketRecorder recorder_;
+  //and kept in the black box ring until it is dumped or evicted
+  BlackBox black_box_;
   uint16_t lidar_listen_id_ = 0;
 };
 
@@ -0,0 +1,128 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "retry_scheduler.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <chrono>
+
+namespace livox_ros {
+
+RetryScheduler::RetryScheduler() : jitter_(static_cast<uint32_t>(GetSteadyTimeNs())) {}
+
+void RetryScheduler::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_) {
+    return;
+  }
+  is_quit_ = false;
+  thread_ = std::make_shared<std::thread>(&RetryScheduler::Process, this);
+}
+
+void RetryScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_quit_ = true;
+  }
+  condition_.notify_all();
+  if (thread_ && thread_->joinable()) {
+    thread_->join();
+  }
+  thread_ = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!retries_.empty()) {
+    retries_.pop();
+  }
+  attempts_.clear();
+}
+
+bool RetryScheduler::Schedule(uint64_t key, uint64_t now_time, Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t& attempt = attempts_[key];
+    if (is_quit_ || attempt >= kRetryMaxAttempts) {
+      return false;
+    }
+    retries_.push(PendingRetry{now_time + NextBackoff(attempt), order_++, std::move(task)});
+    ++attempt;
+  }
+  condition_.notify_one();
+  return true;
+}
+
+bool RetryScheduler::PopDue(uint64_t now_time, Task& task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_quit_ || retries_.empty() || retries_.top().due_time > now_time) {
+    return false;
+  }
+  task = std::move(const_cast<PendingRetry&>(retries_.top()).task);
+  retries_.pop();
+  return true;
+}
+
+void RetryScheduler::Reset(uint64_t key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  attempts_.erase(key);
+}
+
+uint64_t RetryScheduler::NextBackoff(uint32_t attempt) {
+  uint64_t delay = kRetryMaxDelay;
+  if (attempt < 32) {
+    delay = std::min(kRetryInitialDelay << attempt, kRetryMaxDelay);
+  }
+  uint64_t jitter_range = delay * kRetryJitterPercent / 100;
+  return delay - jitter_range + jitter_() % (2 * jitter_range + 1);
+}
+
+void RetryScheduler::Process() {
+  pthread_setname_np(pthread_self(), "livox_config");
+  Task task;
+  while (true) {
+    // the command may fail right away and schedule its next retry
+    while (PopDue(GetSteadyTimeNs(), task)) {
+      task();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (is_quit_) {
+      return;
+    }
+    if (retries_.empty()) {
+      condition_.wait(lock);
+      continue;
+    }
+    uint64_t now_time = GetSteadyTimeNs();
+    if (retries_.top().due_time > now_time) {
+      condition_.wait_for(lock, std::chrono::nanoseconds(retries_.top().due_time - now_time));
+    }
+  }
+}
+
+uint64_t RetryScheduler::GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace livox_ros
@@ -0,0 +1,102 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_RETRY_SCHEDULER_H_
+#define LIVOX_ROS_DRIVER_RETRY_SCHEDULER_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace livox_ros {
+
+const uint64_t kRetryInitialDelay = 100000000;  /**< 100ms */
+const uint64_t kRetryMaxDelay = 5000000000;     /**< 5s */
+const uint32_t kRetryMaxAttempts = 10;          /**< about 25s of retries */
+const uint32_t kRetryJitterPercent = 25;        /**< spreads the retries of many lidars failing at once */
+
+/**
+ * Runs retries of asynchronous commands on its own thread, so the threads reporting the
+ * failures never block. Every key backs off exponentially on its own, from
+ * kRetryInitialDelay up to kRetryMaxDelay with random jitter, for at most kRetryMaxAttempts.
+ * Thread safe.
+ */
+class RetryScheduler {
+ public:
+  using Task = std::function<void()>;
+
+  RetryScheduler();
+  ~RetryScheduler() { Stop(); }
+
+  void Start();
+  /** Pending retries are dropped */
+  void Stop();
+
+  /** Run task after the backoff of the next attempt of key, false if key ran out of attempts */
+  bool Retry(uint64_t key, Task task) { return Schedule(key, GetSteadyTimeNs(), std::move(task)); }
+  /** The command of key succeeded, a later failure starts from the first backoff again */
+  void Reset(uint64_t key);
+
+  /** Queue task due at now_time plus the backoff of the next attempt of key, the clock is steady */
+  bool Schedule(uint64_t key, uint64_t now_time, Task task);
+  /** Take the earliest retry due at now_time, false if none is due or the scheduler stopped */
+  bool PopDue(uint64_t now_time, Task& task);
+
+ private:
+  typedef struct {
+    uint64_t due_time;  /**< steady clock */
+    uint64_t order;     /**< keeps retries due at the same time in order */
+    Task task;
+  } PendingRetry;
+
+  struct LaterDue {
+    bool operator()(const PendingRetry& a, const PendingRetry& b) const {
+      return a.due_time != b.due_time ? a.due_time > b.due_time : a.order > b.order;
+    }
+  };
+
+  void Process();
+  uint64_t NextBackoff(uint32_t attempt);  /**< with mutex_ held */
+  static uint64_t GetSteadyTimeNs();
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::priority_queue<PendingRetry, std::vector<PendingRetry>, LaterDue> retries_;
+  std::map<uint64_t, uint32_t> attempts_;  /**< key:command, val:retries since its last success */
+  uint64_t order_ = 0;
+  std::minstd_rand jitter_;
+  bool is_quit_ = false;
+  std::shared_ptr<std::thread> thread_;
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_RETRY_SCHEDULER_H_
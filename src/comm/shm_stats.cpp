@@ -0,0 +1,143 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "shm_stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace livox_ros {
+
+/** Attempts of a reader before it gives up on a busy writer */
+const uint32_t kShmStatsReadRetries = 1000;
+
+std::string GetShmStatsPath(const std::string& name) {
+  return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+bool ShmStatsWriter::Open(const std::string& name) {
+  Close();
+  std::string path = GetShmStatsPath(name);
+  int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    printf("Create shared memory %s failed: %s\n", path.c_str(), strerror(errno));
+    return false;
+  }
+  if (ftruncate(fd, sizeof(ShmStatsBlock)) != 0) {
+    printf("Resize shared memory %s failed: %s\n", path.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    printf("Map shared memory %s failed: %s\n", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  block_ = static_cast<ShmStatsBlock*>(addr);
+  block_->sequence.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memset(&block_->data, 0, sizeof(block_->data));
+  block_->magic = kShmStatsMagic;
+  block_->version = kShmStatsVersion;
+  block_->sequence.store(2, std::memory_order_release);
+  name_ = path;
+  return true;
+}
+
+void ShmStatsWriter::Close() {
+  if (block_ != nullptr) {
+    munmap(block_, sizeof(ShmStatsBlock));
+    shm_unlink(name_.c_str());
+    block_ = nullptr;
+  }
+}
+
+void ShmStatsWriter::Write(const ShmStatsData& data) {
+  if (block_ == nullptr) {
+    return;
+  }
+  uint32_t sequence = block_->sequence.load(std::memory_order_relaxed);
+  block_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(&block_->data, &data, sizeof(data));
+  block_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool ShmStatsReader::Open(const std::string& name) {
+  Close();
+  int fd = shm_open(GetShmStatsPath(name).c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ShmStatsBlock))) {
+    close(fd);
+    return false;
+  }
+  void* addr = mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return false;
+  }
+  block_ = static_cast<const ShmStatsBlock*>(addr);
+  if (block_->magic != kShmStatsMagic || block_->version != kShmStatsVersion) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void ShmStatsReader::Close() {
+  if (block_ != nullptr) {
+    munmap(const_cast<ShmStatsBlock*>(block_), sizeof(ShmStatsBlock));
+    block_ = nullptr;
+  }
+}
+
+bool ShmStatsReader::Read(ShmStatsData& data) const {
+  if (block_ == nullptr) {
+    return false;
+  }
+  for (uint32_t i = 0; i < kShmStatsReadRetries; ++i) {
+    uint32_t begin = block_->sequence.load(std::memory_order_acquire);
+    if (begin & 1) {
+      continue;
+    }
+    memcpy(&data, &block_->data, sizeof(data));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (block_->sequence.load(std::memory_order_relaxed) == begin) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,136 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Fixed-layout statistics block in POSIX shared memory, written by the driver, read by livox_top */
+
+#ifndef LIVOX_ROS_DRIVER_SHM_STATS_H_
+#define LIVOX_ROS_DRIVER_SHM_STATS_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+namespace livox_ros {
+
+const uint32_t kShmStatsMagic = 0x5453564C;  /**< "LVST" */
+const uint32_t kShmStatsVersion = 2;
+const uint32_t kShmStatsMaxLidars = 32;
+const uint32_t kShmStatsMaxThreads = 32;
+
+typedef struct {
+  uint32_t handle;            /**< ip of the lidar */
+  uint8_t connect_state;      /**< refer to LidarConnectState */
+  uint8_t time_type;          /**< refer to TimestampType */
+  uint8_t reserved[2];
+  uint32_t queue_depth;       /**< frames waiting in the lidar queue */
+  uint32_t queue_size;
+  uint32_t imu_queue_depth;
+  uint32_t reserved2;
+  uint64_t packets;
+  uint64_t points;
+  uint64_t imu_packets;
+  uint64_t frames;
+  uint64_t dropped_frames;
+  uint64_t lost_packets;
+  uint64_t reordered_packets;
+  uint64_t packet_gaps;
+  double packet_rate;         /**< per second, since the previous update */
+  double point_rate;
+  double imu_rate;
+  double frame_rate;
+  double clock_drift_ppm;
+} ShmLidarStats;
+
+typedef struct {
+  int32_t tid;
+  char name[16];
+  uint32_t reserved;
+  uint64_t cpu_time_ns;       /**< user + system since the thread started */
+  double cpu_usage;           /**< fraction of one core, since the previous update */
+} ShmThreadStats;
+
+typedef struct {
+  int32_t pid;
+  uint32_t raw_queue_depth;   /**< packets waiting to be decoded */
+  uint64_t update_time_ns;    /**< CLOCK_REALTIME */
+  double publish_freq;
+  uint32_t lidar_num;
+  uint32_t thread_num;
+  ShmLidarStats lidars[kShmStatsMaxLidars];
+  ShmThreadStats threads[kShmStatsMaxThreads];
+} ShmStatsData;
+
+/** The sequence is odd while the writer updates data, readers retry until it is even and unchanged */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint32_t> sequence;
+  uint32_t reserved;
+  ShmStatsData data;
+} ShmStatsBlock;
+
+/** Single writer, creates or truncates the shared memory object */
+class ShmStatsWriter {
+ public:
+  ShmStatsWriter() {}
+  ~ShmStatsWriter() { Close(); }
+  ShmStatsWriter(const ShmStatsWriter &) = delete;
+  ShmStatsWriter &operator=(const ShmStatsWriter &) = delete;
+
+  bool Open(const std::string& name);
+  void Close();
+  bool IsOpen() const { return block_ != nullptr; }
+
+  /** Copies data into the block, readers retry while the copy is in progress */
+  void Write(const ShmStatsData& data);
+
+ private:
+  ShmStatsBlock* block_ = nullptr;
+  std::string name_;
+};
+
+class ShmStatsReader {
+ public:
+  ShmStatsReader() {}
+  ~ShmStatsReader() { Close(); }
+  ShmStatsReader(const ShmStatsReader &) = delete;
+  ShmStatsReader &operator=(const ShmStatsReader &) = delete;
+
+  bool Open(const std::string& name);
+  void Close();
+
+  /** A consistent copy of the block, false if the writer kept it busy */
+  bool Read(ShmStatsData& data) const;
+
+ private:
+  const ShmStatsBlock* block_ = nullptr;
+};
+
+/** Names without the leading slash shm_open requires get one */
+std::string GetShmStatsPath(const std::string& name);
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER_SHM_STATS_H_
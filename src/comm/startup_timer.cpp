@@ -0,0 +1,83 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "startup_timer.h"
+
+#include <stdio.h>
+
+#include <chrono>
+
+#include "comm.h"
+
+namespace livox_ros {
+
+static const char* kStartupPhaseNames[kStartupPhaseNum] = {
+  "discovered", "configured", "first point", "first publish"
+};
+
+StartupTimer& StartupTimer::GetInstance() {
+  static StartupTimer startup_timer;
+  return startup_timer;
+}
+
+StartupTimer::StartupTimer() : start_time_(GetSteadyTimeNs()), step_time_(start_time_) {}
+
+void StartupTimer::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_time_ = GetSteadyTimeNs();
+  step_time_ = start_time_;
+  phases_.clear();
+  masks_.clear();
+}
+
+void StartupTimer::MarkStep(const char* name) {
+  uint64_t now = GetSteadyTimeNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  printf("Startup: %s took %.1f ms, %.1f ms after start.\n", name,
+         (now - step_time_) / 1e6, (now - start_time_) / 1e6);
+  step_time_ = now;
+}
+
+void StartupTimer::Mark(uint32_t handle, StartupPhase phase) {
+  uint64_t now = GetSteadyTimeNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t& mask = masks_[handle];
+  if (mask & (1u << phase)) {
+    return;
+  }
+  mask |= (1u << phase);
+
+  auto it = phases_.find(handle);
+  uint64_t last_time = (it != phases_.end()) ? it->second : step_time_;
+  printf("Startup: lidar %s %s %.1f ms after start (+%.1f ms).\n", IpNumToString(handle).c_str(),
+         kStartupPhaseNames[phase], (now - start_time_) / 1e6, (now - last_time) / 1e6);
+  phases_[handle] = now;
+}
+
+uint64_t StartupTimer::GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace livox_ros
@@ -0,0 +1,76 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROS_DRIVER_STARTUP_TIMER_H_
+#define LIVOX_ROS_DRIVER_STARTUP_TIMER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+
+namespace livox_ros {
+
+/** Phases a lidar passes from discovery until its point cloud is published */
+typedef enum {
+  kStartupDiscovered = 0, /**< The SDK reported the lidar */
+  kStartupConfigured,     /**< The lidar reached kConnectStateSampling */
+  kStartupFirstPoint,     /**< Its first point packet was queued */
+  kStartupFirstPublish,   /**< Its first point cloud was published */
+  kStartupPhaseNum
+} StartupPhase;
+
+class StartupTimerTest;
+
+/** Logs how long after the driver start each startup phase is reached, once per lidar */
+class StartupTimer {
+  friend class StartupTimerTest;  /**< test/startup_timer_test.cpp */
+
+ public:
+  static StartupTimer& GetInstance();
+
+  /** Phases are measured from the last call */
+  void Start();
+  /** A step of the driver itself is done, e.g. the SDK init */
+  void MarkStep(const char* name);
+  /** Only the first time a lidar reaches a phase is logged */
+  void Mark(uint32_t handle, StartupPhase phase);
+
+ private:
+  StartupTimer();
+  StartupTimer(const StartupTimer&) = delete;
+  StartupTimer& operator=(const StartupTimer&) = delete;
+
+  static uint64_t GetSteadyTimeNs();
+
+  std::mutex mutex_;
+  uint64_t start_time_;
+  uint64_t step_time_;                   /**< end of the last step */
+  std::map<uint32_t, uint64_t> phases_;  /**< key:handle, val:time of the last phase reached */
+  std::map<uint32_t, uint32_t> masks_;   /**< key:handle, val:bit per phase reached */
+};
+
+} // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_STARTUP_TIMER_H_
@@ -0,0 +1,43 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/**
+ * USDT probes of the point cloud path, compiled in with -DLIVOX_TRACEPOINTS=ON (needs sys/sdt.h).
+ * A probe is a single nop until a tracer attaches, e.g.
+ *   lttng enable-event --kernel --userspace-probe=sdt:<binary>:livox_ros_driver2:frame_close frame_close
+ *   bpftrace -e 'usdt:<binary>:livox_ros_driver2:publish { printf("%x %d\n", arg0, arg1); }'
+ * The first argument is always the lidar handle.
+ */
+
+#ifndef LIVOX_ROS_DRIVER_TRACEPOINT_H_
+#define LIVOX_ROS_DRIVER_TRACEPOINT_H_
+
+#ifdef LIVOX_ENABLE_TRACEPOINTS
+#include <sys/sdt.h>
+#define LIVOX_TRACEPOINT(name, ...) STAP_PROBEV(livox_ros_driver2, name, __VA_ARGS__)
+#else
+#define LIVOX_TRACEPOINT(name, ...) do {} while (0)
+#endif
+
+#endif  // LIVOX_ROS_DRIVER_TRACEPOINT_H_
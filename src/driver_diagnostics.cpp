@@ -0,0 +1,199 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "driver_diagnostics.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "lds.h"
+#include "comm/ldq.h"
+#include "comm/pub_handler.h"
+
+namespace livox_ros {
+
+namespace {
+
+const char* kDiagnosticsPrefix = "livox_ros_driver2: ";
+
+uint64_t GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void AddValue(DiagnosticStatus& status, const char* key, const char* format, T value) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), format, value);
+  DiagnosticKeyValue key_value;
+  key_value.key = key;
+  key_value.value = buffer;
+  status.values.push_back(key_value);
+}
+
+/** Raises the level and appends the reason to the message */
+void Degrade(DiagnosticStatus& status, uint8_t level, const std::string& reason) {
+  if (level > status.level) {
+    status.level = level;
+  }
+  status.message = (status.message == "OK") ? reason : status.message + ", " + reason;
+}
+
+const char* GetSyncTypeName(uint8_t time_type) {
+  switch (time_type) {
+    case kTimestampTypeGptpOrPtp:
+      return "ptp";
+    case kTimestampTypeGps:
+      return "gps";
+    default:
+      return "none";
+  }
+}
+
+}  // namespace
+
+DriverDiagnostics::DriverDiagnostics(const DiagnosticsConfig& config, double publish_freq)
+    : config_(config),
+      publish_freq_(publish_freq),
+      last_update_time_(GetSteadyTimeNs()) {}
+
+void DriverDiagnostics::Update(Lds* lds, DiagnosticArray& msg) {
+  uint64_t now = GetSteadyTimeNs();
+  double elapsed = static_cast<double>(now - last_update_time_) / kNsPerSecond;
+  last_update_time_ = now;
+  if (elapsed <= 0.0) {
+    return;
+  }
+
+  msg.status.push_back(MakePipelineStatus());
+  if (lds == nullptr) {
+    return;
+  }
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    const LidarDevice& lidar = lds->lidars_[i];
+    if (lidar.handle == 0) {
+      continue;
+    }
+    LidarStatistics statistics = {};
+    statistics.handle = lidar.handle;
+    DriverStatistics::GetInstance().GetLidarSnapshot(lidar.handle, statistics);
+    msg.status.push_back(MakeLidarStatus(lidar, statistics, elapsed));
+    last_statistics_[lidar.handle] = statistics;
+  }
+}
+
+DiagnosticStatus DriverDiagnostics::MakeLidarStatus(const LidarDevice& lidar, const LidarStatistics& statistics,
+                                                    double elapsed) {
+  LidarStatistics last = {};
+  auto it = last_statistics_.find(statistics.handle);
+  if (it != last_statistics_.end()) {
+    last = it->second;
+  }
+  double packet_rate = (statistics.packets - last.packets) / elapsed;
+  double point_rate = (statistics.points - last.points) / elapsed;
+  double imu_rate = (statistics.imu_packets - last.imu_packets) / elapsed;
+  double frame_rate = (statistics.frames - last.frames) / elapsed;
+  uint64_t dropped_frames = statistics.dropped_frames - last.dropped_frames;
+  int64_t lost_packets = static_cast<int64_t>(statistics.lost_packets - last.lost_packets);
+  uint64_t packets = statistics.packets - last.packets;
+  double packet_loss_ratio = (lost_packets > 0) ?
+      static_cast<double>(lost_packets) / (packets + lost_packets) : 0.0;
+
+  LidarDataQueue* queue = const_cast<LidarDataQueue*>(&lidar.data);
+  uint32_t queue_depth = (queue->storage_packet != nullptr) ? QueueUsedSize(queue) : 0;
+  double queue_usage = (queue->size > 0) ? static_cast<double>(queue_depth) / queue->size : 0.0;
+  size_t imu_queue_depth = const_cast<LidarImuDataQueue&>(lidar.imu_data).Size();
+
+  std::string ip = IpNumToString(lidar.handle);
+  DiagnosticStatus status;
+  status.name = std::string(kDiagnosticsPrefix) + "lidar " + ip;
+  status.hardware_id = ip;
+  status.level = DiagnosticStatus::OK;
+  status.message = "OK";
+
+  if (lidar.connect_state == kConnectStateDisconnected) {
+    Degrade(status, DiagnosticStatus::ERROR, "disconnected");
+  } else if (lidar.connect_state != kConnectStateSampling) {
+    Degrade(status, DiagnosticStatus::ERROR, "not sampling");
+  } else if (statistics.packets == last.packets) {
+    Degrade(status, DiagnosticStatus::ERROR, "no point data");
+  } else {
+    if (config_.min_frame_rate_ratio > 0.0 && frame_rate < config_.min_frame_rate_ratio * publish_freq_.load()) {
+      Degrade(status, DiagnosticStatus::WARN, "low frame rate");
+    }
+    if (config_.max_queue_usage > 0.0 && queue_usage > config_.max_queue_usage) {
+      Degrade(status, DiagnosticStatus::WARN, "queue filling up");
+    }
+    if (dropped_frames > 0) {
+      Degrade(status, DiagnosticStatus::WARN, "frames dropped");
+    }
+    if (config_.max_clock_drift_ppm > 0.0 && statistics.time_type == kTimestampTypeNoSync &&
+        fabs(statistics.clock_drift_ppm) > config_.max_clock_drift_ppm) {
+      Degrade(status, DiagnosticStatus::WARN, "clock drift");
+    }
+    if (config_.max_packet_loss_ratio > 0.0 && packet_loss_ratio > config_.max_packet_loss_ratio) {
+      Degrade(status, DiagnosticStatus::WARN, "packet loss");
+    }
+  }
+
+  AddValue(status, "packet_rate", "%.1f", packet_rate);
+  AddValue(status, "point_rate", "%.0f", point_rate);
+  AddValue(status, "imu_rate", "%.1f", imu_rate);
+  AddValue(status, "frame_rate", "%.2f", frame_rate);
+  AddValue(status, "publish_freq", "%.2f", publish_freq_.load());
+  AddValue(status, "queue_depth", "%u", queue_depth);
+  AddValue(status, "queue_size", "%u", queue->size);
+  AddValue(status, "imu_queue_depth", "%zu", imu_queue_depth);
+  AddValue(status, "dropped_frames", "%llu", static_cast<unsigned long long>(dropped_frames));
+  AddValue(status, "dropped_frames_total", "%llu", static_cast<unsigned long long>(statistics.dropped_frames));
+  AddValue(status, "packet_loss_ratio", "%.5f", packet_loss_ratio);
+  AddValue(status, "lost_packets_total", "%llu", static_cast<unsigned long long>(statistics.lost_packets));
+  AddValue(status, "reordered_packets_total", "%llu",
+           static_cast<unsigned long long>(statistics.reordered_packets));
+  AddValue(status, "packet_gaps_total", "%llu", static_cast<unsigned long long>(statistics.packet_gaps));
+  AddValue(status, "unrecorded_packets_total", "%llu",
+           static_cast<unsigned long long>(statistics.unrecorded_packets));
+  AddValue(status, "sync_type", "%s", GetSyncTypeName(statistics.time_type));
+  AddValue(status, "clock_drift_ppm", "%.2f", statistics.clock_drift_ppm);
+  return status;
+}
+
+DiagnosticStatus DriverDiagnostics::MakePipelineStatus() {
+  uint32_t raw_queue_size = pub_handler().GetRawPacketQueueSize();
+
+  DiagnosticStatus status;
+  status.name = std::string(kDiagnosticsPrefix) + "pipeline";
+  status.hardware_id = "livox_ros_driver2";
+  status.level = DiagnosticStatus::OK;
+  status.message = "OK";
+  if (config_.max_raw_queue_size > 0 && raw_queue_size > config_.max_raw_queue_size) {
+    Degrade(status, DiagnosticStatus::WARN, "decoding falls behind");
+  }
+  AddValue(status, "raw_packet_queue_depth", "%u", raw_queue_size);
+  return status;
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,84 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Health and throughput of every lidar as diagnostic_msgs for /diagnostics */
+
+#ifndef LIVOX_ROS_DRIVER2_DRIVER_DIAGNOSTICS_H_
+#define LIVOX_ROS_DRIVER2_DRIVER_DIAGNOSTICS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/ros_headers.h"
+#include "comm/driver_statistics.h"
+
+namespace livox_ros {
+
+#ifdef BUILDING_ROS1
+using DiagnosticArray = diagnostic_msgs::DiagnosticArray;
+using DiagnosticStatus = diagnostic_msgs::DiagnosticStatus;
+using DiagnosticKeyValue = diagnostic_msgs::KeyValue;
+#elif defined BUILDING_ROS2
+using DiagnosticArray = diagnostic_msgs::msg::DiagnosticArray;
+using DiagnosticStatus = diagnostic_msgs::msg::DiagnosticStatus;
+using DiagnosticKeyValue = diagnostic_msgs::msg::KeyValue;
+#endif
+
+class Lds;
+
+/** Thresholds of the status levels, a non-positive value disables the check */
+typedef struct {
+  double period;                /**< s between updates, 0 disables diagnostics */
+  double min_frame_rate_ratio;  /**< warn below this fraction of publish_freq */
+  double max_queue_usage;       /**< warn above this fraction of a lidar queue */
+  uint32_t max_raw_queue_size;  /**< warn above this many packets waiting to be decoded */
+  double max_clock_drift_ppm;   /**< warn above this drift of an unsynchronised lidar */
+  double max_packet_loss_ratio; /**< warn above this fraction of lost point cloud packets */
+} DiagnosticsConfig;
+
+class DriverDiagnostics {
+ public:
+  DriverDiagnostics(const DiagnosticsConfig& config, double publish_freq);
+
+  /** Rates are averaged since the previous call */
+  void Update(Lds* lds, DiagnosticArray& msg);
+  void SetPublishFreq(double publish_freq) { publish_freq_.store(publish_freq); }
+
+ private:
+  DiagnosticStatus MakeLidarStatus(const LidarDevice& lidar, const LidarStatistics& statistics,
+                                   double elapsed);
+  DiagnosticStatus MakePipelineStatus();
+
+  DiagnosticsConfig config_;
+  std::atomic<double> publish_freq_;
+  uint64_t last_update_time_;
+  std::map<uint32_t, LidarStatistics> last_statistics_;
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER2_DRIVER_DIAGNOSTICS_H_
@@ -24,6 +24,7 @@
 
 #include "driver_node.h"
 #include "lddc.h"
+#include "comm/latency_histogram.h"
 
 namespace livox_ros {
 
@@ -32,10 +33,21 @@ DriverNode& DriverNode::GetNode() noexcept {
 }
 
 DriverNode::~DriverNode() {
+  stats_exporter_.reset();
   lddc_ptr_->lds_->RequestExit();
   exit_signal_.set_value();
   pointclouddata_poll_thread_->join();
   imudata_poll_thread_->join();
+
+  LatencyTracker& latency_tracker = LatencyTracker::GetInstance();
+  if (latency_tracker.IsEnabled()) {
+    latency_tracker.Disable();
+    if (latency_dump_path_.empty()) {
+      printf("Frame latency: %s\n", latency_tracker.ToJson().c_str());
+    } else if (latency_tracker.DumpToFile(latency_dump_path_)) {
+      printf("Frame latency dumped to %s\n", latency_dump_path_.c_str());
+    }
+  }
 }
 
 } // namespace livox_ros
@@ -26,6 +26,8 @@
 #define LIVOX_DRIVER_NODE_H
 
 #include "include/ros_headers.h"
+#include "driver_diagnostics.h"
+#include "stats_exporter.h"
 
 namespace livox_ros {
 
@@ -43,12 +45,25 @@ class DriverNode final : public ros::NodeHandle {
 
   void PointCloudDataPollThread();
   void ImuDataPollThread();
+  bool BlackBoxDumpCallback(std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res);
+  void EnableLatencyTrace(const std::string& dump_path);
+  void PublishLatency(const ros::TimerEvent& event);
+  void EnableDiagnostics(const DiagnosticsConfig& config, double publish_freq);
+  void PublishDiagnostics(const ros::TimerEvent& event);
 
   std::unique_ptr<Lddc> lddc_ptr_;
   std::shared_ptr<std::thread> pointclouddata_poll_thread_;
   std::shared_ptr<std::thread> imudata_poll_thread_;
   std::shared_future<void> future_;
   std::promise<void> exit_signal_;
+  ros::ServiceServer blackbox_service_;
+  ros::Publisher latency_pub_;
+  ros::Timer latency_timer_;
+  std::string latency_dump_path_;
+  std::unique_ptr<DriverDiagnostics> diagnostics_;
+  ros::Publisher diagnostics_pub_;
+  ros::Timer diagnostics_timer_;
+  std::unique_ptr<StatsExporter> stats_exporter_;
 };
 
 #elif defined BUILDING_ROS2
@@ -64,12 +79,29 @@ class DriverNode final : public rclcpp::Node {
  private:
   void PointCloudDataPollThread();
   void ImuDataPollThread();
+  void BlackBoxDumpCallback(const std::shared_ptr<std_srvs::srv::Trigger::Request> req,
+                            std::shared_ptr<std_srvs::srv::Trigger::Response> res);
+  void EnableLatencyTrace(const std::string& dump_path);
+  void PublishLatency();
+  void EnableDiagnostics(const DiagnosticsConfig& config, double publish_freq);
+  void PublishDiagnostics();
+  /** publish_freq, xfer_format, multi_topic and frame_id are applied at the next frame */
+  rcl_interfaces::msg::SetParametersResult OnSetParameters(const std::vector<rclcpp::Parameter>& parameters);
 
   std::unique_ptr<Lddc> lddc_ptr_;
   std::shared_ptr<std::thread> pointclouddata_poll_thread_;
   std::shared_ptr<std::thread> imudata_poll_thread_;
   std::shared_future<void> future_;
   std::promise<void> exit_signal_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr blackbox_service_;
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr latency_pub_;
+  rclcpp::TimerBase::SharedPtr latency_timer_;
+  std::string latency_dump_path_;
+  std::unique_ptr<DriverDiagnostics> diagnostics_;
+  rclcpp::Publisher<DiagnosticArray>::SharedPtr diagnostics_pub_;
+  rclcpp::TimerBase::SharedPtr diagnostics_timer_;
+  std::unique_ptr<StatsExporter> stats_exporter_;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr parameters_callback_;
 };
 #endif
 
@@ -35,6 +35,9 @@
 #include <pcl_ros/point_cloud.h>
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <std_msgs/String.h>
+#include <std_srvs/Trigger.h>
 #include "livox_ros_driver2/CustomMsg.h"
 #include "livox_ros_driver2/CustomPoint.h"
 
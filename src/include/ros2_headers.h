@@ -34,6 +34,9 @@
 #include <pcl_conversions/pcl_conversions.h>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <sensor_msgs/msg/imu.hpp>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <std_msgs/msg/string.hpp>
+#include <std_srvs/srv/trigger.hpp>
 #include "livox_ros_driver2/msg/custom_point.hpp"
 #include "livox_ros_driver2/msg/custom_msg.hpp"
 
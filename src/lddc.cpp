@@ -36,15 +36,44 @@
 
 #include "driver_node.h"
 #include "lds_lidar.h"
+#include "comm/frame_trace.h"
+#include "comm/driver_statistics.h"
+#include "comm/startup_timer.h"
+#include "comm/tracepoint.h"
 
 namespace livox_ros {
 
+/** Visit the points of a packet in order, whether stored flat or as shared chunks */
+template <typename Visitor>
+static void ForEachPoint(const StoragePacket& pkg, Visitor visit) {
+  if (pkg.chunks.empty()) {
+    for (uint32_t i = 0; i < pkg.points_num; ++i) {
+      visit(i, pkg.points[i]);
+    }
+    return;
+  }
+  uint32_t i = 0;
+  for (const auto& chunk : pkg.chunks) {
+    for (const auto& point : *chunk) {
+      visit(i++, point);
+    }
+  }
+}
+
+#ifdef BUILDING_ROS2
+/** rosbag2 type names of the published messages */
+static const char* kPointCloud2TypeName = "sensor_msgs/msg/PointCloud2";
+static const char* kCustomMsgTypeName = "livox_ros_driver2/msg/CustomMsg";
+static const char* kImuMsgTypeName = "sensor_msgs/msg/Imu";
+#endif
+
 /** Lidar Data Distribute Control--------------------------------------------*/
 #ifdef BUILDING_ROS1
 Lddc::Lddc(int format, int multi_topic, int data_src, int output_type,
     double frq, std::string &frame_id, bool lidar_bag, bool imu_bag)
     : transfer_format_(format),
       use_multi_topic_(multi_topic),
+      imu_multi_topic_(multi_topic),
       data_src_(data_src),
       output_type_(output_type),
       publish_frq_(frq),
@@ -58,22 +87,21 @@ Lddc::Lddc(int format, int multi_topic, int data_src, int output_type,
   global_pub_ = nullptr;
   global_imu_pub_ = nullptr;
   cur_node_ = nullptr;
-  bag_ = nullptr;
 }
 #elif defined BUILDING_ROS2
 Lddc::Lddc(int format, int multi_topic, int data_src, int output_type,
-           double frq, std::string &frame_id)
+           double frq, std::string &frame_id, bool lidar_bag, bool imu_bag)
     : transfer_format_(format),
       use_multi_topic_(multi_topic),
+      imu_multi_topic_(multi_topic),
       data_src_(data_src),
       output_type_(output_type),
       publish_frq_(frq),
-      frame_id_(frame_id) {
+      frame_id_(frame_id),
+      enable_lidar_bag_(lidar_bag),
+      enable_imu_bag_(imu_bag) {
   publish_period_ns_ = kNsPerSecond / publish_frq_;
   lds_ = nullptr;
-#if 0
-  bag_ = nullptr;
-#endif
 }
 #endif
 
@@ -126,10 +154,15 @@ void Lddc::DistributePointCloudData(void) {
   }
   
   lds_->pcd_semaphore_.Wait();
+  ApplyOutputConfig();
   for (uint32_t i = 0; i < lds_->lidar_count_; i++) {
     uint32_t lidar_id = i;
     LidarDevice *lidar = &lds_->lidars_[lidar_id];
     LidarDataQueue *p_queue = &lidar->data;
+    if (kConnectStateDisconnected == lidar->connect_state) {
+      ReclaimLidarPointCloud(lidar_id, lidar);
+      continue;
+    }
     if ((kConnectStateSampling != lidar->connect_state) || (p_queue == nullptr)) {
       continue;
     }
@@ -148,10 +181,15 @@ void Lddc::DistributeImuData(void) {
   }
   
   lds_->imu_semaphore_.Wait();
+  ApplyImuOutputConfig();
   for (uint32_t i = 0; i < lds_->lidar_count_; i++) {
     uint32_t lidar_id = i;
     LidarDevice *lidar = &lds_->lidars_[lidar_id];
     LidarImuDataQueue *p_queue = &lidar->imu_data;
+    if (kConnectStateDisconnected == lidar->connect_state) {
+      ReclaimLidarImu(lidar_id);
+      continue;
+    }
     if ((kConnectStateSampling != lidar->connect_state) || (p_queue == nullptr)) {
       continue;
     }
@@ -159,6 +197,92 @@ void Lddc::DistributeImuData(void) {
   }
 }
 
+void Lddc::SetOutputConfig(uint8_t format, uint8_t multi_topic, const std::string &frame_id) {
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    pending_format_ = format;
+    pending_multi_topic_ = multi_topic;
+    pending_frame_id_ = frame_id;
+  }
+  is_output_changed_.store(true);
+  is_imu_output_changed_.store(true);
+  if (lds_) {
+    lds_->pcd_semaphore_.Signal();
+    lds_->imu_semaphore_.Signal();
+  }
+}
+
+void Lddc::ApplyOutputConfig() {
+  if (!is_output_changed_.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  if (pending_format_ != transfer_format_ || pending_multi_topic_ != use_multi_topic_) {
+    // the publishers of the old format or topics are created again on the next frame
+    for (uint32_t i = 0; i < kMaxSourceLidar; i++) {
+      ReleasePublisher(private_pub_[i]);
+    }
+    ReleasePublisher(global_pub_);
+  }
+  transfer_format_ = pending_format_;
+  use_multi_topic_ = pending_multi_topic_;
+  frame_id_ = pending_frame_id_;
+  std::cout << "point cloud output changed, format: " << static_cast<int>(transfer_format_)
+            << ", multi topic: " << static_cast<int>(use_multi_topic_)
+            << ", frame id: " << frame_id_ << std::endl;
+}
+
+void Lddc::ApplyImuOutputConfig() {
+  if (!is_imu_output_changed_.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  if (pending_multi_topic_ != imu_multi_topic_) {
+    for (uint32_t i = 0; i < kMaxSourceLidar; i++) {
+      ReleasePublisher(private_imu_pub_[i]);
+    }
+    ReleasePublisher(global_imu_pub_);
+    imu_multi_topic_ = pending_multi_topic_;
+  }
+}
+
+void Lddc::ReclaimLidarPointCloud(uint8_t index, LidarDevice *lidar) {
+  if (!pcd_reclaimed_[index]) {
+    if (use_multi_topic_) {
+      ReleasePublisher(private_pub_[index]);
+    }
+    DeInitQueue(&lidar->data);
+    storage_packets_[index] = StoragePacket();
+    pcd_reclaimed_[index] = true;
+  }
+  if (imu_reclaimed_[index].load(std::memory_order_acquire)) {
+    lds_->ReleaseLidar(index);
+    pcd_reclaimed_[index] = false;
+    imu_reclaimed_[index].store(false, std::memory_order_relaxed);
+  }
+}
+
+void Lddc::ReclaimLidarImu(uint8_t index) {
+  if (imu_reclaimed_[index].load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (imu_multi_topic_) {
+    ReleasePublisher(private_imu_pub_[index]);
+  }
+  imu_reclaimed_[index].store(true, std::memory_order_release);
+  // the point cloud thread releases the lidar
+  lds_->pcd_semaphore_.Signal();
+}
+
+void Lddc::ReleasePublisher(PublisherPtr& publisher) {
+#ifdef BUILDING_ROS1
+  delete publisher;  // the topic is unadvertised with its last publisher
+  publisher = nullptr;
+#elif defined BUILDING_ROS2
+  publisher.reset();
+#endif
+}
+
 void Lddc::PollingLidarPointCloudData(uint8_t index, LidarDevice *lidar) {
   LidarDataQueue *p_queue = &lidar->data;
   if (p_queue == nullptr || p_queue->storage_packet == nullptr) {
@@ -184,14 +308,12 @@ void Lddc::PollingLidarImuData(uint8_t index, LidarDevice *lidar) {
 }
 
 void Lddc::PrepareExit(void) {
-#ifdef BUILDING_ROS1
-  if (bag_) {
+  if (bag_writer_) {
     DRIVER_INFO(*cur_node_, "Waiting to save the bag file!");
-    bag_->close();
+    bag_writer_->Close();
     DRIVER_INFO(*cur_node_, "Save the bag file successfully!");
-    bag_ = nullptr;
+    bag_writer_ = nullptr;
   }
-#endif
   if (lds_) {
     lds_->PrepareExit();
     lds_ = nullptr;
@@ -200,33 +322,49 @@ void Lddc::PrepareExit(void) {
 
 void Lddc::PublishPointcloud2(LidarDataQueue *queue, uint8_t index) {
   while(!QueueIsEmpty(queue)) {
-    StoragePacket pkg;
+    StoragePacket& pkg = storage_packets_[index];
     QueuePop(queue, &pkg);
-    if (pkg.points.empty()) {
+    if (pkg.points_num == 0) {
       printf("Publish point cloud2 failed, the pkg points is empty.\n");
       continue;
     }
+    uint32_t handle = lds_->lidars_[index].handle;
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePopped);
+    LIVOX_TRACEPOINT(queue_pop, handle, pkg.points_num, pkg.base_time);
 
     PointCloud2 cloud;
     uint64_t timestamp = 0;
     InitPointcloud2Msg(pkg, cloud, timestamp);
+    LIVOX_TRACEPOINT(message_built, handle, pkg.points_num, pkg.base_time);
     PublishPointcloud2Data(index, timestamp, cloud);
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePublished);
+    LIVOX_TRACEPOINT(publish, handle, pkg.points_num, pkg.base_time);
+    DriverStatistics::GetInstance().AddFrame(handle);
+    StartupTimer::GetInstance().Mark(handle, kStartupFirstPublish);
   }
 }
 
 void Lddc::PublishCustomPointcloud(LidarDataQueue *queue, uint8_t index) {
   while(!QueueIsEmpty(queue)) {
-    StoragePacket pkg;
+    StoragePacket& pkg = storage_packets_[index];
     QueuePop(queue, &pkg);
-    if (pkg.points.empty()) {
+    if (pkg.points_num == 0) {
       printf("Publish custom point cloud failed, the pkg points is empty.\n");
       continue;
     }
+    uint32_t handle = lds_->lidars_[index].handle;
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePopped);
+    LIVOX_TRACEPOINT(queue_pop, handle, pkg.points_num, pkg.base_time);
 
     CustomMsg livox_msg;
     InitCustomMsg(livox_msg, pkg, index);
     FillPointsToCustomMsg(livox_msg, pkg);
+    LIVOX_TRACEPOINT(message_built, handle, pkg.points_num, pkg.base_time);
     PublishCustomPointData(livox_msg, index);
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePublished);
+    LIVOX_TRACEPOINT(publish, handle, pkg.points_num, pkg.base_time);
+    DriverStatistics::GetInstance().AddFrame(handle);
+    StartupTimer::GetInstance().Mark(handle, kStartupFirstPublish);
   }
 }
 
@@ -243,18 +381,26 @@ void Lddc::PublishPclMsg(LidarDataQueue *queue, uint8_t index) {
   return;
 #endif
   while(!QueueIsEmpty(queue)) {
-    StoragePacket pkg;
+    StoragePacket& pkg = storage_packets_[index];
     QueuePop(queue, &pkg);
-    if (pkg.points.empty()) {
+    if (pkg.points_num == 0) {
       printf("Publish point cloud failed, the pkg points is empty.\n");
       continue;
     }
+    uint32_t handle = lds_->lidars_[index].handle;
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePopped);
+    LIVOX_TRACEPOINT(queue_pop, handle, pkg.points_num, pkg.base_time);
 
     PointCloud cloud;
     uint64_t timestamp = 0;
     InitPclMsg(pkg, cloud, timestamp);
     FillPointsToPclMsg(pkg, cloud);
+    LIVOX_TRACEPOINT(message_built, handle, pkg.points_num, pkg.base_time);
     PublishPclData(index, timestamp, cloud);
+    FrameTrace::GetInstance().Mark(handle, pkg.base_time, kTracePublished);
+    LIVOX_TRACEPOINT(publish, handle, pkg.points_num, pkg.base_time);
+    DriverStatistics::GetInstance().AddFrame(handle);
+    StartupTimer::GetInstance().Mark(handle, kStartupFirstPublish);
   }
   return;
 }
@@ -306,7 +452,7 @@ void Lddc::InitPointcloud2Msg(const StoragePacket& pkg, PointCloud2& cloud, uint
   cloud.is_bigendian = false;
   cloud.is_dense     = true;
 
-  if (!pkg.points.empty()) {
+  if (pkg.points_num != 0) {
     timestamp = pkg.base_time;
   }
 
@@ -316,23 +462,22 @@ void Lddc::InitPointcloud2Msg(const StoragePacket& pkg, PointCloud2& cloud, uint
       cloud.header.stamp = rclcpp::Time(timestamp);
   #endif
 
-  std::vector<LivoxPointXyzrtlt> points;
-  for (size_t i = 0; i < pkg.points_num; ++i) {
-    LivoxPointXyzrtlt point;
-    point.x = pkg.points[i].x;
-    point.y = pkg.points[i].y;
-    point.z = pkg.points[i].z;
-    point.reflectivity = pkg.points[i].intensity;
-    point.tag = pkg.points[i].tag;
-    point.line = pkg.points[i].line;
-    point.timestamp = static_cast<double>(pkg.points[i].offset_time);
-    points.push_back(std::move(point));
-  }
   cloud.data.resize(pkg.points_num * sizeof(LivoxPointXyzrtlt));
-  memcpy(cloud.data.data(), points.data(), pkg.points_num * sizeof(LivoxPointXyzrtlt));
+  LivoxPointXyzrtlt* points = reinterpret_cast<LivoxPointXyzrtlt*>(cloud.data.data());
+  ForEachPoint(pkg, [points](uint32_t i, const PointXyzlt& src) {
+    LivoxPointXyzrtlt& point = points[i];
+    point.x = src.x;
+    point.y = src.y;
+    point.z = src.z;
+    point.reflectivity = src.intensity;
+    point.tag = src.tag;
+    point.line = src.line;
+    point.timestamp = static_cast<double>(src.offset_time);
+  });
 }
 
-void Lddc::PublishPointcloud2Data(const uint8_t index, const uint64_t timestamp, const PointCloud2& cloud) {
+/** In bag output mode the message is moved to the bag writer */
+void Lddc::PublishPointcloud2Data(const uint8_t index, const uint64_t timestamp, PointCloud2& cloud) {
 #ifdef BUILDING_ROS1
   PublisherPtr publisher_ptr = Lddc::GetCurrentPublisher(index);
 #elif defined BUILDING_ROS2
@@ -344,9 +489,15 @@ void Lddc::PublishPointcloud2Data(const uint8_t index, const uint64_t timestamp,
     publisher_ptr->publish(cloud);
   } else {
 #ifdef BUILDING_ROS1
-    if (bag_ && enable_lidar_bag_) {
-      bag_->write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0), cloud);
+    if (kOutputToRosAndBagFile == output_type_) {
+      publisher_ptr->publish(cloud);
     }
+    if (bag_writer_ && enable_lidar_bag_) {
+      bag_writer_->Write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0),
+                         boost::make_shared<const PointCloud2>(std::move(cloud)));
+    }
+#elif defined BUILDING_ROS2
+    PublishAndRecord(publisher_ptr, cloud, kPointCloud2TypeName, timestamp, enable_lidar_bag_);
 #endif
   }
 }
@@ -361,10 +512,11 @@ void Lddc::InitCustomMsg(CustomMsg& livox_msg, const StoragePacket& pkg, uint8_t
 #endif
 
   uint64_t timestamp = 0;
-  if (!pkg.points.empty()) {
+  if (pkg.points_num != 0) {
     timestamp = pkg.base_time;
   }
   livox_msg.timebase = timestamp;
+  livox_msg.rsvd[0] = pkg.flags;
 
 #ifdef BUILDING_ROS1
   livox_msg.header.stamp = ros::Time(timestamp / 1000000000.0);
@@ -382,23 +534,20 @@ void Lddc::InitCustomMsg(CustomMsg& livox_msg, const StoragePacket& pkg, uint8_t
 }
 
 void Lddc::FillPointsToCustomMsg(CustomMsg& livox_msg, const StoragePacket& pkg) {
-  uint32_t points_num = pkg.points_num;
-  const std::vector<PointXyzlt>& points = pkg.points;
-  for (uint32_t i = 0; i < points_num; ++i) {
-    CustomPoint point;
-    point.x = points[i].x;
-    point.y = points[i].y;
-    point.z = points[i].z;
-    point.reflectivity = points[i].intensity;
-    point.tag = points[i].tag;
-    point.line = points[i].line;
-    point.offset_time = static_cast<uint32_t>(points[i].offset_time - pkg.base_time);
-
-    livox_msg.points.push_back(std::move(point));
-  }
+  livox_msg.points.resize(pkg.points_num);
+  ForEachPoint(pkg, [&livox_msg, &pkg](uint32_t i, const PointXyzlt& src) {
+    CustomPoint& point = livox_msg.points[i];
+    point.x = src.x;
+    point.y = src.y;
+    point.z = src.z;
+    point.reflectivity = src.intensity;
+    point.tag = src.tag;
+    point.line = src.line;
+    point.offset_time = static_cast<uint32_t>(src.offset_time - pkg.base_time);
+  });
 }
 
-void Lddc::PublishCustomPointData(const CustomMsg& livox_msg, const uint8_t index) {
+void Lddc::PublishCustomPointData(CustomMsg& livox_msg, const uint8_t index) {
 #ifdef BUILDING_ROS1
   PublisherPtr publisher_ptr = Lddc::GetCurrentPublisher(index);
 #elif defined BUILDING_ROS2
@@ -409,9 +558,16 @@ void Lddc::PublishCustomPointData(const CustomMsg& livox_msg, const uint8_t inde
     publisher_ptr->publish(livox_msg);
   } else {
 #ifdef BUILDING_ROS1
-    if (bag_ && enable_lidar_bag_) {
-      bag_->write(publisher_ptr->getTopic(), ros::Time(livox_msg.timebase / 1000000000.0), livox_msg);
+    if (kOutputToRosAndBagFile == output_type_) {
+      publisher_ptr->publish(livox_msg);
+    }
+    if (bag_writer_ && enable_lidar_bag_) {
+      ros::Time time(livox_msg.timebase / 1000000000.0);
+      bag_writer_->Write(publisher_ptr->getTopic(), time,
+                         boost::make_shared<const CustomMsg>(std::move(livox_msg)));
     }
+#elif defined BUILDING_ROS2
+    PublishAndRecord(publisher_ptr, livox_msg, kCustomMsgTypeName, livox_msg.timebase, enable_lidar_bag_);
 #endif
   }
 }
@@ -422,7 +578,7 @@ void Lddc::InitPclMsg(const StoragePacket& pkg, PointCloud& cloud, uint64_t& tim
   cloud.height = 1;
   cloud.width = pkg.points_num;
 
-  if (!pkg.points.empty()) {
+  if (pkg.points_num != 0) {
     timestamp = pkg.base_time;
   }
   cloud.header.stamp = timestamp / 1000.0;  // to pcl ros time stamp
@@ -436,21 +592,20 @@ void Lddc::InitPclMsg(const StoragePacket& pkg, PointCloud& cloud, uint64_t& tim
 
 void Lddc::FillPointsToPclMsg(const StoragePacket& pkg, PointCloud& pcl_msg) {
 #ifdef BUILDING_ROS1
-  if (pkg.points.empty()) {
+  if (pkg.points_num == 0) {
     return;
   }
 
-  uint32_t points_num = pkg.points_num;
-  const std::vector<PointXyzlt>& points = pkg.points;
-  for (uint32_t i = 0; i < points_num; ++i) {
+  pcl_msg.points.reserve(pkg.points_num);
+  ForEachPoint(pkg, [&pcl_msg](uint32_t, const PointXyzlt& src) {
     pcl::PointXYZI point;
-    point.x = points[i].x;
-    point.y = points[i].y;
-    point.z = points[i].z;
-    point.intensity = points[i].intensity;
+    point.x = src.x;
+    point.y = src.y;
+    point.z = src.z;
+    point.intensity = src.intensity;
 
     pcl_msg.points.push_back(std::move(point));
-  }
+  });
 #elif defined BUILDING_ROS2
   std::cout << "warning: pcl::PointCloud is not supported in ROS2, "
             << "please check code logic" 
@@ -459,14 +614,18 @@ void Lddc::FillPointsToPclMsg(const StoragePacket& pkg, PointCloud& pcl_msg) {
   return;
 }
 
-void Lddc::PublishPclData(const uint8_t index, const uint64_t timestamp, const PointCloud& cloud) {
+void Lddc::PublishPclData(const uint8_t index, const uint64_t timestamp, PointCloud& cloud) {
 #ifdef BUILDING_ROS1
   PublisherPtr publisher_ptr = Lddc::GetCurrentPublisher(index);
   if (kOutputToRos == output_type_) {
     publisher_ptr->publish(cloud);
   } else {
-    if (bag_ && enable_lidar_bag_) {
-      bag_->write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0), cloud);
+    if (kOutputToRosAndBagFile == output_type_) {
+      publisher_ptr->publish(cloud);
+    }
+    if (bag_writer_ && enable_lidar_bag_) {
+      bag_writer_->Write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0),
+                         boost::make_shared<const PointCloud>(std::move(cloud)));
     }
   }
 #elif defined BUILDING_ROS2
@@ -516,14 +675,36 @@ void Lddc::PublishImuData(LidarImuDataQueue& imu_data_queue, const uint8_t index
     publisher_ptr->publish(imu_msg);
   } else {
 #ifdef BUILDING_ROS1
-    if (bag_ && enable_imu_bag_) {
-      bag_->write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0), imu_msg);
+    if (kOutputToRosAndBagFile == output_type_) {
+      publisher_ptr->publish(imu_msg);
+    }
+    if (bag_writer_ && enable_imu_bag_) {
+      bag_writer_->Write(publisher_ptr->getTopic(), ros::Time(timestamp / 1000000000.0),
+                         boost::make_shared<const ImuMsg>(imu_msg));
     }
+#elif defined BUILDING_ROS2
+    PublishAndRecord(publisher_ptr, imu_msg, kImuMsgTypeName, timestamp, enable_imu_bag_);
 #endif
   }
 }
 
 #ifdef BUILDING_ROS2
+/** Serializes the message once, the same bytes are published live and written to the bag */
+template <typename MessageT>
+void Lddc::PublishAndRecord(const std::shared_ptr<Publisher<MessageT>>& publisher, const MessageT& msg,
+                            const char* type_name, uint64_t timestamp, bool record) {
+  static rclcpp::Serialization<MessageT> serializer;
+  auto serialized_msg = std::make_shared<rclcpp::SerializedMessage>();
+  serializer.serialize_message(&msg, serialized_msg.get());
+
+  if (kOutputToRosAndBagFile == output_type_) {
+    publisher->publish(*serialized_msg);
+  }
+  if (bag_writer_ && record) {
+    bag_writer_->Write(publisher->get_topic_name(), type_name, serialized_msg, timestamp);
+  }
+}
+
 std::shared_ptr<rclcpp::PublisherBase> Lddc::CreatePublisher(uint8_t msg_type,
     std::string &topic_name, uint32_t queue_size) {
     if (kPointCloud2Msg == msg_type) {
@@ -609,7 +790,7 @@ PublisherPtr Lddc::GetCurrentImuPublisher(uint8_t handle) {
   ros::Publisher **pub = nullptr;
   uint32_t queue_size = kMinEthPacketQueueSize;
 
-  if (use_multi_topic_) {
+  if (imu_multi_topic_) {
     pub = &private_imu_pub_[handle];
     queue_size = queue_size * 2; // queue size is 64 for only one lidar
   } else {
@@ -620,7 +801,7 @@ PublisherPtr Lddc::GetCurrentImuPublisher(uint8_t handle) {
   if (*pub == nullptr) {
     char name_str[48];
     memset(name_str, 0, sizeof(name_str));
-    if (use_multi_topic_) {
+    if (imu_multi_topic_) {
       DRIVER_INFO(*cur_node_, "Support multi topics.");
       std::string ip_string = IpNumToString(lds_->lidars_[handle].handle);
       snprintf(name_str, sizeof(name_str), "livox/imu_%s",
@@ -666,7 +847,7 @@ std::shared_ptr<rclcpp::PublisherBase> Lddc::GetCurrentPublisher(uint8_t handle)
 
 std::shared_ptr<rclcpp::PublisherBase> Lddc::GetCurrentImuPublisher(uint8_t handle) {
   uint32_t queue_size = kMinEthPacketQueueSize;
-  if (use_multi_topic_) {
+  if (imu_multi_topic_) {
     if (!private_imu_pub_[handle]) {
       char name_str[48];
       memset(name_str, 0, sizeof(name_str));
@@ -690,14 +871,32 @@ std::shared_ptr<rclcpp::PublisherBase> Lddc::GetCurrentImuPublisher(uint8_t hand
 }
 #endif
 
-void Lddc::CreateBagFile(const std::string &file_name) {
 #ifdef BUILDING_ROS1
-  if (!bag_) {
-    bag_ = new rosbag::Bag;
-    bag_->open(file_name, rosbag::bagmode::Write);
+void Lddc::CreateBagFile(const std::string &file_name) {
+  if (!bag_writer_) {
+    bag_writer_ = std::make_unique<BagWriter>();
+    if (!bag_writer_->Open(file_name)) {
+      DRIVER_ERROR(*cur_node_, "Create bag file failed :%s!", file_name.c_str());
+      bag_writer_ = nullptr;
+      return;
+    }
     DRIVER_INFO(*cur_node_, "Create bag file :%s!", file_name.c_str());
   }
-#endif
 }
+#elif defined BUILDING_ROS2
+void Lddc::CreateBagFile(const std::string &file_name, const std::string &storage_id,
+                         const std::string &compression_format) {
+  if (!bag_writer_) {
+    bag_writer_ = std::make_unique<BagWriter>();
+    if (!bag_writer_->Open(file_name, storage_id, compression_format)) {
+      DRIVER_ERROR(*cur_node_, "Create bag failed :%s!", file_name.c_str());
+      bag_writer_ = nullptr;
+      return;
+    }
+    DRIVER_INFO(*cur_node_, "Create bag :%s, storage :%s, compression :%s!", file_name.c_str(),
+                storage_id.c_str(), compression_format.empty() ? "none" : compression_format.c_str());
+  }
+}
+#endif
 
 }  // namespace livox_ros
@@ -25,8 +25,13 @@
 #ifndef LIVOX_ROS_DRIVER2_LDDC_H_
 #define LIVOX_ROS_DRIVER2_LDDC_H_
 
+#include <atomic>
+#include <mutex>
+#include <string>
+
 #include "include/livox_ros_driver2.h"
 
+#include "bag_writer.h"
 #include "driver_node.h"
 #include "lds.h"
 
@@ -36,6 +41,7 @@ namespace livox_ros {
 typedef enum {
   kOutputToRos = 0,
   kOutputToRosBagFile = 1,
+  kOutputToRosAndBagFile = 2, /**< Published and written to the bag, output_data_type 2 */
 } DestinationOfMessageOutput;
 
 /** The message type of transfer */
@@ -68,27 +74,38 @@ using ImuMsg = sensor_msgs::msg::Imu;
 using PointCloud = pcl::PointCloud<pcl::PointXYZI>;
 
 class DriverNode;
+class LddcBenchmark;
 
 class Lddc final {
+  friend class LddcBenchmark;  /**< benchmark/lddc_benchmark.cpp */
+
  public:
 #ifdef BUILDING_ROS1
   Lddc(int format, int multi_topic, int data_src, int output_type, double frq,
       std::string &frame_id, bool lidar_bag, bool imu_bag);
 #elif defined BUILDING_ROS2
   Lddc(int format, int multi_topic, int data_src, int output_type, double frq,
-      std::string &frame_id);
+      std::string &frame_id, bool lidar_bag, bool imu_bag);
 #endif
   ~Lddc();
 
   int RegisterLds(Lds *lds);
   void DistributePointCloudData(void);
   void DistributeImuData(void);
+#ifdef BUILDING_ROS1
   void CreateBagFile(const std::string &file_name);
+#elif defined BUILDING_ROS2
+  void CreateBagFile(const std::string &file_name, const std::string &storage_id,
+                     const std::string &compression_format);
+#endif
   void PrepareExit(void);
 
   uint8_t GetTransferFormat(void) { return transfer_format_; }
   uint8_t IsMultiTopic(void) { return use_multi_topic_; }
   void SetRosNode(livox_ros::DriverNode *node) { cur_node_ = node; }
+  /** Taken over by the publishing threads before their next message, the SDK keeps running */
+  void SetOutputConfig(uint8_t format, uint8_t multi_topic, const std::string &frame_id);
+  uint8_t GetOutputType(void) { return output_type_; }
 
   // void SetRosPub(ros::Publisher *pub) { global_pub_ = pub; };  // NOT USED
   void SetPublishFrq(uint32_t frq) { publish_frq_ = frq; }
@@ -99,6 +116,11 @@ class Lddc final {
  private:
   void PollingLidarPointCloudData(uint8_t index, LidarDevice *lidar);
   void PollingLidarImuData(uint8_t index, LidarDevice *lidar);
+  void ApplyOutputConfig();
+  void ApplyImuOutputConfig();
+  void ReclaimLidarPointCloud(uint8_t index, LidarDevice *lidar);
+  void ReclaimLidarImu(uint8_t index);
+  static void ReleasePublisher(PublisherPtr& publisher);
 
   void PublishPointcloud2(LidarDataQueue *queue, uint8_t index);
   void PublishCustomPointcloud(LidarDataQueue *queue, uint8_t index);
@@ -108,15 +130,15 @@ class Lddc final {
 
   void InitPointcloud2MsgHeader(PointCloud2& cloud);
   void InitPointcloud2Msg(const StoragePacket& pkg, PointCloud2& cloud, uint64_t& timestamp);
-  void PublishPointcloud2Data(const uint8_t index, uint64_t timestamp, const PointCloud2& cloud);
+  void PublishPointcloud2Data(const uint8_t index, uint64_t timestamp, PointCloud2& cloud);
 
   void InitCustomMsg(CustomMsg& livox_msg, const StoragePacket& pkg, uint8_t index);
   void FillPointsToCustomMsg(CustomMsg& livox_msg, const StoragePacket& pkg);
-  void PublishCustomPointData(const CustomMsg& livox_msg, const uint8_t index);
+  void PublishCustomPointData(CustomMsg& livox_msg, const uint8_t index);
 
   void InitPclMsg(const StoragePacket& pkg, PointCloud& cloud, uint64_t& timestamp);
   void FillPointsToPclMsg(const StoragePacket& pkg, PointCloud& pcl_msg);
-  void PublishPclData(const uint8_t index, const uint64_t timestamp, const PointCloud& cloud);
+  void PublishPclData(const uint8_t index, const uint64_t timestamp, PointCloud& cloud);
 
   void InitImuMsg(const ImuData& imu_data, ImuMsg& imu_msg, uint64_t& timestamp);
 
@@ -126,6 +148,10 @@ class Lddc final {
 
 #ifdef BUILDING_ROS2
   PublisherPtr CreatePublisher(uint8_t msg_type, std::string &topic_name, uint32_t queue_size);
+
+  template <typename MessageT>
+  void PublishAndRecord(const std::shared_ptr<Publisher<MessageT>>& publisher, const MessageT& msg,
+                        const char* type_name, uint64_t timestamp, bool record);
 #endif
 
   PublisherPtr GetCurrentPublisher(uint8_t index);
@@ -134,20 +160,32 @@ class Lddc final {
  private:
   uint8_t transfer_format_;
   uint8_t use_multi_topic_;
+  uint8_t imu_multi_topic_;  /**< use_multi_topic_ as seen by the imu thread */
   uint8_t data_src_;
   uint8_t output_type_;
   double publish_frq_;
   uint32_t publish_period_ns_;
   std::string frame_id_;
+  std::mutex output_mutex_;
+  uint8_t pending_format_;
+  uint8_t pending_multi_topic_;
+  std::string pending_frame_id_;
+  std::atomic<bool> is_output_changed_{false};
+  std::atomic<bool> is_imu_output_changed_{false};
+  StoragePacket storage_packets_[kMaxSourceLidar]; /**< Reused pop buffer of each lidar */
+  /** A disconnected lidar is released once both publishing threads let go of it */
+  bool pcd_reclaimed_[kMaxSourceLidar] = {};
+  std::atomic<bool> imu_reclaimed_[kMaxSourceLidar] = {};
 
-#ifdef BUILDING_ROS1
   bool enable_lidar_bag_;
   bool enable_imu_bag_;
+  std::unique_ptr<BagWriter> bag_writer_;
+
+#ifdef BUILDING_ROS1
   PublisherPtr private_pub_[kMaxSourceLidar];
   PublisherPtr global_pub_;
   PublisherPtr private_imu_pub_[kMaxSourceLidar];
   PublisherPtr global_imu_pub_;
-  rosbag::Bag *bag_;
 #elif defined BUILDING_ROS2
   PublisherPtr private_pub_[kMaxSourceLidar];
   PublisherPtr global_pub_;
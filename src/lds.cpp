@@ -31,6 +31,10 @@
 
 #include "lds.h"
 #include "comm/ldq.h"
+#include "comm/frame_trace.h"
+#include "comm/driver_statistics.h"
+#include "comm/startup_timer.h"
+#include "comm/tracepoint.h"
 
 namespace livox_ros {
 
@@ -43,6 +47,11 @@ Lds::Lds(const double publish_freq, const uint8_t data_src)
       imu_semaphore_(0),
       publish_freq_(publish_freq),
       data_src_(data_src),
+      streaming_config_{0, 0},
+      integration_time_(0.0),
+      reorder_window_ns_(0),
+      recorder_config_{"", 0, 0},
+      black_box_config_{"", 0, 0},
       request_exit_(false) {
   ResetLds(data_src_);
 }
@@ -108,11 +117,17 @@ void Lds::StorageImuData(ImuData* imu_data) {
   uint8_t index = 0;
   int ret = cache_index_.GetIndex(imu_data->lidar_type, device_num, index);
   if (ret != 0) {
-    printf("Storage point data failed, can not get index, lidar type:%u, device_num:%u.\n", imu_data->lidar_type, device_num);
+    // silence is tracked on point cloud packets, only they reattach a released lidar
+    if (!IsLidarDetached(device_num)) {
+      printf("Storage point data failed, can not get index, lidar type:%u, device_num:%u.\n", imu_data->lidar_type, device_num);
+    }
     return;
   }
 
   LidarDevice *p_lidar = &lidars_[index];
+  if (p_lidar->connect_state == kConnectStateDisconnected) {
+    return;
+  }
   LidarImuDataQueue* imu_queue = &p_lidar->imu_data;
   imu_queue->Push(imu_data);
   if (!imu_queue->Empty()) {
@@ -138,6 +153,9 @@ void Lds::StorageLvxPointData(PointFrame* frame) {
       printf("Storage lvx point data failed, lidar type:%u, device num:%u.\n", lidar_point.lidar_type, lidar_point.handle);
       continue;
     }
+    if (lidars_[index].connect_state == kConnectStateDisconnected) {
+      continue;
+    }
 
     lidars_[index].connect_state = kConnectStateSampling;
 
@@ -160,8 +178,11 @@ void Lds::StoragePointData(PointFrame* frame) {
     uint8_t index = 0;
     int8_t ret = cache_index_.GetIndex(lidar_point.lidar_type, lidar_point.handle, index);
     if (ret != 0) {
-      printf("Storage point data failed, lidar type:%u, handle:%u.\n", lidar_point.lidar_type, lidar_point.handle);
-      continue;
+      if (!ReattachLidar(lidar_point.handle, index)) {
+        printf("Storage point data failed, lidar type:%u, handle:%u.\n", lidar_point.lidar_type, lidar_point.handle);
+        continue;
+      }
+      OnLidarReattached(&lidars_[index]);
     }
     PushLidarData(&lidar_point, index, base_time);
   }
@@ -174,27 +195,108 @@ void Lds::PushLidarData(PointPacket* lidar_data, const uint8_t index, const uint
 
   LidarDevice *p_lidar = &lidars_[index];
   LidarDataQueue *queue = &p_lidar->data;
+  if (p_lidar->connect_state == kConnectStateDisconnected) {
+    return;  // the queue is being reclaimed
+  }
 
+  double queue_freq = publish_freq_.load();
+  if (IsStreamingEnabled(streaming_config_)) {
+    queue_freq = std::max(queue_freq, CalculateStreamingFrequency(streaming_config_));
+  }
+  uint32_t queue_size = CalculatePacketQueueSize(queue_freq);
   if (nullptr == queue->storage_packet) {
-    uint32_t queue_size = CalculatePacketQueueSize(publish_freq_);
     InitQueue(queue, queue_size);
     printf("Lidar[%u] storage queue size: %u\n", index, queue_size);
+    StartupTimer::GetInstance().Mark(lidar_data->handle, kStartupFirstPoint);
+  } else if (queue->size != RoundupPowerOf2(queue_size) && ResizeQueue(queue, queue_size)) {
+    // the publish rate changed at runtime
+    printf("Lidar[%u] storage queue resized: %u\n", index, queue->size);
   }
 
   if (!QueueIsFull(queue)) {
     QueuePushAny(queue, (uint8_t *)lidar_data, base_time);
+    FrameTrace::GetInstance().Mark(lidar_data->handle, base_time, kTraceQueued);
+    LIVOX_TRACEPOINT(queue_push, lidar_data->handle, lidar_data->points_num, base_time, QueueUsedSize(queue));
     if (!QueueIsEmpty(queue)) {
       if (pcd_semaphore_.GetCount() <= 0) {
         pcd_semaphore_.Signal();
       }
     }
   } else {
+    FrameTrace::GetInstance().Drop(lidar_data->handle, base_time);
+    LIVOX_TRACEPOINT(queue_drop, lidar_data->handle, lidar_data->points_num, base_time);
+    DriverStatistics::GetInstance().AddDroppedFrame(lidar_data->handle);
     if (pcd_semaphore_.GetCount() <= 0) {
         pcd_semaphore_.Signal();
     }
   }
 }
 
+void Lds::StartSampling(LidarDevice* lidar) {
+  lidar->connect_state = kConnectStateSampling;
+  StartupTimer::GetInstance().Mark(lidar->handle, kStartupConfigured);
+  pcd_semaphore_.Signal();
+  imu_semaphore_.Signal();
+}
+
+void Lds::OnLidarDisconnected(uint32_t handle) {
+  uint8_t index = 0;
+  if (cache_index_.GetIndex(kLivoxLidarType, handle, index) != 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(attach_mutex_);
+    LidarDevice *p_lidar = &lidars_[index];
+    if (p_lidar->connect_state == kConnectStateSampling ||
+        p_lidar->connect_state == kConnectStateConfig) {
+      detached_lidars_[handle] = p_lidar->livox_config;
+    }
+    p_lidar->connect_state = kConnectStateDisconnected;
+  }
+  // wake up both publishing threads even if no other lidar is sending
+  pcd_semaphore_.Signal();
+  imu_semaphore_.Signal();
+}
+
+void Lds::ReleaseLidar(uint8_t index) {
+  std::lock_guard<std::mutex> lock(attach_mutex_);
+  LidarDevice *p_lidar = &lidars_[index];
+  printf("Release lidar[%u], ip: %s.\n", index, IpNumToString(p_lidar->handle).c_str());
+  cache_index_.ResetIndex(p_lidar);
+  ResetLidar(p_lidar, p_lidar->data_src);
+  p_lidar->handle = 0;
+  p_lidar->livox_config = UserLivoxLidarConfig();
+}
+
+bool Lds::ReattachLidar(uint32_t handle, uint8_t& index) {
+  std::lock_guard<std::mutex> lock(attach_mutex_);
+  auto it = detached_lidars_.find(handle);
+  if (it == detached_lidars_.end()) {
+    return false;
+  }
+  if (cache_index_.GetFreeIndex(kLivoxLidarType, handle, index) != 0) {
+    return false;
+  }
+  LidarDevice *p_lidar = &lidars_[index];
+  p_lidar->lidar_type = kLivoxLidarType;
+  p_lidar->handle = handle;
+  p_lidar->livox_config = it->second;
+  p_lidar->livox_config.set_bits = 0;
+  p_lidar->connect_state = kConnectStateConfig;
+  detached_lidars_.erase(it);
+  printf("Reattach lidar[%u], ip: %s.\n", index, IpNumToString(handle).c_str());
+  return true;
+}
+
+void Lds::OnLidarReattached(LidarDevice* lidar) {
+  StartSampling(lidar);
+}
+
+bool Lds::IsLidarDetached(uint32_t handle) {
+  std::lock_guard<std::mutex> lock(attach_mutex_);
+  return detached_lidars_.find(handle) != detached_lidars_.end();
+}
+
 void Lds::PrepareExit(void) {}
 
 }  // namespace livox_ros
@@ -27,7 +27,9 @@
 #ifndef LIVOX_ROS_DRIVER_LDS_H_
 #define LIVOX_ROS_DRIVER_LDS_H_
 
+#include <atomic>
 #include <map>
+#include <mutex>
 
 #include "comm/semaphore.h"
 #include "comm/comm.h"
@@ -49,6 +51,18 @@ class Lds {
   int8_t GetHandle(const uint8_t lidar_type, const PointPacket* lidar_point);
   void PushLidarData(PointPacket* lidar_data, const uint8_t index, const uint64_t base_time);
 
+  /** The lidar is configured, the publishing threads pick up its data right away */
+  void StartSampling(LidarDevice* lidar);
+  /** Mark a silent lidar as disconnected, the publishing threads then reclaim its resources */
+  void OnLidarDisconnected(uint32_t handle);
+  /** Free the queues and the slot of a disconnected lidar once no thread uses them any more */
+  void ReleaseLidar(uint8_t index);
+  /** Give a released lidar a slot again with its config, it samples once configured again */
+  bool ReattachLidar(uint32_t handle, uint8_t& index);
+  /** Point packets reattached a released lidar, push its config to it like to a new lidar */
+  virtual void OnLidarReattached(LidarDevice* lidar);
+  bool IsLidarDetached(uint32_t handle);
+
   static void ResetLidar(LidarDevice *lidar, uint8_t data_src);
   static void SetLidarDataSrc(LidarDevice *lidar, uint8_t data_src);
   void ResetLds(uint8_t data_src);
@@ -63,7 +77,23 @@ class Lds {
   virtual void PrepareExit(void);
 
   // get publishing frequency
-  double GetLdsFrequency() { return publish_freq_; }
+  double GetLdsFrequency() { return publish_freq_.load(); }
+  /** At runtime, the point cloud queues are resized for the new rate once they run empty */
+  void SetLdsFrequency(double publish_freq) { publish_freq_.store(publish_freq); }
+
+  void SetStreamingConfig(const StreamingConfig& config) { streaming_config_ = config; }
+  const StreamingConfig& GetStreamingConfig() { return streaming_config_; }
+
+  void SetIntegrationTime(double integration_time) { integration_time_ = integration_time; }
+  double GetIntegrationTime() { return integration_time_; }
+
+  void SetReorderWindow(uint64_t reorder_window_ns) { reorder_window_ns_ = reorder_window_ns; }
+  uint64_t GetReorderWindow() { return reorder_window_ns_; }
+
+  void SetRecorderConfig(const RecorderConfig& config) { recorder_config_ = config; }
+  const RecorderConfig& GetRecorderConfig() { return recorder_config_; }
+  void SetBlackBoxConfig(const BlackBoxConfig& config) { black_box_config_ = config; }
+  const BlackBoxConfig& GetBlackBoxConfig() { return black_box_config_; }
 
  public:
   uint8_t lidar_count_;                 /**< Lidar access handle. */
@@ -72,10 +102,17 @@ class Lds {
   Semaphore imu_semaphore_;
   static CacheIndex cache_index_;
  protected:
-  double publish_freq_;
+  std::atomic<double> publish_freq_;
   uint8_t data_src_;
+  StreamingConfig streaming_config_;
+  double integration_time_;
+  uint64_t reorder_window_ns_;
+  RecorderConfig recorder_config_;
+  BlackBoxConfig black_box_config_;
  private:
   volatile bool request_exit_;
+  std::mutex attach_mutex_;
+  std::map<uint32_t, UserLivoxLidarConfig> detached_lidars_;  /**< released while sampling */
 };
 
 }  // namespace livox_ros
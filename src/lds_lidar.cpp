@@ -43,6 +43,7 @@
 #include "livox_lidar_api.h"
 #include "comm/comm.h"
 #include "comm/pub_handler.h"
+#include "comm/startup_timer.h"
 
 #include "parse_cfg_file/parse_cfg_file.h"
 #include "parse_cfg_file/parse_livox_lidar_cfg.h"
@@ -143,6 +144,7 @@ bool LdsLidar::InitLivoxLidar() {
     std::cout << "Failed to init livox lidar sdk." << std::endl;
     return false;
   }
+  StartupTimer::GetInstance().MarkStep("sdk init");
 
   // fill in lidar devices
   for (auto& config : user_configs) {
@@ -157,35 +159,26 @@ bool LdsLidar::InitLivoxLidar() {
     p_lidar->livox_config = config;
     p_lidar->handle = config.handle;
 
-    LidarExtParameter lidar_param;
-    lidar_param.handle = config.handle;
-    lidar_param.lidar_type = kLivoxLidarType;
-    if (config.pcl_data_type == kLivoxLidarCartesianCoordinateLowData) {
-      // temporary resolution
-      lidar_param.param.roll  = config.extrinsic_param.roll;
-      lidar_param.param.pitch = config.extrinsic_param.pitch;
-      lidar_param.param.yaw   = config.extrinsic_param.yaw;
-      lidar_param.param.x     = config.extrinsic_param.x / 10;
-      lidar_param.param.y     = config.extrinsic_param.y / 10;
-      lidar_param.param.z     = config.extrinsic_param.z / 10;
-    } else {
-      lidar_param.param.roll  = config.extrinsic_param.roll;
-      lidar_param.param.pitch = config.extrinsic_param.pitch;
-      lidar_param.param.yaw   = config.extrinsic_param.yaw;
-      lidar_param.param.x     = config.extrinsic_param.x;
-      lidar_param.param.y     = config.extrinsic_param.y;
-      lidar_param.param.z     = config.extrinsic_param.z;
-    }
+    LidarExtParameter lidar_param = MakeLidarExtParameter(config);
     pub_handler().AddLidarsExtParam(lidar_param);
   }
 
+  config_retry_.Start();
   SetLivoxLidarInfoChangeCallback(LivoxLidarCallback::LidarInfoChangeCallback, g_lds_ldiar);
   return true;
 }
 
 void LdsLidar::SetLidarPubHandle() {
   pub_handler().SetPointCloudsCallback(LidarCommonCallback::OnLidarPointClounCb, g_lds_ldiar);
+  pub_handler().AddPointCloudObserver();
   pub_handler().SetImuDataCallback(LidarCommonCallback::LidarImuDataCallback, g_lds_ldiar);
+  pub_handler().SetLidarDisconnectCallback(LidarCommonCallback::OnLidarDisconnectedCb, g_lds_ldiar);
+
+  pub_handler().SetStreamingConfig(Lds::GetStreamingConfig());
+  pub_handler().SetIntegrationTime(Lds::GetIntegrationTime());
+  pub_handler().SetReorderWindow(Lds::GetReorderWindow());
+  pub_handler().SetRecorderConfig(Lds::GetRecorderConfig());
+  pub_handler().SetBlackBoxConfig(Lds::GetBlackBoxConfig());
 
   double publish_freq = Lds::GetLdsFrequency();
   pub_handler().SetPointCloudConfig(publish_freq);
@@ -202,6 +195,7 @@ int LdsLidar::DeInitLdsLidar(void) {
   }
 
   if (lidar_summary_info_.lidar_type & kLivoxLidarType) {
+    config_retry_.Stop();
     LivoxLidarSdkUninit();
     printf("Livox Lidar SDK Deinit completely!\n");
   }
@@ -211,4 +205,9 @@ int LdsLidar::DeInitLdsLidar(void) {
 
 void LdsLidar::PrepareExit(void) { DeInitLdsLidar(); }
 
+void LdsLidar::OnLidarReattached(LidarDevice* lidar) {
+  // the sdk may not report a lidar again that only went silent, configure it as if it had
+  LivoxLidarCallback::LidarInfoChangeCallback(lidar->handle, nullptr, this);
+}
+
 }  // namespace livox_ros
@@ -33,6 +33,7 @@
 
 #include "lds.h"
 #include "comm/comm.h"
+#include "comm/retry_scheduler.h"
 
 #include "livox_lidar_def.h"
 
@@ -75,9 +76,11 @@ class LdsLidar final : public Lds {
   bool IsAutoConnectMode(void) { return auto_connect_mode_; }
 
   virtual void PrepareExit(void);
+  virtual void OnLidarReattached(LidarDevice* lidar);
 
  public:
   std::mutex config_mutex_;
+  RetryScheduler config_retry_;  /**< resends the config commands that timed out */
 
  private:
   std::string path_;
@@ -0,0 +1,421 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "lds_replay.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "livox_lidar_def.h"
+#include "comm/ldq.h"
+#include "comm/mapped_file.h"
+#include "comm/packet_recorder.h"
+#include "comm/pub_handler.h"
+
+#include "parse_cfg_file/parse_livox_lidar_cfg.h"
+
+#include "call_back/lidar_common_callback.h"
+
+namespace livox_ros {
+
+/** Backpressure in as-fast-as-possible replay, about 0.2s of packets of 4 lidars */
+const uint32_t kReplayMaxPendingPackets = 4096;
+
+/** Point interval used when an lvx2 package has no usable predecessor, 200k points/s */
+const uint64_t kLvx2DefaultPointInterval = 5000;  // ns
+/** Packages further apart than this are treated as a gap in the lvx2 recording */
+const uint64_t kLvx2MaxPackageInterval = 10000000;  // ns
+
+/** Size of one point of the packet data type, 0 if unknown */
+static uint32_t GetPointSize(uint8_t data_type) {
+  switch (data_type) {
+    case kLivoxLidarImuData:
+      return sizeof(LivoxLidarImuRawPoint);
+    case kLivoxLidarCartesianCoordinateHighData:
+      return sizeof(LivoxLidarCartesianHighRawPoint);
+    case kLivoxLidarCartesianCoordinateLowData:
+      return sizeof(LivoxLidarCartesianLowRawPoint);
+    case kLivoxLidarSphericalCoordinateData:
+      return sizeof(LivoxLidarSpherPoint);
+    default:
+      return 0;
+  }
+}
+
+LdsReplay::LdsReplay(double publish_freq, uint8_t data_src)
+    : Lds(publish_freq, data_src),
+      replay_rate_(1.0),
+      packet_count_(0),
+      is_paced_(false),
+      first_recv_time_(0),
+      is_quit_(false),
+      is_initialized_(false) {
+  lvx2_base_time_ = 0;
+  packet_buffer_.resize(kMaxBufferSize);
+  ResetLds(data_src);
+}
+
+LdsReplay::~LdsReplay() {}
+
+bool LdsReplay::InitLdsReplay(const std::string& record_path, const std::string& user_config_path) {
+  if (is_initialized_) {
+    printf("Lds replay is already inited!\n");
+    return false;
+  }
+  if (!ListRecordFiles(record_path)) {
+    return false;
+  }
+  LoadExtrinsics(user_config_path);
+  SetReplayPubHandle();
+
+  is_quit_.store(false);
+  replay_thread_ = std::make_shared<std::thread>(&LdsReplay::ReplayProcess, this);
+  is_initialized_ = true;
+  return true;
+}
+
+int LdsReplay::DeInitLdsReplay(void) {
+  if (!is_initialized_) {
+    printf("Replay data source is not exit");
+    return -1;
+  }
+  is_quit_.store(true);
+  if (replay_thread_ && replay_thread_->joinable()) {
+    replay_thread_->join();
+  }
+  replay_thread_ = nullptr;
+  is_initialized_ = false;
+  return 0;
+}
+
+void LdsReplay::PrepareExit(void) { DeInitLdsReplay(); }
+
+bool LdsReplay::ListRecordFiles(const std::string& record_path) {
+  record_files_.clear();
+  struct stat path_stat;
+  if (stat(record_path.c_str(), &path_stat) != 0) {
+    printf("Record path does not exist: %s\n", record_path.c_str());
+    return false;
+  }
+  if (!S_ISDIR(path_stat.st_mode)) {
+    record_files_.push_back(record_path);
+    return true;
+  }
+
+  DIR* dir = opendir(record_path.c_str());
+  if (dir == nullptr) {
+    printf("Open record directory failed: %s\n", record_path.c_str());
+    return false;
+  }
+  std::string extension(kRecordFileExtension);
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name.size() > extension.size() &&
+        name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+      record_files_.push_back(record_path + "/" + name);
+    }
+  }
+  closedir(dir);
+  // segment names start with the recording time and end with the segment index
+  std::sort(record_files_.begin(), record_files_.end());
+  if (record_files_.empty()) {
+    printf("No record file in directory: %s\n", record_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void LdsReplay::LoadExtrinsics(const std::string& user_config_path) {
+  if (user_config_path.empty()) {
+    return;
+  }
+  LivoxLidarConfigParser parser(user_config_path);
+  std::vector<UserLivoxLidarConfig> user_configs;
+  if (!parser.Parse(user_configs)) {
+    std::cout << "failed to parse user-defined config, replay without extrinsics" << std::endl;
+    return;
+  }
+  for (auto& config : user_configs) {
+    LidarExtParameter lidar_param = MakeLidarExtParameter(config);
+    pub_handler().AddLidarsExtParam(lidar_param);
+  }
+}
+
+void LdsReplay::SetReplayPubHandle() {
+  pub_handler().SetPointCloudsCallback(LidarCommonCallback::OnLidarPointClounCb, this);
+  pub_handler().SetImuDataCallback(LidarCommonCallback::LidarImuDataCallback, this);
+  pub_handler().SetLidarDisconnectCallback(LidarCommonCallback::OnLidarDisconnectedCb, this);
+
+  pub_handler().SetStreamingConfig(Lds::GetStreamingConfig());
+  pub_handler().SetIntegrationTime(Lds::GetIntegrationTime());
+  pub_handler().SetReorderWindow(Lds::GetReorderWindow());
+  pub_handler().SetReplayClock(true);
+  pub_handler().SetRecorderConfig(Lds::GetRecorderConfig());
+  pub_handler().SetBlackBoxConfig(Lds::GetBlackBoxConfig());
+
+  double publish_freq = Lds::GetLdsFrequency();
+  pub_handler().SetPointCloudConfig(publish_freq);
+}
+
+void LdsReplay::RegisterLidar(uint32_t handle) {
+  lidar_handles_.insert(handle);
+  uint8_t index = 0;
+  if (cache_index_.GetFreeIndex(kLivoxLidarType, handle, index) != 0) {
+    std::cout << "failed to get free index, lidar ip: " << IpNumToString(handle) << std::endl;
+    return;
+  }
+  LidarDevice *p_lidar = &lidars_[index];
+  p_lidar->lidar_type = kLivoxLidarType;
+  p_lidar->handle = handle;
+  p_lidar->connect_state = kConnectStateSampling;
+  std::cout << "replay lidar, ip: " << IpNumToString(handle) << std::endl;
+}
+
+void LdsReplay::ReplayProcess() {
+  auto begin = std::chrono::steady_clock::now();
+  for (const auto& path : record_files_) {
+    if (is_quit_.load()) {
+      break;
+    }
+    ReplayFile(path);
+  }
+  pub_handler().EndReplay();
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - begin).count();
+  printf("Replay finished, packets: %lu, elapsed: %ld ms\n",
+         static_cast<unsigned long>(packet_count_), static_cast<long>(elapsed));
+}
+
+bool LdsReplay::ReplayFile(const std::string& path) {
+  MappedFile file;
+  if (!file.Open(path)) {
+    return false;
+  }
+  if (Lvx2File::IsLvx2File(file.Data(), file.Size())) {
+    file.Close();
+    return ReplayLvx2File(path);
+  }
+  const RecordFileHeader* header = reinterpret_cast<const RecordFileHeader*>(file.Data());
+  if (file.Size() < sizeof(RecordFileHeader) || header->magic != kRecordFileMagic ||
+      header->version != kRecordFileVersion) {
+    printf("Not a raw packet record file: %s\n", path.c_str());
+    return false;
+  }
+  printf("Replay record file: %s\n", path.c_str());
+
+  uint64_t end = file.Size();
+  if (header->data_size != 0) {
+    end = std::min(end, header->header_size + header->data_size);
+  }
+  file.Advise(0, end, MADV_SEQUENTIAL);
+
+  uint64_t offset = header->header_size;
+  while (!is_quit_.load() && offset + sizeof(RecordHeader) <= end) {
+    const RecordHeader* record = reinterpret_cast<const RecordHeader*>(file.Data() + offset);
+    if (record->record_size == 0) {
+      break;  // the end of a segment that was not closed
+    }
+    if (record->record_size < sizeof(RecordHeader) + record->packet_size ||
+        record->packet_size < sizeof(LivoxLidarEthernetPacket) ||
+        offset + record->record_size > end) {
+      printf("Corrupted record at offset %lu of %s\n", static_cast<unsigned long>(offset), path.c_str());
+      return false;
+    }
+    // the packet is only read, the mapping is private and read-only
+    LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(
+        const_cast<uint8_t*>(file.Data() + offset + sizeof(RecordHeader)));
+    // the decoder trusts the length and point count inside the packet, not the record size
+    if (packet->length < sizeof(LivoxLidarEthernetPacket) - 1 || packet->length > record->packet_size ||
+        static_cast<uint64_t>(packet->dot_num) * GetPointSize(packet->data_type) >
+            packet->length - (sizeof(LivoxLidarEthernetPacket) - 1)) {
+      printf("Corrupted record at offset %lu of %s\n", static_cast<unsigned long>(offset), path.c_str());
+      return false;
+    }
+
+    PaceRecord(record->recv_time);
+    if (lidar_handles_.find(record->handle) == lidar_handles_.end()) {
+      RegisterLidar(record->handle);
+    }
+    pub_handler().PushEthPacket(record->handle, record->dev_type, packet, record->recv_time);
+    ++packet_count_;
+    offset += record->record_size;
+  }
+  return true;
+}
+
+bool LdsReplay::ReplayLvx2File(const std::string& path) {
+  Lvx2File file;
+  if (!file.Open(path)) {
+    return false;
+  }
+  printf("Replay lvx2 file: %s\n", path.c_str());
+  lvx2_devices_ = file.GetDeviceInfos();
+  lvx2_lidar_states_.clear();
+  lvx2_base_time_ = 0;
+
+  const uint8_t* packages = nullptr;
+  uint64_t size = 0;
+  while (!is_quit_.load() && file.NextFrame(packages, size)) {
+    const uint8_t* cursor = packages;
+    const uint8_t* end = packages + size;
+    const Lvx2PackageHeader* header = nullptr;
+    const uint8_t* data = nullptr;
+    while (!is_quit_.load() && Lvx2File::NextPackage(cursor, end, header, data)) {
+      if (PushLvx2Package(header, data)) {
+        ++packet_count_;
+      }
+    }
+    if (cursor != end) {
+      printf("Truncated lvx2 frame in %s\n", path.c_str());
+    }
+  }
+  return true;
+}
+
+bool LdsReplay::PushLvx2Package(const Lvx2PackageHeader* header, const uint8_t* data) {
+  uint32_t point_size = GetPointSize(header->data_type);
+  if (point_size == 0 || header->data_type == kLivoxLidarImuData) {
+    return false;  // lvx2 files carry point data only
+  }
+  uint32_t packet_size = sizeof(LivoxLidarEthernetPacket) - 1 + header->length;
+  if (header->length < point_size || packet_size > packet_buffer_.size()) {
+    return false;
+  }
+
+  uint64_t timestamp = 0;
+  memcpy(&timestamp, header->timestamp, sizeof(timestamp));
+  uint32_t dot_num = header->length / point_size;
+
+  // first sight of a lidar, its device info decides the type and the extrinsics
+  uint32_t handle = header->lidar_id;
+  auto device = lvx2_devices_.find(handle);
+  uint8_t dev_type = kLivoxLidarTypeMid360;
+  if (device != lvx2_devices_.end()) {
+    dev_type = device->second.device_type;
+  }
+  auto state = lvx2_lidar_states_.find(handle);
+  if (state == lvx2_lidar_states_.end()) {
+    if (device != lvx2_devices_.end() && device->second.extrinsic_enable) {
+      SetLvx2ExtParam(device->second, header->data_type);
+    }
+    if (lidar_handles_.find(handle) == lidar_handles_.end()) {
+      RegisterLidar(handle);
+    }
+    if (lvx2_lidar_states_.empty()) {
+      lvx2_base_time_ = timestamp;
+    }
+    state = lvx2_lidar_states_.emplace(handle, Lvx2LidarState{timestamp, 0}).first;
+  }
+
+  // the point interval is spread over the time to the previous package of the same lidar
+  uint64_t point_interval = kLvx2DefaultPointInterval;
+  if (state->second.last_time != 0 && timestamp > state->second.last_time &&
+      timestamp - state->second.last_time < kLvx2MaxPackageInterval) {
+    point_interval = (timestamp - state->second.last_time) / dot_num;
+  }
+  state->second.last_time = timestamp;
+
+  // the receive time is synthesised on one timeline for all lidars of the file
+  uint64_t recv_time = lvx2_base_time_;
+  if (timestamp > state->second.first_time) {
+    recv_time += timestamp - state->second.first_time;
+  }
+  PaceRecord(recv_time);
+
+  LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(packet_buffer_.data());
+  memset(packet, 0, sizeof(LivoxLidarEthernetPacket));
+  packet->version = header->version;
+  packet->length = static_cast<uint16_t>(packet_size);
+  packet->time_interval = static_cast<uint16_t>(
+      std::min<uint64_t>(point_interval * dot_num / 100, UINT16_MAX));  // unit: 0.1us
+  packet->dot_num = static_cast<uint16_t>(dot_num);
+  packet->udp_cnt = header->udp_counter;
+  packet->frame_cnt = header->frame_counter;
+  packet->data_type = header->data_type;
+  packet->time_type = header->timestamp_type;
+  memcpy(packet->timestamp, header->timestamp, sizeof(packet->timestamp));
+  memcpy(packet->data, data, dot_num * point_size);
+
+  pub_handler().PushEthPacket(handle, dev_type, packet, recv_time);
+  return true;
+}
+
+void LdsReplay::SetLvx2ExtParam(const Lvx2DeviceInfo& info, uint8_t data_type) {
+  UserLivoxLidarConfig config;
+  memset(&config, 0, sizeof(config));
+  config.handle = info.lidar_id;
+  config.pcl_data_type = data_type;
+  config.extrinsic_param.roll = info.roll;
+  config.extrinsic_param.pitch = info.pitch;
+  config.extrinsic_param.yaw = info.yaw;
+  // lvx2 stores the translation in meters, the user config in millimeters
+  config.extrinsic_param.x = static_cast<int32_t>(info.x * 1000);
+  config.extrinsic_param.y = static_cast<int32_t>(info.y * 1000);
+  config.extrinsic_param.z = static_cast<int32_t>(info.z * 1000);
+  LidarExtParameter lidar_param = MakeLidarExtParameter(config);
+  pub_handler().AddLidarsExtParam(lidar_param);
+}
+
+void LdsReplay::PaceRecord(uint64_t recv_time) {
+  if (replay_rate_ <= 0.0) {
+    while (!is_quit_.load() && IsBackpressured()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return;
+  }
+
+  if (!is_paced_) {
+    first_recv_time_ = recv_time;
+    start_time_ = std::chrono::steady_clock::now();
+    is_paced_ = true;
+    return;
+  }
+  if (recv_time <= first_recv_time_) {
+    return;
+  }
+  auto offset = std::chrono::nanoseconds(
+      static_cast<int64_t>((recv_time - first_recv_time_) / replay_rate_));
+  std::this_thread::sleep_until(start_time_ + offset);
+}
+
+bool LdsReplay::IsBackpressured() {
+  if (pub_handler().GetRawPacketQueueSize() > kReplayMaxPendingPackets) {
+    return true;
+  }
+  // keep the frame queues from overflowing, full queues drop frames
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    LidarDataQueue* queue = &lidars_[i].data;
+    if (queue->storage_packet != nullptr && QueueUsedSize(queue) * 2 > queue->size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,114 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Raw packet record and lvx2 file data source, replays packets recorded by the driver or Livox Viewer 2 */
+
+#ifndef LIVOX_ROS_DRIVER_LDS_REPLAY_H_
+#define LIVOX_ROS_DRIVER_LDS_REPLAY_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lds.h"
+#include "comm/comm.h"
+#include "comm/lvx2_file.h"
+
+namespace livox_ros {
+
+/** Per lidar state of a lvx2 replay, packages carry no receive time or point interval */
+typedef struct {
+  uint64_t first_time;  /**< ns, device time of the first package */
+  uint64_t last_time;   /**< ns, device time of the previous package */
+} Lvx2LidarState;
+
+class LdsReplayTest;
+
+class LdsReplay final : public Lds {
+  friend class LdsReplayTest;  /**< test/lds_replay_test.cpp */
+
+ public:
+  static LdsReplay *GetInstance(double publish_freq, uint8_t data_src) {
+    static LdsReplay lds_replay(publish_freq, data_src);
+    return &lds_replay;
+  }
+
+  /**
+   * record_path is a record file or a directory of them, replayed in name order.
+   * Files in lvx2 format are detected by their header.
+   */
+  bool InitLdsReplay(const std::string& record_path, const std::string& user_config_path);
+  int DeInitLdsReplay(void);
+
+  /** 1.0 replays in real time, N at N times speed, 0 as fast as the driver consumes */
+  void SetReplayRate(double replay_rate) { replay_rate_ = replay_rate; }
+
+ private:
+  LdsReplay(double publish_freq, uint8_t data_src);
+  LdsReplay(const LdsReplay &) = delete;
+  ~LdsReplay();
+  LdsReplay &operator=(const LdsReplay &) = delete;
+
+  bool ListRecordFiles(const std::string& record_path);
+  void LoadExtrinsics(const std::string& user_config_path);
+  void SetReplayPubHandle();
+  void RegisterLidar(uint32_t handle);
+
+  void ReplayProcess();
+  bool ReplayFile(const std::string& path);
+  bool ReplayLvx2File(const std::string& path);
+  bool PushLvx2Package(const Lvx2PackageHeader* header, const uint8_t* data);
+  void SetLvx2ExtParam(const Lvx2DeviceInfo& info, uint8_t data_type);
+  void PaceRecord(uint64_t recv_time);
+  bool IsBackpressured();
+
+  virtual void PrepareExit(void);
+
+ private:
+  std::vector<std::string> record_files_;
+  std::set<uint32_t> lidar_handles_;
+  std::map<uint32_t, Lvx2DeviceInfo> lvx2_devices_;       /**< key:lidar id, of the lvx2 file being replayed */
+  std::map<uint32_t, Lvx2LidarState> lvx2_lidar_states_;  /**< key:lidar id */
+  uint64_t lvx2_base_time_;
+  std::vector<uint8_t> packet_buffer_;
+  double replay_rate_;
+  uint64_t packet_count_;
+
+  bool is_paced_;
+  uint64_t first_recv_time_;
+  std::chrono::steady_clock::time_point start_time_;
+
+  std::atomic<bool> is_quit_;
+  std::shared_ptr<std::thread> replay_thread_;
+  volatile bool is_initialized_;
+};
+
+}  // namespace livox_ros
+
+#endif // LIVOX_ROS_DRIVER_LDS_REPLAY_H_
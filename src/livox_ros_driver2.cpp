@@ -22,20 +22,87 @@
 // SOFTWARE.
 //
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <vector>
 #include <csignal>
 #include <thread>
+#include <pthread.h>
 
 #include "include/livox_ros_driver2.h"
 #include "include/ros_headers.h"
 #include "driver_node.h"
 #include "lddc.h"
 #include "lds_lidar.h"
+#include "lds_replay.h"
+#include "comm/pub_handler.h"
+#include "comm/latency_histogram.h"
+#include "comm/startup_timer.h"
 
 using namespace livox_ros;
 
+/** The publish rate is kept within 0.5 and 100 Hz */
+static const double kMinPublishFreq = 0.5;
+static const double kMaxPublishFreq = 100.0;
+
+static double ClampPublishFreq(double publish_freq) {
+  return std::min(std::max(publish_freq, kMinPublishFreq), kMaxPublishFreq);
+}
+
+/** Negative or zero values disable the corresponding streaming limit */
+static StreamingConfig MakeStreamingConfig(int packet_num, int interval_us) {
+  StreamingConfig config;
+  config.packet_num = packet_num > 0 ? static_cast<uint32_t>(packet_num) : 0;
+  config.interval_ns = interval_us > 0 ? static_cast<uint64_t>(interval_us) * 1000 : 0;
+  return config;
+}
+
+/** An empty path disables recording, a non-positive interval disables time based rotation */
+static RecorderConfig MakeRecorderConfig(const std::string& path, int segment_mb, int segment_sec) {
+  RecorderConfig config;
+  config.path = path;
+  config.segment_size = static_cast<uint64_t>(segment_mb > 0 ? segment_mb : 0) * 1024 * 1024;
+  config.segment_interval_ns = segment_sec > 0 ? static_cast<uint64_t>(segment_sec) * kNsPerSecond : 0;
+  return config;
+}
+
+/** An empty path disables the black box, a non-positive window keeps as much as fits */
+static BlackBoxConfig MakeBlackBoxConfig(const std::string& path, int size_mb, int window_sec) {
+  BlackBoxConfig config;
+  config.path = path;
+  config.size = static_cast<uint64_t>(size_mb > 0 ? size_mb : 0) * 1024 * 1024;
+  config.window_ns = window_sec > 0 ? static_cast<uint64_t>(window_sec) * kNsPerSecond : 0;
+  return config;
+}
+
+/** A non-positive period disables diagnostics */
+static DiagnosticsConfig MakeDiagnosticsConfig(double period, double min_frame_rate_ratio, double max_queue_usage,
+                                               int max_raw_queue_size, double max_clock_drift_ppm,
+                                               double max_packet_loss_ratio) {
+  DiagnosticsConfig config;
+  config.period = period > 0.0 ? period : 0.0;
+  config.min_frame_rate_ratio = min_frame_rate_ratio;
+  config.max_queue_usage = max_queue_usage;
+  config.max_raw_queue_size = max_raw_queue_size > 0 ? static_cast<uint32_t>(max_raw_queue_size) : 0;
+  config.max_clock_drift_ppm = max_clock_drift_ppm;
+  config.max_packet_loss_ratio = max_packet_loss_ratio;
+  return config;
+}
+
+/** Zero or a time not longer than the publish interval disables the sliding window */
+static double ClampIntegrationTime(double integration_time) {
+  return std::min(std::max(integration_time, 0.0), kMaxIntegrationTime);
+}
+
+/** Zero disables reordering, packets are decoded in arrival order */
+static uint64_t MakeReorderWindow(int reorder_window_us) {
+  if (reorder_window_us <= 0) {
+    return 0;
+  }
+  return std::min(static_cast<uint64_t>(reorder_window_us) * 1000, kMaxPacketReorderWindow);
+}
+
 #ifdef BUILDING_ROS1
 int main(int argc, char **argv) {
   /** Ros related */
@@ -49,6 +116,7 @@ int main(int argc, char **argv) {
   livox_ros::DriverNode livox_node;
 
   DRIVER_INFO(livox_node, "Livox Ros Driver2 Version: %s", LIVOX_ROS_DRIVER2_VERSION_STRING);
+  StartupTimer::GetInstance().Start();
 
   /** Init default system parameter */
   int xfer_format = kPointCloud2Msg;
@@ -59,6 +127,26 @@ int main(int argc, char **argv) {
   std::string frame_id = "livox_frame";
   bool lidar_bag = true;
   bool imu_bag   = false;
+  int stream_packet_num  = 0;
+  int stream_interval_us = 0;
+  double integration_time = 0.0; /* s */
+  int reorder_window_us = 1000;
+  std::string raw_record_path;
+  int raw_record_segment_mb = 512;
+  int raw_record_segment_sec = 0;
+  std::string blackbox_path;
+  int blackbox_size_mb = 128;
+  int blackbox_sec = 10;
+  bool latency_trace = false;
+  std::string latency_dump_path;
+  double diagnostics_period = 1.0; /* s */
+  double diag_min_frame_rate_ratio = 0.9;
+  double diag_max_queue_usage = 0.5;
+  int diag_max_raw_queue_size = 10000;
+  double diag_max_clock_drift_ppm = 200.0;
+  double diag_max_packet_loss_ratio = 0.001;
+  std::string shm_stats_name;
+  std::string bag_file_path = "livox_ros_driver2.bag";
 
   livox_node.GetNode().getParam("xfer_format", xfer_format);
   livox_node.GetNode().getParam("multi_topic", multi_topic);
@@ -68,16 +156,30 @@ int main(int argc, char **argv) {
   livox_node.GetNode().getParam("frame_id", frame_id);
   livox_node.GetNode().getParam("enable_lidar_bag", lidar_bag);
   livox_node.GetNode().getParam("enable_imu_bag", imu_bag);
+  livox_node.GetNode().getParam("bag_file_path", bag_file_path);
+  livox_node.GetNode().getParam("stream_packet_num", stream_packet_num);
+  livox_node.GetNode().getParam("stream_interval_us", stream_interval_us);
+  livox_node.GetNode().getParam("integration_time", integration_time);
+  livox_node.GetNode().getParam("reorder_window_us", reorder_window_us);
+  livox_node.GetNode().getParam("raw_record_path", raw_record_path);
+  livox_node.GetNode().getParam("raw_record_segment_mb", raw_record_segment_mb);
+  livox_node.GetNode().getParam("raw_record_segment_sec", raw_record_segment_sec);
+  livox_node.GetNode().getParam("blackbox_path", blackbox_path);
+  livox_node.GetNode().getParam("blackbox_size_mb", blackbox_size_mb);
+  livox_node.GetNode().getParam("blackbox_sec", blackbox_sec);
+  livox_node.GetNode().getParam("latency_trace", latency_trace);
+  livox_node.GetNode().getParam("latency_dump_path", latency_dump_path);
+  livox_node.GetNode().getParam("diagnostics_period", diagnostics_period);
+  livox_node.GetNode().getParam("diag_min_frame_rate_ratio", diag_min_frame_rate_ratio);
+  livox_node.GetNode().getParam("diag_max_queue_usage", diag_max_queue_usage);
+  livox_node.GetNode().getParam("diag_max_raw_queue_size", diag_max_raw_queue_size);
+  livox_node.GetNode().getParam("diag_max_clock_drift_ppm", diag_max_clock_drift_ppm);
+  livox_node.GetNode().getParam("diag_max_packet_loss_ratio", diag_max_packet_loss_ratio);
+  livox_node.GetNode().getParam("shm_stats_name", shm_stats_name);
 
   printf("data source:%u.\n", data_src);
 
-  if (publish_freq > 100.0) {
-    publish_freq = 100.0;
-  } else if (publish_freq < 0.5) {
-    publish_freq = 0.5;
-  } else {
-    publish_freq = publish_freq;
-  }
+  publish_freq = ClampPublishFreq(publish_freq);
 
   livox_node.future_ = livox_node.exit_signal_.get_future();
 
@@ -85,6 +187,9 @@ int main(int argc, char **argv) {
   livox_node.lddc_ptr_ = std::make_unique<Lddc>(xfer_format, multi_topic, data_src, output_type,
                         publish_freq, frame_id, lidar_bag, imu_bag);
   livox_node.lddc_ptr_->SetRosNode(&livox_node);
+  if (output_type != kOutputToRos) {
+    livox_node.lddc_ptr_->CreateBagFile(bag_file_path);
+  }
 
   if (data_src == kSourceRawLidar) {
     DRIVER_INFO(livox_node, "Data Source is raw lidar.");
@@ -95,19 +200,79 @@ int main(int argc, char **argv) {
 
     LdsLidar *read_lidar = LdsLidar::GetInstance(publish_freq);
     livox_node.lddc_ptr_->RegisterLds(static_cast<Lds *>(read_lidar));
+    read_lidar->SetStreamingConfig(MakeStreamingConfig(stream_packet_num, stream_interval_us));
+    read_lidar->SetIntegrationTime(ClampIntegrationTime(integration_time));
+    read_lidar->SetReorderWindow(MakeReorderWindow(reorder_window_us));
+    read_lidar->SetRecorderConfig(MakeRecorderConfig(raw_record_path, raw_record_segment_mb,
+                                                     raw_record_segment_sec));
+    read_lidar->SetBlackBoxConfig(MakeBlackBoxConfig(blackbox_path, blackbox_size_mb, blackbox_sec));
 
     if ((read_lidar->InitLdsLidar(user_config_path))) {
       DRIVER_INFO(livox_node, "Init lds lidar successfully!");
     } else {
       DRIVER_ERROR(livox_node, "Init lds lidar failed!");
     }
+  } else if (data_src == kSourceRecordFile || data_src == kSourceLvxFile) {
+    std::string record_file_path;
+    std::string user_config_path;
+    double replay_rate = 1.0;
+    if (data_src == kSourceLvxFile) {
+      DRIVER_INFO(livox_node, "Data Source is lvx2 file.");
+      livox_node.getParam("cmdline_file_path", record_file_path);
+    } else {
+      DRIVER_INFO(livox_node, "Data Source is raw packet record file.");
+      livox_node.getParam("record_file_path", record_file_path);
+      livox_node.getParam("user_config_path", user_config_path);
+    }
+    livox_node.getParam("replay_rate", replay_rate);
+    DRIVER_INFO(livox_node, "Record file : %s, replay rate : %f", record_file_path.c_str(), replay_rate);
+
+    LdsReplay *read_replay = LdsReplay::GetInstance(publish_freq, data_src);
+    livox_node.lddc_ptr_->RegisterLds(static_cast<Lds *>(read_replay));
+    read_replay->SetStreamingConfig(MakeStreamingConfig(stream_packet_num, stream_interval_us));
+    read_replay->SetIntegrationTime(ClampIntegrationTime(integration_time));
+    read_replay->SetReorderWindow(MakeReorderWindow(reorder_window_us));
+    read_replay->SetRecorderConfig(MakeRecorderConfig(raw_record_path, raw_record_segment_mb,
+                                                      raw_record_segment_sec));
+    read_replay->SetBlackBoxConfig(MakeBlackBoxConfig(blackbox_path, blackbox_size_mb, blackbox_sec));
+    read_replay->SetReplayRate(replay_rate);
+
+    if ((read_replay->InitLdsReplay(record_file_path, user_config_path))) {
+      DRIVER_INFO(livox_node, "Init lds replay successfully!");
+    } else {
+      DRIVER_ERROR(livox_node, "Init lds replay failed!");
+    }
   } else {
     DRIVER_ERROR(livox_node, "Invalid data src (%d), please check the launch file", data_src);
   }
 
+  if (!blackbox_path.empty()) {
+    livox_node.blackbox_service_ = livox_node.advertiseService("livox/blackbox_dump",
+                                                               &DriverNode::BlackBoxDumpCallback, &livox_node);
+  }
+  if (latency_trace) {
+    livox_node.EnableLatencyTrace(latency_dump_path);
+  }
+  DiagnosticsConfig diagnostics_config = MakeDiagnosticsConfig(diagnostics_period, diag_min_frame_rate_ratio,
+      diag_max_queue_usage, diag_max_raw_queue_size, diag_max_clock_drift_ppm,
+      diag_max_packet_loss_ratio);
+  if (diagnostics_config.period > 0.0) {
+    livox_node.EnableDiagnostics(diagnostics_config, publish_freq);
+  }
+  if (!shm_stats_name.empty()) {
+    livox_node.stats_exporter_ = std::make_unique<StatsExporter>(livox_node.lddc_ptr_->lds_, publish_freq);
+    if (livox_node.stats_exporter_->Start(shm_stats_name)) {
+      DRIVER_INFO(livox_node, "Statistics are kept in shared memory %s", GetShmStatsPath(shm_stats_name).c_str());
+    }
+  }
+
   livox_node.pointclouddata_poll_thread_ = std::make_shared<std::thread>(&DriverNode::PointCloudDataPollThread, &livox_node);
   livox_node.imudata_poll_thread_ = std::make_shared<std::thread>(&DriverNode::ImuDataPollThread, &livox_node);
-  while (ros::ok()) { usleep(10000); }
+  StartupTimer::GetInstance().MarkStep("node init");
+  while (ros::ok()) {
+    ros::spinOnce();
+    usleep(10000);
+  }
 
   return 0;
 }
@@ -119,6 +284,7 @@ DriverNode::DriverNode(const rclcpp::NodeOptions & node_options)
 : Node("livox_driver_node", node_options)
 {
   DRIVER_INFO(*this, "Livox Ros Driver2 Version: %s", LIVOX_ROS_DRIVER2_VERSION_STRING);
+  StartupTimer::GetInstance().Start();
 
   /** Init default system parameter */
   int xfer_format = kPointCloud2Msg;
@@ -127,6 +293,30 @@ DriverNode::DriverNode(const rclcpp::NodeOptions & node_options)
   double publish_freq = 10.0; /* Hz */
   int output_type = kOutputToRos;
   std::string frame_id;
+  bool lidar_bag = true;
+  bool imu_bag = false;
+  std::string bag_file_path = "livox_ros_driver2_bag";
+  std::string bag_storage_id = "sqlite3";
+  std::string bag_compression;
+  int stream_packet_num = 0;
+  int stream_interval_us = 0;
+  double integration_time = 0.0; /* s */
+  int reorder_window_us = 1000;
+  std::string raw_record_path;
+  int raw_record_segment_mb = 512;
+  int raw_record_segment_sec = 0;
+  std::string blackbox_path;
+  int blackbox_size_mb = 128;
+  int blackbox_sec = 10;
+  bool latency_trace = false;
+  std::string latency_dump_path;
+  double diagnostics_period = 1.0; /* s */
+  double diag_min_frame_rate_ratio = 0.9;
+  double diag_max_queue_usage = 0.5;
+  int diag_max_raw_queue_size = 10000;
+  double diag_max_clock_drift_ppm = 200.0;
+  double diag_max_packet_loss_ratio = 0.001;
+  std::string shm_stats_name;
 
   this->declare_parameter("xfer_format", xfer_format);
   this->declare_parameter("multi_topic", 0);
@@ -137,6 +327,32 @@ DriverNode::DriverNode(const rclcpp::NodeOptions & node_options)
   this->declare_parameter("user_config_path", "path_default");
   this->declare_parameter("cmdline_input_bd_code", "000000000000001");
   this->declare_parameter("lvx_file_path", "/home/livox/livox_test.lvx");
+  this->declare_parameter("enable_lidar_bag", lidar_bag);
+  this->declare_parameter("enable_imu_bag", imu_bag);
+  this->declare_parameter("bag_file_path", bag_file_path);
+  this->declare_parameter("bag_storage_id", bag_storage_id);
+  this->declare_parameter("bag_compression", bag_compression);
+  this->declare_parameter("record_file_path", "");
+  this->declare_parameter("replay_rate", 1.0);
+  this->declare_parameter("stream_packet_num", stream_packet_num);
+  this->declare_parameter("stream_interval_us", stream_interval_us);
+  this->declare_parameter("integration_time", integration_time);
+  this->declare_parameter("reorder_window_us", reorder_window_us);
+  this->declare_parameter("raw_record_path", raw_record_path);
+  this->declare_parameter("raw_record_segment_mb", raw_record_segment_mb);
+  this->declare_parameter("raw_record_segment_sec", raw_record_segment_sec);
+  this->declare_parameter("blackbox_path", blackbox_path);
+  this->declare_parameter("blackbox_size_mb", blackbox_size_mb);
+  this->declare_parameter("blackbox_sec", blackbox_sec);
+  this->declare_parameter("latency_trace", latency_trace);
+  this->declare_parameter("latency_dump_path", latency_dump_path);
+  this->declare_parameter("diagnostics_period", diagnostics_period);
+  this->declare_parameter("diag_min_frame_rate_ratio", diag_min_frame_rate_ratio);
+  this->declare_parameter("diag_max_queue_usage", diag_max_queue_usage);
+  this->declare_parameter("diag_max_raw_queue_size", diag_max_raw_queue_size);
+  this->declare_parameter("diag_max_clock_drift_ppm", diag_max_clock_drift_ppm);
+  this->declare_parameter("diag_max_packet_loss_ratio", diag_max_packet_loss_ratio);
+  this->declare_parameter("shm_stats_name", shm_stats_name);
 
   this->get_parameter("xfer_format", xfer_format);
   this->get_parameter("multi_topic", multi_topic);
@@ -144,20 +360,42 @@ DriverNode::DriverNode(const rclcpp::NodeOptions & node_options)
   this->get_parameter("publish_freq", publish_freq);
   this->get_parameter("output_data_type", output_type);
   this->get_parameter("frame_id", frame_id);
-
-  if (publish_freq > 100.0) {
-    publish_freq = 100.0;
-  } else if (publish_freq < 0.5) {
-    publish_freq = 0.5;
-  } else {
-    publish_freq = publish_freq;
-  }
+  this->get_parameter("enable_lidar_bag", lidar_bag);
+  this->get_parameter("enable_imu_bag", imu_bag);
+  this->get_parameter("bag_file_path", bag_file_path);
+  this->get_parameter("bag_storage_id", bag_storage_id);
+  this->get_parameter("bag_compression", bag_compression);
+  this->get_parameter("stream_packet_num", stream_packet_num);
+  this->get_parameter("stream_interval_us", stream_interval_us);
+  this->get_parameter("integration_time", integration_time);
+  this->get_parameter("reorder_window_us", reorder_window_us);
+  this->get_parameter("raw_record_path", raw_record_path);
+  this->get_parameter("raw_record_segment_mb", raw_record_segment_mb);
+  this->get_parameter("raw_record_segment_sec", raw_record_segment_sec);
+  this->get_parameter("blackbox_path", blackbox_path);
+  this->get_parameter("blackbox_size_mb", blackbox_size_mb);
+  this->get_parameter("blackbox_sec", blackbox_sec);
+  this->get_parameter("latency_trace", latency_trace);
+  this->get_parameter("latency_dump_path", latency_dump_path);
+  this->get_parameter("diagnostics_period", diagnostics_period);
+  this->get_parameter("diag_min_frame_rate_ratio", diag_min_frame_rate_ratio);
+  this->get_parameter("diag_max_queue_usage", diag_max_queue_usage);
+  this->get_parameter("diag_max_raw_queue_size", diag_max_raw_queue_size);
+  this->get_parameter("diag_max_clock_drift_ppm", diag_max_clock_drift_ppm);
+  this->get_parameter("diag_max_packet_loss_ratio", diag_max_packet_loss_ratio);
+  this->get_parameter("shm_stats_name", shm_stats_name);
+
+  publish_freq = ClampPublishFreq(publish_freq);
 
   future_ = exit_signal_.get_future();
 
   /** Lidar data distribute control and lidar data source set */
-  lddc_ptr_ = std::make_unique<Lddc>(xfer_format, multi_topic, data_src, output_type, publish_freq, frame_id);
+  lddc_ptr_ = std::make_unique<Lddc>(xfer_format, multi_topic, data_src, output_type, publish_freq, frame_id,
+                                     lidar_bag, imu_bag);
   lddc_ptr_->SetRosNode(this);
+  if (output_type != kOutputToRos) {
+    lddc_ptr_->CreateBagFile(bag_file_path, bag_storage_id, bag_compression);
+  }
 
   if (data_src == kSourceRawLidar) {
     DRIVER_INFO(*this, "Data Source is raw lidar.");
@@ -171,18 +409,150 @@ DriverNode::DriverNode(const rclcpp::NodeOptions & node_options)
 
     LdsLidar *read_lidar = LdsLidar::GetInstance(publish_freq);
     lddc_ptr_->RegisterLds(static_cast<Lds *>(read_lidar));
+    read_lidar->SetStreamingConfig(MakeStreamingConfig(stream_packet_num, stream_interval_us));
+    read_lidar->SetIntegrationTime(ClampIntegrationTime(integration_time));
+    read_lidar->SetReorderWindow(MakeReorderWindow(reorder_window_us));
+    read_lidar->SetRecorderConfig(MakeRecorderConfig(raw_record_path, raw_record_segment_mb,
+                                                     raw_record_segment_sec));
+    read_lidar->SetBlackBoxConfig(MakeBlackBoxConfig(blackbox_path, blackbox_size_mb, blackbox_sec));
 
     if ((read_lidar->InitLdsLidar(user_config_path))) {
       DRIVER_INFO(*this, "Init lds lidar success!");
     } else {
       DRIVER_ERROR(*this, "Init lds lidar fail!");
     }
+  } else if (data_src == kSourceRecordFile || data_src == kSourceLvxFile) {
+    std::string record_file_path;
+    std::string user_config_path;
+    double replay_rate = 1.0;
+    if (data_src == kSourceLvxFile) {
+      DRIVER_INFO(*this, "Data Source is lvx2 file.");
+      this->get_parameter("lvx_file_path", record_file_path);
+    } else {
+      DRIVER_INFO(*this, "Data Source is raw packet record file.");
+      this->get_parameter("record_file_path", record_file_path);
+      this->get_parameter("user_config_path", user_config_path);
+    }
+    this->get_parameter("replay_rate", replay_rate);
+    DRIVER_INFO(*this, "Record file : %s, replay rate : %f", record_file_path.c_str(), replay_rate);
+
+    LdsReplay *read_replay = LdsReplay::GetInstance(publish_freq, data_src);
+    lddc_ptr_->RegisterLds(static_cast<Lds *>(read_replay));
+    read_replay->SetStreamingConfig(MakeStreamingConfig(stream_packet_num, stream_interval_us));
+    read_replay->SetIntegrationTime(ClampIntegrationTime(integration_time));
+    read_replay->SetReorderWindow(MakeReorderWindow(reorder_window_us));
+    read_replay->SetRecorderConfig(MakeRecorderConfig(raw_record_path, raw_record_segment_mb,
+                                                      raw_record_segment_sec));
+    read_replay->SetBlackBoxConfig(MakeBlackBoxConfig(blackbox_path, blackbox_size_mb, blackbox_sec));
+    read_replay->SetReplayRate(replay_rate);
+
+    if ((read_replay->InitLdsReplay(record_file_path, user_config_path))) {
+      DRIVER_INFO(*this, "Init lds replay success!");
+    } else {
+      DRIVER_ERROR(*this, "Init lds replay fail!");
+    }
   } else {
     DRIVER_ERROR(*this, "Invalid data src (%d), please check the launch file", data_src);
   }
 
+  if (!blackbox_path.empty()) {
+    blackbox_service_ = this->create_service<std_srvs::srv::Trigger>("livox/blackbox_dump",
+        std::bind(&DriverNode::BlackBoxDumpCallback, this, std::placeholders::_1, std::placeholders::_2));
+  }
+  if (latency_trace) {
+    EnableLatencyTrace(latency_dump_path);
+  }
+  DiagnosticsConfig diagnostics_config = MakeDiagnosticsConfig(diagnostics_period, diag_min_frame_rate_ratio,
+      diag_max_queue_usage, diag_max_raw_queue_size, diag_max_clock_drift_ppm,
+      diag_max_packet_loss_ratio);
+  if (diagnostics_config.period > 0.0) {
+    EnableDiagnostics(diagnostics_config, publish_freq);
+  }
+  if (!shm_stats_name.empty()) {
+    stats_exporter_ = std::make_unique<StatsExporter>(lddc_ptr_->lds_, publish_freq);
+    if (stats_exporter_->Start(shm_stats_name)) {
+      DRIVER_INFO(*this, "Statistics are kept in shared memory %s", GetShmStatsPath(shm_stats_name).c_str());
+    }
+  }
+
   pointclouddata_poll_thread_ = std::make_shared<std::thread>(&DriverNode::PointCloudDataPollThread, this);
   imudata_poll_thread_ = std::make_shared<std::thread>(&DriverNode::ImuDataPollThread, this);
+  StartupTimer::GetInstance().MarkStep("node init");
+
+  parameters_callback_ = this->add_on_set_parameters_callback(
+      std::bind(&DriverNode::OnSetParameters, this, std::placeholders::_1));
+}
+
+rcl_interfaces::msg::SetParametersResult DriverNode::OnSetParameters(
+    const std::vector<rclcpp::Parameter>& parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+
+  // the callback runs before the new values are set, parameters not in the request keep theirs
+  double publish_freq = 0.0;
+  bool is_freq_changed = false;
+  int xfer_format = this->get_parameter("xfer_format").as_int();
+  int multi_topic = this->get_parameter("multi_topic").as_int();
+  std::string frame_id = this->get_parameter("frame_id").as_string();
+  int last_xfer_format = xfer_format;
+  bool is_output_changed = false;
+  try {
+    for (const auto& parameter : parameters) {
+      const std::string& name = parameter.get_name();
+      if (name == "publish_freq") {
+        publish_freq = parameter.as_double();
+        is_freq_changed = true;
+      } else if (name == "xfer_format") {
+        xfer_format = parameter.as_int();
+        is_output_changed = true;
+      } else if (name == "multi_topic") {
+        multi_topic = parameter.as_int();
+        is_output_changed = true;
+      } else if (name == "frame_id") {
+        frame_id = parameter.as_string();
+        is_output_changed = true;
+      }
+    }
+  } catch (const rclcpp::ParameterTypeException& e) {
+    result.successful = false;
+    result.reason = e.what();
+    return result;
+  }
+
+  // rejected instead of clamped, the stored parameter stays the applied rate
+  if (is_freq_changed && (publish_freq < kMinPublishFreq || publish_freq > kMaxPublishFreq)) {
+    result.successful = false;
+    result.reason = "publish_freq must be within 0.5 and 100 Hz";
+    return result;
+  }
+  if (is_output_changed) {
+    if (xfer_format != kPointCloud2Msg && xfer_format != kLivoxCustomMsg) {
+      result.successful = false;
+      result.reason = "xfer_format must be 0 (PointCloud2) or 1 (CustomMsg) in ROS2";
+      return result;
+    }
+    if (xfer_format != last_xfer_format && lddc_ptr_->GetOutputType() != kOutputToRos) {
+      result.successful = false;
+      result.reason = "xfer_format can not change while a bag is written";
+      return result;
+    }
+    lddc_ptr_->SetOutputConfig(xfer_format, multi_topic != 0 ? 1 : 0, frame_id);
+    DRIVER_INFO(*this, "Output changed, xfer_format: %d, multi_topic: %d, frame_id: %s",
+                xfer_format, multi_topic, frame_id.c_str());
+  }
+  if (is_freq_changed) {
+    lddc_ptr_->lds_->SetLdsFrequency(publish_freq);
+    pub_handler().SetPointCloudConfig(publish_freq);
+    if (diagnostics_) {
+      diagnostics_->SetPublishFreq(publish_freq);
+    }
+    if (stats_exporter_) {
+      stats_exporter_->SetPublishFreq(publish_freq);
+    }
+    DRIVER_INFO(*this, "Publish frequency changed to %.2f Hz", publish_freq);
+  }
+  return result;
 }
 
 }  // namespace livox_ros
@@ -195,8 +565,8 @@ RCLCPP_COMPONENTS_REGISTER_NODE(livox_ros::DriverNode)
 
 void DriverNode::PointCloudDataPollThread()
 {
+  pthread_setname_np(pthread_self(), "livox_pcd_poll");
   std::future_status status;
-  std::this_thread::sleep_for(std::chrono::seconds(3));
   do {
     lddc_ptr_->DistributePointCloudData();
     status = future_.wait_for(std::chrono::microseconds(0));
@@ -205,14 +575,97 @@ void DriverNode::PointCloudDataPollThread()
 
 void DriverNode::ImuDataPollThread()
 {
+  pthread_setname_np(pthread_self(), "livox_imu_poll");
   std::future_status status;
-  std::this_thread::sleep_for(std::chrono::seconds(3));
   do {
     lddc_ptr_->DistributeImuData();
     status = future_.wait_for(std::chrono::microseconds(0));
   } while (status == std::future_status::timeout);
 }
 
+#ifdef BUILDING_ROS1
+bool DriverNode::BlackBoxDumpCallback(std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res)
+{
+  std::string file_name;
+  res.success = pub_handler().DumpBlackBox(file_name);
+  res.message = res.success ? file_name : "black box is disabled or a dump is in progress";
+  DRIVER_INFO(*this, "Black box dump: %s", res.message.c_str());
+  return true;
+}
+
+void DriverNode::EnableLatencyTrace(const std::string& dump_path)
+{
+  latency_dump_path_ = dump_path;
+  latency_pub_ = advertise<std_msgs::String>("livox/latency", 1);
+  latency_timer_ = createTimer(ros::Duration(1.0), &DriverNode::PublishLatency, this);
+  LatencyTracker::GetInstance().Enable();
+  DRIVER_INFO(*this, "Frame latency is traced and published on livox/latency");
+}
+
+void DriverNode::PublishLatency(const ros::TimerEvent& event)
+{
+  std_msgs::String msg;
+  msg.data = LatencyTracker::GetInstance().ToJson();
+  latency_pub_.publish(msg);
+}
+
+void DriverNode::EnableDiagnostics(const DiagnosticsConfig& config, double publish_freq)
+{
+  diagnostics_.reset(new DriverDiagnostics(config, publish_freq));
+  diagnostics_pub_ = advertise<DiagnosticArray>("/diagnostics", 1);
+  diagnostics_timer_ = createTimer(ros::Duration(config.period), &DriverNode::PublishDiagnostics, this);
+}
+
+void DriverNode::PublishDiagnostics(const ros::TimerEvent& event)
+{
+  DiagnosticArray msg;
+  msg.header.stamp = ros::Time::now();
+  diagnostics_->Update(lddc_ptr_->lds_, msg);
+  diagnostics_pub_.publish(msg);
+}
+#elif defined BUILDING_ROS2
+void DriverNode::BlackBoxDumpCallback(const std::shared_ptr<std_srvs::srv::Trigger::Request> req,
+                                      std::shared_ptr<std_srvs::srv::Trigger::Response> res)
+{
+  std::string file_name;
+  res->success = pub_handler().DumpBlackBox(file_name);
+  res->message = res->success ? file_name : "black box is disabled or a dump is in progress";
+  DRIVER_INFO(*this, "Black box dump: %s", res->message.c_str());
+}
+
+void DriverNode::EnableLatencyTrace(const std::string& dump_path)
+{
+  latency_dump_path_ = dump_path;
+  latency_pub_ = this->create_publisher<std_msgs::msg::String>("livox/latency", 1);
+  latency_timer_ = this->create_wall_timer(std::chrono::seconds(1), std::bind(&DriverNode::PublishLatency, this));
+  LatencyTracker::GetInstance().Enable();
+  DRIVER_INFO(*this, "Frame latency is traced and published on livox/latency");
+}
+
+void DriverNode::PublishLatency()
+{
+  std_msgs::msg::String msg;
+  msg.data = LatencyTracker::GetInstance().ToJson();
+  latency_pub_->publish(msg);
+}
+
+void DriverNode::EnableDiagnostics(const DiagnosticsConfig& config, double publish_freq)
+{
+  diagnostics_.reset(new DriverDiagnostics(config, publish_freq));
+  diagnostics_pub_ = this->create_publisher<DiagnosticArray>("/diagnostics", 1);
+  diagnostics_timer_ = this->create_wall_timer(std::chrono::duration<double>(config.period),
+                                               std::bind(&DriverNode::PublishDiagnostics, this));
+}
+
+void DriverNode::PublishDiagnostics()
+{
+  DiagnosticArray msg;
+  msg.header.stamp = this->now();
+  diagnostics_->Update(lddc_ptr_->lds_, msg);
+  diagnostics_pub_->publish(msg);
+}
+#endif
+
 
 
 
@@ -0,0 +1,225 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "stats_exporter.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "lds.h"
+#include "comm/ldq.h"
+#include "comm/pub_handler.h"
+
+namespace livox_ros {
+
+static_assert(kShmStatsMaxLidars == kMaxSourceLidar, "the shared memory block holds every lidar");
+
+namespace {
+
+uint64_t GetSteadyTimeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** utime + stime of a thread from /proc/self/task/<tid>/stat */
+bool ReadThreadCpuTime(const char* tid, uint64_t& cpu_time_ns) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/task/%s/stat", tid);
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  char stat[512];
+  size_t size = fread(stat, 1, sizeof(stat) - 1, file);
+  fclose(file);
+  stat[size] = '\0';
+
+  /** the command name may contain spaces, the fields after it start at the state */
+  char* fields = strrchr(stat, ')');
+  if (fields == nullptr) {
+    return false;
+  }
+  unsigned long long utime = 0;
+  unsigned long long stime = 0;
+  if (sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime) != 2) {
+    return false;
+  }
+  static const uint64_t kNsPerTick = kNsPerSecond / sysconf(_SC_CLK_TCK);
+  cpu_time_ns = (utime + stime) * kNsPerTick;
+  return true;
+}
+
+void ReadThreadName(const char* tid, char* name, size_t size) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/task/%s/comm", tid);
+  FILE* file = fopen(path, "r");
+  name[0] = '\0';
+  if (file == nullptr) {
+    return;
+  }
+  if (fgets(name, size, file) != nullptr) {
+    name[strcspn(name, "\n")] = '\0';
+  }
+  fclose(file);
+}
+
+}  // namespace
+
+StatsExporter::StatsExporter(Lds* lds, double publish_freq)
+    : lds_(lds),
+      publish_freq_(publish_freq) {}
+
+bool StatsExporter::Start(const std::string& shm_name) {
+  if (!writer_.Open(shm_name)) {
+    return false;
+  }
+  is_quit_.store(false);
+  export_thread_ = std::make_shared<std::thread>(&StatsExporter::ExportProcess, this);
+  return true;
+}
+
+void StatsExporter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_quit_.store(true);
+  }
+  condition_.notify_all();
+  if (export_thread_ && export_thread_->joinable()) {
+    export_thread_->join();
+  }
+  export_thread_.reset();
+  writer_.Close();
+}
+
+void StatsExporter::ExportProcess() {
+  pthread_setname_np(pthread_self(), "livox_stats");
+  uint64_t last_time = GetSteadyTimeNs();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_quit_.load()) {
+    condition_.wait_for(lock, std::chrono::milliseconds(kStatsExportPeriodMs));
+    if (is_quit_.load()) {
+      break;
+    }
+    uint64_t now = GetSteadyTimeNs();
+    Export(static_cast<double>(now - last_time) / kNsPerSecond);
+    last_time = now;
+  }
+}
+
+void StatsExporter::Export(double elapsed) {
+  if (elapsed <= 0.0) {
+    return;
+  }
+  uint32_t raw_queue_depth = pub_handler().GetRawPacketQueueSize();
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  ShmStatsData data;
+  memset(&data, 0, sizeof(data));
+  data.pid = getpid();
+  data.raw_queue_depth = raw_queue_depth;
+  data.update_time_ns = static_cast<uint64_t>(now.tv_sec) * kNsPerSecond + now.tv_nsec;
+  data.publish_freq = publish_freq_.load();
+  ExportLidars(data, elapsed);
+  ExportThreads(data, elapsed);
+  writer_.Write(data);
+}
+
+void StatsExporter::ExportLidars(ShmStatsData& data, double elapsed) {
+  data.lidar_num = 0;
+  if (lds_ == nullptr) {
+    return;
+  }
+  for (uint32_t i = 0; i < kMaxSourceLidar; ++i) {
+    LidarDevice& lidar = lds_->lidars_[i];
+    if (lidar.handle == 0) {
+      continue;
+    }
+    LidarStatistics statistics = {};
+    DriverStatistics::GetInstance().GetLidarSnapshot(lidar.handle, statistics);
+    LidarStatistics& last = last_lidars_[lidar.handle];
+
+    ShmLidarStats& stats = data.lidars[data.lidar_num++];
+    stats.handle = lidar.handle;
+    stats.connect_state = static_cast<uint8_t>(lidar.connect_state);
+    stats.time_type = statistics.time_type;
+    stats.queue_depth = (lidar.data.storage_packet != nullptr) ? QueueUsedSize(&lidar.data) : 0;
+    stats.queue_size = lidar.data.size;
+    stats.imu_queue_depth = static_cast<uint32_t>(lidar.imu_data.Size());
+    stats.packets = statistics.packets;
+    stats.points = statistics.points;
+    stats.imu_packets = statistics.imu_packets;
+    stats.frames = statistics.frames;
+    stats.dropped_frames = statistics.dropped_frames;
+    stats.lost_packets = statistics.lost_packets;
+    stats.reordered_packets = statistics.reordered_packets;
+    stats.packet_gaps = statistics.packet_gaps;
+    stats.packet_rate = (statistics.packets - last.packets) / elapsed;
+    stats.point_rate = (statistics.points - last.points) / elapsed;
+    stats.imu_rate = (statistics.imu_packets - last.imu_packets) / elapsed;
+    stats.frame_rate = (statistics.frames - last.frames) / elapsed;
+    stats.clock_drift_ppm = statistics.clock_drift_ppm;
+    last = statistics;
+  }
+}
+
+void StatsExporter::ExportThreads(ShmStatsData& data, double elapsed) {
+  data.thread_num = 0;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return;
+  }
+  std::map<int32_t, uint64_t> thread_times;
+  struct dirent* entry = nullptr;
+  while ((entry = readdir(dir)) != nullptr && data.thread_num < kShmStatsMaxThreads) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    uint64_t cpu_time_ns = 0;
+    if (!ReadThreadCpuTime(entry->d_name, cpu_time_ns)) {
+      continue;
+    }
+    int32_t tid = atoi(entry->d_name);
+    ShmThreadStats& stats = data.threads[data.thread_num++];
+    stats.tid = tid;
+    ReadThreadName(entry->d_name, stats.name, sizeof(stats.name));
+    stats.cpu_time_ns = cpu_time_ns;
+    auto last = last_thread_times_.find(tid);
+    if (last != last_thread_times_.end() && cpu_time_ns >= last->second) {
+      stats.cpu_usage = (cpu_time_ns - last->second) / (elapsed * kNsPerSecond);
+    }
+    thread_times[tid] = cpu_time_ns;
+  }
+  closedir(dir);
+  last_thread_times_.swap(thread_times);
+}
+
+}  // namespace livox_ros
@@ -0,0 +1,80 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Periodically copies the driver statistics into the shared memory block read by livox_top */
+
+#ifndef LIVOX_ROS_DRIVER2_STATS_EXPORTER_H_
+#define LIVOX_ROS_DRIVER2_STATS_EXPORTER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "comm/driver_statistics.h"
+#include "comm/shm_stats.h"
+
+namespace livox_ros {
+
+/** Update period of the shared memory block */
+const uint64_t kStatsExportPeriodMs = 500;
+
+class Lds;
+
+class StatsExporter {
+ public:
+  StatsExporter(Lds* lds, double publish_freq);
+  ~StatsExporter() { Stop(); }
+  StatsExporter(const StatsExporter &) = delete;
+  StatsExporter &operator=(const StatsExporter &) = delete;
+
+  bool Start(const std::string& shm_name);
+  void Stop();
+  void SetPublishFreq(double publish_freq) { publish_freq_.store(publish_freq); }
+
+ private:
+  void ExportProcess();
+  void Export(double elapsed);
+  void ExportLidars(ShmStatsData& data, double elapsed);
+  void ExportThreads(ShmStatsData& data, double elapsed);
+
+  Lds* lds_;
+  std::atomic<double> publish_freq_;
+  ShmStatsWriter writer_;
+  std::map<uint32_t, LidarStatistics> last_lidars_;
+  std::map<int32_t, uint64_t> last_thread_times_;  /**< cpu time by tid */
+
+  std::atomic<bool> is_quit_{false};
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::shared_ptr<std::thread> export_thread_;
+};
+
+}  // namespace livox_ros
+
+#endif  // LIVOX_ROS_DRIVER2_STATS_EXPORTER_H_
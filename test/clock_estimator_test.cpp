@@ -0,0 +1,83 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "comm/clock_estimator.h"
+
+#include <gtest/gtest.h>
+
+namespace livox_ros {
+namespace {
+
+const uint64_t kMs = 1000000;
+const uint64_t kHostStart = 1000000000000;  /**< the host clock is far ahead of the device clock */
+
+/** Packets every 1ms with a constant 100us transport delay */
+void FeedInOrder(ClockEstimator& estimator, uint64_t device_begin, uint64_t device_end) {
+  for (uint64_t device_time = device_begin; device_time < device_end; device_time += kMs) {
+    estimator.ToHostTime(device_time, kHostStart + device_time + 100000);
+  }
+}
+
+TEST(ClockEstimatorTest, MapsOntoTheLowestDelay) {
+  ClockEstimator estimator;
+  FeedInOrder(estimator, 0, 1000 * kMs);
+  uint64_t host_time = estimator.ToHostTime(1000 * kMs, kHostStart + 1000 * kMs + 300000);
+  EXPECT_NEAR(static_cast<double>(host_time), static_cast<double>(kHostStart + 1000 * kMs + 100000), 1000.0);
+}
+
+TEST(ClockEstimatorTest, KeepsTheOrderOfLatePackets) {
+  ClockEstimator estimator;
+  FeedInOrder(estimator, 0, 1000 * kMs);
+  uint64_t newer = estimator.ToHostTime(1000 * kMs, kHostStart + 1000 * kMs + 100000);
+  // sent 5ms earlier but received after the newer packet
+  uint64_t late = estimator.ToHostTime(995 * kMs, kHostStart + 1000 * kMs + 200000);
+  EXPECT_LT(late, newer);
+  EXPECT_NEAR(static_cast<double>(newer - late), static_cast<double>(5 * kMs), 1000.0);
+
+  uint64_t next = estimator.ToHostTime(1001 * kMs, kHostStart + 1001 * kMs + 100000);
+  EXPECT_GT(next, newer);
+}
+
+TEST(ClockEstimatorTest, RefitDoesNotStepTimeBackwards) {
+  ClockEstimator estimator;
+  FeedInOrder(estimator, 0, 500 * kMs);
+  uint64_t last = 0;
+  // the delay drops by 50us, the model moves to the new lower envelope
+  for (uint64_t device_time = 500 * kMs; device_time < 1500 * kMs; device_time += kMs) {
+    uint64_t host_time = estimator.ToHostTime(device_time, kHostStart + device_time + 50000);
+    EXPECT_GE(host_time, last);
+    last = host_time;
+  }
+}
+
+TEST(ClockEstimatorTest, ResetsOnClockJump) {
+  ClockEstimator estimator;
+  FeedInOrder(estimator, 10000 * kMs, 11000 * kMs);
+  // the device rebooted, its clock restarts near zero
+  uint64_t host_time = estimator.ToHostTime(0, kHostStart + 20000 * kMs);
+  EXPECT_EQ(host_time, kHostStart + 20000 * kMs);
+}
+
+}  // namespace
+}  // namespace livox_ros
@@ -0,0 +1,84 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/deadline_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+namespace livox_ros {
+namespace {
+
+const uint64_t kMs = 1000000;
+
+TEST(DeadlineQueueTest, ExpiresInDeadlineOrder) {
+  DeadlineQueue queue;
+  EXPECT_EQ(queue.GetNextDeadline(), std::numeric_limits<uint64_t>::max());
+  queue.Schedule(1, 30 * kMs);
+  queue.Schedule(2, 10 * kMs);
+  queue.Schedule(3, 20 * kMs);
+  EXPECT_EQ(queue.GetNextDeadline(), 10 * kMs);
+
+  std::vector<uint32_t> expired_ids;
+  queue.Advance(20 * kMs, expired_ids);
+  EXPECT_EQ(expired_ids, (std::vector<uint32_t>{2, 3}));
+  EXPECT_FALSE(queue.IsScheduled(2));
+  EXPECT_TRUE(queue.IsScheduled(1));
+  EXPECT_EQ(queue.GetNextDeadline(), 30 * kMs);
+}
+
+TEST(DeadlineQueueTest, CancelAndReschedule) {
+  DeadlineQueue queue;
+  queue.Schedule(1, 10 * kMs);
+  queue.Schedule(2, 10 * kMs);
+  queue.Cancel(1);
+  queue.Cancel(7);  // not scheduled
+  // only the latest deadline of an id is kept
+  queue.Schedule(2, 40 * kMs);
+
+  std::vector<uint32_t> expired_ids;
+  queue.Advance(30 * kMs, expired_ids);
+  EXPECT_TRUE(expired_ids.empty());
+  EXPECT_EQ(queue.GetNextDeadline(), 40 * kMs);
+  queue.Advance(40 * kMs, expired_ids);
+  EXPECT_EQ(expired_ids, (std::vector<uint32_t>{2}));
+  EXPECT_EQ(queue.GetNextDeadline(), std::numeric_limits<uint64_t>::max());
+}
+
+TEST(DeadlineQueueTest, ClockMayStepBack) {
+  DeadlineQueue queue;
+  std::vector<uint32_t> expired_ids;
+  queue.Advance(1000 * kMs, expired_ids);
+  // a replayed file starting at an earlier time schedules deadlines in the past of the last advance
+  queue.Schedule(1, 20 * kMs);
+  queue.Advance(10 * kMs, expired_ids);
+  EXPECT_TRUE(expired_ids.empty());
+  queue.Advance(20 * kMs, expired_ids);
+  EXPECT_EQ(expired_ids, (std::vector<uint32_t>{1}));
+}
+
+}  // namespace
+}  // namespace livox_ros
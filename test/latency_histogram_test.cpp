@@ -0,0 +1,133 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/latency_histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace livox_ros {
+namespace {
+
+const uint64_t kMaxValue = (1ULL << LatencyHistogram::kMaxValueBits) - 1;
+
+TEST(LatencyHistogramTest, EmptyHistogram) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.GetCount(), 0u);
+  EXPECT_EQ(histogram.GetMax(), 0u);
+  EXPECT_EQ(histogram.GetPercentile(50.0), 0u);
+  EXPECT_EQ(histogram.GetPercentile(100.0), 0u);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (uint64_t value = 0; value < 2 * LatencyHistogram::kSubBucketNum; ++value) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(histogram.GetCount(), 64u);
+  EXPECT_EQ(histogram.GetMax(), 63u);
+  EXPECT_EQ(histogram.GetPercentile(0.0), 0u);
+  EXPECT_EQ(histogram.GetPercentile(25.0), 15u);
+  EXPECT_EQ(histogram.GetPercentile(50.0), 31u);
+  EXPECT_EQ(histogram.GetPercentile(100.0), 63u);
+}
+
+TEST(LatencyHistogramTest, PercentileIsTheBucketUpperBound) {
+  LatencyHistogram histogram;
+  histogram.Record(1000);      // bucket [992, 1007]
+  histogram.Record(1000000);   // bucket [999424, 1015807]
+  histogram.Record(5000000);
+  EXPECT_EQ(histogram.GetPercentile(33.0), 1007u);
+  EXPECT_EQ(histogram.GetPercentile(66.0), 1015807u);
+  // the last bucket is capped at the largest recorded value
+  EXPECT_EQ(histogram.GetPercentile(100.0), 5000000u);
+}
+
+TEST(LatencyHistogramTest, BucketBoundaries) {
+  LatencyHistogram histogram;
+  histogram.Record(992);
+  histogram.Record(1007);
+  histogram.Record(1008);  // first value of the next bucket [1008, 1023]
+  histogram.Record(kMaxValue);
+  EXPECT_EQ(histogram.GetPercentile(25.0), 1007u);
+  EXPECT_EQ(histogram.GetPercentile(50.0), 1007u);
+  EXPECT_EQ(histogram.GetPercentile(75.0), 1023u);
+}
+
+TEST(LatencyHistogramTest, RelativeErrorIsBounded) {
+  LatencyHistogram histogram;
+  for (uint64_t value = 64; value < kMaxValue; value = value * 7 / 5 + 3) {
+    histogram.Reset();
+    histogram.Record(value);
+    histogram.Record(kMaxValue);
+    // the lower of two values keeps the upper bound of its bucket, not the max
+    uint64_t upper = histogram.GetPercentile(50.0);
+    EXPECT_GE(upper, value);
+    EXPECT_LE(upper - value, value / LatencyHistogram::kSubBucketNum) << value;
+  }
+}
+
+TEST(LatencyHistogramTest, LargeValuesAreClamped) {
+  LatencyHistogram histogram;
+  histogram.Record(1ULL << 40);
+  histogram.Record(1ULL << 50);
+  EXPECT_EQ(histogram.GetMax(), 1ULL << 50);
+  EXPECT_EQ(histogram.GetPercentile(50.0), kMaxValue);
+  EXPECT_EQ(histogram.GetPercentile(100.0), kMaxValue);
+}
+
+TEST(LatencyHistogramTest, Reset) {
+  LatencyHistogram histogram;
+  histogram.Record(1000);
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetCount(), 0u);
+  EXPECT_EQ(histogram.GetMax(), 0u);
+  histogram.Record(20);
+  EXPECT_EQ(histogram.GetPercentile(99.0), 20u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecord) {
+  const uint32_t kThreadNum = 4;
+  const uint64_t kRecordNum = 100000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&histogram, i, kRecordNum]() {
+      for (uint64_t value = 0; value < kRecordNum; ++value) {
+        histogram.Record(value * kThreadNum + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.GetCount(), kThreadNum * kRecordNum);
+  EXPECT_EQ(histogram.GetMax(), kThreadNum * kRecordNum - 1);
+}
+
+}  // namespace
+}  // namespace livox_ros
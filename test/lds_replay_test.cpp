@@ -0,0 +1,283 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "lds_replay.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm/packet_recorder.h"
+#include "comm/pub_handler.h"
+
+namespace livox_ros {
+
+const uint64_t kMs = 1000000;
+const uint32_t kDotNum = 96;
+
+/** Replays files through a LdsReplay and counts the points the pub handler publishes */
+class LdsReplayTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char dir[] = "/tmp/livox_replay_test_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    dir_ = dir;
+
+    // every test replays its own lidar on a later timeline of the shared pub handler
+    static uint32_t test_index = 0;
+    ++test_index;
+    handle_ = 0x0a00a8c0 + (test_index << 24);
+    base_time_ = test_index * 100000 * kMs;
+
+    replay_ = LdsReplay::GetInstance(10.0, kSourceRecordFile);
+    replay_->SetReplayRate(0.0);
+    replay_->packet_count_ = 0;
+    points_num_.store(0);
+    pub_handler().SetPointCloudsCallback([this](PointFrame* frame, void*) {
+      for (uint8_t i = 0; i < frame->lidar_num; ++i) {
+        if (frame->lidar_point[i].handle == handle_) {
+          points_num_ += frame->lidar_point[i].points_num;
+        }
+      }
+    }, nullptr);
+    pub_handler().SetReplayClock(true);
+    pub_handler().SetPointCloudConfig(10.0);
+  }
+
+  void TearDown() override {
+    std::string command = "rm -rf " + dir_;
+    ASSERT_EQ(system(command.c_str()), 0);
+  }
+
+  static std::vector<uint8_t> MakePacket(uint16_t udp_cnt, uint64_t timestamp) {
+    std::vector<uint8_t> buffer(sizeof(LivoxLidarEthernetPacket) - 1 +
+                                kDotNum * sizeof(LivoxLidarCartesianHighRawPoint));
+    LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(buffer.data());
+    packet->length = buffer.size();
+    packet->time_interval = 1000 * 10;  // 1ms in 0.1us
+    packet->dot_num = kDotNum;
+    packet->udp_cnt = udp_cnt;
+    packet->data_type = kLivoxLidarCartesianCoordinateHighData;
+    packet->time_type = kTimestampTypeNoSync;
+    memcpy(packet->timestamp, &timestamp, sizeof(timestamp));
+    LivoxLidarCartesianHighRawPoint* points = reinterpret_cast<LivoxLidarCartesianHighRawPoint*>(packet->data);
+    for (uint32_t i = 0; i < kDotNum; ++i) {
+      points[i].x = 1000 + i;
+      points[i].y = 2000;
+      points[i].z = 3000;
+    }
+    return buffer;
+  }
+
+  /** Records packet_num packets 1ms apart, the path of the segment file */
+  std::string Record(uint32_t packet_num) {
+    PacketRecorder recorder;
+    RecorderConfig config{dir_, 0, 0};
+    EXPECT_TRUE(recorder.Start(config));
+    for (uint32_t i = 0; i < packet_num; ++i) {
+      std::vector<uint8_t> packet = MakePacket(i, i * kMs);
+      recorder.Record(handle_, kLivoxLidarTypeMid360, packet.data(), packet.size(), base_time_ + i * kMs);
+    }
+    recorder.Stop();
+    EXPECT_EQ(recorder.GetDroppedCount(), 0u);
+    EXPECT_TRUE(replay_->ListRecordFiles(dir_));
+    EXPECT_EQ(replay_->record_files_.size(), 1u);
+    return replay_->record_files_.empty() ? std::string() : replay_->record_files_.front();
+  }
+
+  static uint32_t GetRecordSize() {
+    uint32_t packet_size = MakePacket(0, 0).size();
+    return (sizeof(RecordHeader) + packet_size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+  }
+
+  /** Overwrite bytes of the packet of the given record */
+  void PatchPacket(const std::string& path, uint32_t record_index, size_t field_offset,
+                   const void* value, size_t size) {
+    int fd = open(path.c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0);
+    off_t offset = sizeof(RecordFileHeader) + record_index * GetRecordSize() + sizeof(RecordHeader) + field_offset;
+    ASSERT_EQ(pwrite(fd, value, size, offset), static_cast<ssize_t>(size));
+    close(fd);
+  }
+
+  bool ReplayFile(const std::string& path) { return replay_->ReplayFile(path); }
+  bool PushLvx2Package(const Lvx2PackageHeader* header, const uint8_t* data) {
+    return replay_->PushLvx2Package(header, data);
+  }
+  uint64_t GetPacketCount() { return replay_->packet_count_; }
+
+  /** Flush the frames left open by the replay, the points published for the test lidar */
+  uint64_t WaitForPoints(uint64_t expected_num) {
+    pub_handler().EndReplay();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (points_num_.load() < expected_num && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));  // nothing more may come
+    return points_num_.load();
+  }
+
+  LdsReplay* replay_ = nullptr;
+  std::string dir_;
+  uint32_t handle_ = 0;
+  uint64_t base_time_ = 0;
+  std::atomic<uint64_t> points_num_{0};
+};
+
+namespace {
+
+TEST_F(LdsReplayTest, RecordedPacketsReplayInFull) {
+  std::string path = Record(250);
+  ASSERT_TRUE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 250u);
+  EXPECT_EQ(WaitForPoints(250 * kDotNum), 250u * kDotNum);
+}
+
+TEST_F(LdsReplayTest, SegmentNotClosedEndsAtTheFirstEmptyRecord) {
+  std::string path = Record(20);
+  // a segment of a crashed driver: preallocated, zero filled and without its data size
+  int fd = open(path.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  uint64_t data_size = 0;
+  ASSERT_EQ(pwrite(fd, &data_size, sizeof(data_size), offsetof(RecordFileHeader, data_size)),
+            static_cast<ssize_t>(sizeof(data_size)));
+  ASSERT_EQ(ftruncate(fd, sizeof(RecordFileHeader) + 40 * GetRecordSize()), 0);
+  close(fd);
+
+  ASSERT_TRUE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 20u);
+  EXPECT_EQ(WaitForPoints(20 * kDotNum), 20u * kDotNum);
+}
+
+TEST_F(LdsReplayTest, TruncatedRecordEndsTheFile) {
+  std::string path = Record(20);
+  // the header of the last record is complete, its packet is cut
+  ASSERT_EQ(truncate(path.c_str(), sizeof(RecordFileHeader) + 19 * GetRecordSize() + sizeof(RecordHeader) + 10), 0);
+  EXPECT_FALSE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 19u);
+}
+
+TEST_F(LdsReplayTest, PacketLengthBeyondTheRecordEndsTheFile) {
+  std::string path = Record(20);
+  uint16_t length = MakePacket(0, 0).size() + 1;
+  PatchPacket(path, 5, offsetof(LivoxLidarEthernetPacket, length), &length, sizeof(length));
+  EXPECT_FALSE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 5u);
+}
+
+TEST_F(LdsReplayTest, PacketLengthBelowItsHeaderEndsTheFile) {
+  std::string path = Record(20);
+  uint16_t length = 8;
+  PatchPacket(path, 7, offsetof(LivoxLidarEthernetPacket, length), &length, sizeof(length));
+  EXPECT_FALSE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 7u);
+}
+
+TEST_F(LdsReplayTest, PointCountBeyondThePacketEndsTheFile) {
+  std::string path = Record(20);
+  uint16_t dot_num = kDotNum + 1;
+  PatchPacket(path, 0, offsetof(LivoxLidarEthernetPacket, dot_num), &dot_num, sizeof(dot_num));
+  EXPECT_FALSE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 0u);
+}
+
+TEST_F(LdsReplayTest, Lvx2PackagesReplayAsPackets) {
+  std::vector<uint8_t> file;
+  auto append = [&file](const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    file.insert(file.end(), bytes, bytes + size);
+  };
+  Lvx2PublicHeader public_header = {};
+  strncpy(public_header.signature, "livox_tech", sizeof(public_header.signature));
+  public_header.version[0] = 2;
+  public_header.magic_code = kLvx2MagicCode;
+  append(&public_header, sizeof(public_header));
+  Lvx2PrivateHeader private_header = {50, 1};
+  append(&private_header, sizeof(private_header));
+  Lvx2DeviceInfo device = {};
+  device.lidar_id = handle_;
+  device.device_type = kLivoxLidarTypeMid360;
+  append(&device, sizeof(device));
+
+  Lvx2FrameHeader frame_header = {file.size(), 0, 0};
+  size_t frame_offset = file.size();
+  append(&frame_header, sizeof(frame_header));
+  std::vector<LivoxLidarCartesianHighRawPoint> points(kDotNum);
+  for (uint32_t i = 0; i < 3; ++i) {
+    Lvx2PackageHeader package = {};
+    package.lidar_id = handle_;
+    package.udp_counter = i;
+    package.data_type = kLivoxLidarCartesianCoordinateHighData;
+    package.length = points.size() * sizeof(LivoxLidarCartesianHighRawPoint);
+    uint64_t timestamp = base_time_ + i * kMs;
+    memcpy(package.timestamp, &timestamp, sizeof(timestamp));
+    append(&package, sizeof(package));
+    append(points.data(), package.length);
+  }
+  // lvx2 files carry no imu data, such a package is skipped
+  Lvx2PackageHeader imu_package = {};
+  imu_package.lidar_id = handle_;
+  imu_package.data_type = kLivoxLidarImuData;
+  imu_package.length = sizeof(LivoxLidarImuRawPoint);
+  LivoxLidarImuRawPoint imu_point = {};
+  append(&imu_package, sizeof(imu_package));
+  append(&imu_point, sizeof(imu_point));
+  reinterpret_cast<Lvx2FrameHeader*>(file.data() + frame_offset)->next_offset = file.size();
+
+  std::string path = dir_ + "/test.lvx2";
+  FILE* stream = fopen(path.c_str(), "wb");
+  ASSERT_NE(stream, nullptr);
+  ASSERT_EQ(fwrite(file.data(), 1, file.size(), stream), file.size());
+  fclose(stream);
+
+  ASSERT_TRUE(ReplayFile(path));
+  EXPECT_EQ(GetPacketCount(), 3u);
+  EXPECT_EQ(WaitForPoints(3 * kDotNum), 3u * kDotNum);
+}
+
+TEST_F(LdsReplayTest, Lvx2PackageTooShortForAPointIsSkipped) {
+  Lvx2PackageHeader header = {};
+  header.lidar_id = handle_;
+  header.data_type = kLivoxLidarCartesianCoordinateHighData;
+  header.length = sizeof(LivoxLidarCartesianHighRawPoint) - 1;
+  uint8_t data[sizeof(LivoxLidarCartesianHighRawPoint)] = {};
+  EXPECT_FALSE(PushLvx2Package(&header, data));
+  header.data_type = 0xff;  // unknown
+  header.length = sizeof(data);
+  EXPECT_FALSE(PushLvx2Package(&header, data));
+}
+
+}  // namespace
+}  // namespace livox_ros
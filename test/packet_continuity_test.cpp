@@ -0,0 +1,106 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/packet_continuity.h"
+
+#include <gtest/gtest.h>
+
+#include "comm/comm.h"
+
+namespace livox_ros {
+namespace {
+
+const uint64_t kPacketInterval = 100000;  /**< 0.1ms between point cloud packets */
+
+/** Feeds count packets from udp_cnt on, returns the sum of the lost packets */
+uint32_t FeedInOrder(PacketContinuity& continuity, uint16_t udp_cnt, uint32_t count, uint64_t& time_stamp) {
+  uint32_t lost = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    PacketContinuityResult result = continuity.Update(static_cast<uint16_t>(udp_cnt + i), time_stamp,
+                                                      kTimestampTypeGptpOrPtp);
+    lost += result.lost;
+    EXPECT_FALSE(result.is_reordered);
+    EXPECT_FALSE(result.is_gap);
+    time_stamp += kPacketInterval;
+  }
+  return lost;
+}
+
+TEST(PacketContinuityTest, CounterWrapIsNotALoss) {
+  PacketContinuity continuity;
+  uint64_t time_stamp = 0;
+  EXPECT_EQ(FeedInOrder(continuity, 0xFFF0, 0x20, time_stamp), 0u);
+}
+
+TEST(PacketContinuityTest, CountsHolesAcrossTheWrap) {
+  PacketContinuity continuity;
+  continuity.Update(0xFFFE, 0, kTimestampTypeGptpOrPtp);
+  PacketContinuityResult result = continuity.Update(0x0001, 3 * kPacketInterval, kTimestampTypeGptpOrPtp);
+  EXPECT_EQ(result.lost, 2u);
+  EXPECT_FALSE(result.is_reordered);
+}
+
+TEST(PacketContinuityTest, LatePacketFillsAHole) {
+  PacketContinuity continuity;
+  continuity.Update(10, 0, kTimestampTypeGptpOrPtp);
+  EXPECT_EQ(continuity.Update(12, 2 * kPacketInterval, kTimestampTypeGptpOrPtp).lost, 1u);
+  PacketContinuityResult result = continuity.Update(11, kPacketInterval, kTimestampTypeGptpOrPtp);
+  EXPECT_TRUE(result.is_reordered);
+  EXPECT_EQ(result.lost, 0u);
+  // the hole is filled, a duplicate of it restarts the counter instead
+  result = continuity.Update(11, kPacketInterval, kTimestampTypeGptpOrPtp);
+  EXPECT_FALSE(result.is_reordered);
+}
+
+TEST(PacketContinuityTest, DetectsARestartedLidar) {
+  PacketContinuity continuity;
+  uint64_t time_stamp = 0;
+  FeedInOrder(continuity, 1000, 10, time_stamp);
+  // far behind the counter, no hole to fill
+  PacketContinuityResult result = continuity.Update(0, time_stamp, kTimestampTypeGptpOrPtp);
+  EXPECT_EQ(result.lost, 0u);
+  EXPECT_FALSE(result.is_reordered);
+  time_stamp += kPacketInterval;
+  EXPECT_EQ(FeedInOrder(continuity, 1, 10, time_stamp), 0u);
+}
+
+TEST(PacketContinuityTest, DetectsATimeGap) {
+  PacketContinuity continuity;
+  continuity.Update(0, 0, kTimestampTypeGptpOrPtp);
+  PacketContinuityResult result = continuity.Update(1, kMaxPacketTimeGap + 1, kTimestampTypeGptpOrPtp);
+  EXPECT_TRUE(result.is_gap);
+  EXPECT_EQ(result.lost, 0u);
+}
+
+TEST(PacketContinuityTest, NewTimeTypeIsNotAGap) {
+  PacketContinuity continuity;
+  continuity.Update(0, 0, kTimestampTypeNoSync);
+  PacketContinuityResult result = continuity.Update(1, 1000000000000, kTimestampTypeGptpOrPtp);
+  EXPECT_FALSE(result.is_gap);
+  EXPECT_EQ(result.lost, 0u);
+}
+
+}  // namespace
+}  // namespace livox_ros
@@ -0,0 +1,116 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/packet_reorder_buffer.h"
+
+#include <gtest/gtest.h>
+
+namespace livox_ros {
+namespace {
+
+const uint64_t kMs = 1000000;
+
+RawPacket MakePacket(uint64_t time_stamp, uint8_t time_type = kTimestampTypeGptpOrPtp) {
+  RawPacket packet{};
+  packet.time_stamp = time_stamp;
+  packet.time_type = time_type;
+  return packet;
+}
+
+TEST(PacketReorderBufferTest, ReleasesInPacketTimeOrder) {
+  PacketReorderBuffer buffer;
+  buffer.SetWindow(2 * kMs);
+  EXPECT_TRUE(buffer.Push(MakePacket(100 * kMs), 0));
+  EXPECT_TRUE(buffer.Push(MakePacket(102 * kMs), 0));
+  // overtaken on the network, still inside the window
+  EXPECT_TRUE(buffer.Push(MakePacket(101 * kMs), 0));
+
+  RawPacket packet;
+  ASSERT_TRUE(buffer.Pop(packet, 0, false));
+  EXPECT_EQ(packet.time_stamp, 100 * kMs);
+  // the window after 101ms is not filled yet and it did not wait long enough
+  EXPECT_FALSE(buffer.Pop(packet, 1 * kMs, false));
+  ASSERT_TRUE(buffer.Pop(packet, 2 * kMs, false));
+  EXPECT_EQ(packet.time_stamp, 101 * kMs);
+  ASSERT_TRUE(buffer.Pop(packet, 2 * kMs, true));
+  EXPECT_EQ(packet.time_stamp, 102 * kMs);
+  EXPECT_TRUE(buffer.IsEmpty());
+}
+
+TEST(PacketReorderBufferTest, ZeroWindowPassesThrough) {
+  PacketReorderBuffer buffer;
+  EXPECT_TRUE(buffer.Push(MakePacket(100 * kMs), 0));
+  RawPacket packet;
+  ASSERT_TRUE(buffer.Pop(packet, 0, false));
+  EXPECT_EQ(packet.time_stamp, 100 * kMs);
+}
+
+TEST(PacketReorderBufferTest, DropsPacketsOlderThanTheReleasedOnes) {
+  PacketReorderBuffer buffer;
+  buffer.SetWindow(1 * kMs);
+  buffer.Push(MakePacket(100 * kMs), 0);
+  buffer.Push(MakePacket(101 * kMs), 0);
+  RawPacket packet;
+  ASSERT_TRUE(buffer.Pop(packet, 0, false));
+  EXPECT_FALSE(buffer.Push(MakePacket(99 * kMs), 0));
+  EXPECT_FALSE(buffer.IsClockChanged(MakePacket(99 * kMs)));
+}
+
+TEST(PacketReorderBufferTest, DetectsAClockSteppedBack) {
+  PacketReorderBuffer buffer;
+  buffer.SetWindow(1 * kMs);
+  EXPECT_FALSE(buffer.IsClockChanged(MakePacket(100 * kMs)));
+  buffer.Push(MakePacket(100 * kMs), 0);
+  RawPacket packet;
+  ASSERT_TRUE(buffer.Pop(packet, 0, true));
+
+  RawPacket stepped = MakePacket(100 * kMs - kPacketReorderMaxStep - 1);
+  EXPECT_TRUE(buffer.IsClockChanged(stepped));
+  EXPECT_FALSE(buffer.Push(MakePacket(stepped.time_stamp), 0));
+  buffer.Reset();
+  EXPECT_TRUE(buffer.Push(std::move(stepped), 0));
+}
+
+TEST(PacketReorderBufferTest, DetectsAChangedTimeType) {
+  PacketReorderBuffer buffer;
+  buffer.Push(MakePacket(100 * kMs), 0);
+  EXPECT_TRUE(buffer.IsClockChanged(MakePacket(101 * kMs, kTimestampTypeNoSync)));
+  EXPECT_FALSE(buffer.IsClockChanged(MakePacket(101 * kMs)));
+}
+
+TEST(PacketReorderBufferTest, ReleasesWhenFull) {
+  PacketReorderBuffer buffer;
+  buffer.SetWindow(1000 * kMs);
+  for (uint32_t i = 0; i <= kMaxPacketReorderNum; ++i) {
+    buffer.Push(MakePacket(100 * kMs + i), 0);
+  }
+  RawPacket packet;
+  ASSERT_TRUE(buffer.Pop(packet, 0, false));
+  EXPECT_EQ(packet.time_stamp, 100 * kMs);
+  EXPECT_FALSE(buffer.Pop(packet, 0, false));
+}
+
+}  // namespace
+}  // namespace livox_ros
@@ -0,0 +1,131 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/retry_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace livox_ros {
+namespace {
+
+uint32_t PopAllDue(RetryScheduler& scheduler, uint64_t now_time) {
+  uint32_t count = 0;
+  RetryScheduler::Task task;
+  while (scheduler.PopDue(now_time, task)) {
+    task();
+    ++count;
+  }
+  return count;
+}
+
+TEST(RetrySchedulerTest, RetriesAreDueWithinTheJitterBounds) {
+  struct {
+    uint32_t attempt;
+    uint64_t min_delay;  // 25% jitter around 100ms doubling per attempt, capped at 5s
+    uint64_t max_delay;
+  } cases[] = {
+    {0, 75000000, 125000000},
+    {1, 150000000, 250000000},
+    {3, 600000000, 1000000000},
+    {6, 3750000000, 6250000000},
+    {9, 3750000000, 6250000000},
+  };
+  const uint64_t kKeyNum = 100;
+  const uint64_t kNow = 1000000000000;
+  for (const auto& expected : cases) {
+    RetryScheduler scheduler;  // not started, the test takes the due retries itself
+    for (uint64_t key = 0; key < kKeyNum; ++key) {
+      for (uint32_t attempt = 0; attempt < expected.attempt; ++attempt) {
+        ASSERT_TRUE(scheduler.Schedule(key, 0, [] {}));
+      }
+    }
+    PopAllDue(scheduler, kNow);
+
+    uint32_t run_count = 0;
+    for (uint64_t key = 0; key < kKeyNum; ++key) {
+      ASSERT_TRUE(scheduler.Schedule(key, kNow, [&run_count] { ++run_count; }));
+    }
+    EXPECT_EQ(PopAllDue(scheduler, kNow + expected.min_delay - 1), 0u) << "attempt " << expected.attempt;
+    // the retries of lidars failing together are spread over the jitter range
+    uint32_t early_count = PopAllDue(scheduler, kNow + (expected.min_delay + expected.max_delay) / 2);
+    EXPECT_GT(early_count, 0u) << "attempt " << expected.attempt;
+    EXPECT_LT(early_count, kKeyNum) << "attempt " << expected.attempt;
+    PopAllDue(scheduler, kNow + expected.max_delay);
+    EXPECT_EQ(run_count, kKeyNum) << "attempt " << expected.attempt;
+  }
+}
+
+TEST(RetrySchedulerTest, PopsTheEarliestRetryFirst) {
+  RetryScheduler scheduler;
+  std::vector<int> order;
+  ASSERT_TRUE(scheduler.Schedule(1, 2000000000, [&order] { order.push_back(1); }));
+  ASSERT_TRUE(scheduler.Schedule(2, 0, [&order] { order.push_back(2); }));
+  EXPECT_EQ(PopAllDue(scheduler, 3000000000), 2u);
+  EXPECT_EQ(order, (std::vector<int>{2, 1}));
+}
+
+TEST(RetrySchedulerTest, GivesUpAfterTheMaxAttempts) {
+  RetryScheduler scheduler;  // not started, the retries only queue up
+  for (uint32_t attempt = 0; attempt < kRetryMaxAttempts; ++attempt) {
+    EXPECT_TRUE(scheduler.Retry(1, [] {}));
+  }
+  EXPECT_FALSE(scheduler.Retry(1, [] {}));
+  // other keys back off on their own
+  EXPECT_TRUE(scheduler.Retry(2, [] {}));
+  scheduler.Reset(1);
+  EXPECT_TRUE(scheduler.Retry(1, [] {}));
+}
+
+TEST(RetrySchedulerTest, RunsTheTaskAfterTheBackoff) {
+  RetryScheduler scheduler;
+  scheduler.Start();
+  std::promise<void> done;
+  auto begin = std::chrono::steady_clock::now();
+  ASSERT_TRUE(scheduler.Retry(1, [&done] { done.set_value(); }));
+  ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+  EXPECT_GE(static_cast<uint64_t>(elapsed.count()), kRetryInitialDelay * (100 - kRetryJitterPercent) / 100);
+}
+
+TEST(RetrySchedulerTest, StopDropsPendingRetries) {
+  RetryScheduler scheduler;
+  scheduler.Start();
+  std::atomic<bool> has_run{false};
+  ASSERT_TRUE(scheduler.Retry(1, [&has_run] { has_run = true; }));
+  scheduler.Stop();
+  EXPECT_FALSE(has_run);
+  EXPECT_FALSE(scheduler.Retry(1, [] {}));
+  // a restart begins with fresh attempts
+  scheduler.Start();
+  EXPECT_TRUE(scheduler.Retry(1, [] {}));
+}
+
+}  // namespace
+}  // namespace livox_ros
@@ -0,0 +1,194 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/shm_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace livox_ros {
+namespace {
+
+/** Unique per process, ctest may run the cases of several builds at once */
+std::string GetTestName(const char* test) {
+  return "livox_shm_stats_test_" + std::to_string(getpid()) + "_" + test;
+}
+
+/** The block as a second writer sees it, to corrupt the header */
+ShmStatsBlock* MapBlock(const std::string& name) {
+  int fd = shm_open(GetShmStatsPath(name).c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  void* addr = mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  return addr == MAP_FAILED ? nullptr : static_cast<ShmStatsBlock*>(addr);
+}
+
+/** Every counter of a generation holds the same value, a torn read mixes two of them */
+void FillData(uint64_t generation, ShmStatsData& data) {
+  memset(&data, 0, sizeof(data));
+  data.update_time_ns = generation;
+  data.lidar_num = kShmStatsMaxLidars;
+  for (uint32_t i = 0; i < kShmStatsMaxLidars; ++i) {
+    data.lidars[i].handle = i;
+    data.lidars[i].packets = generation;
+    data.lidars[i].points = generation;
+    data.lidars[i].frames = generation;
+  }
+}
+
+TEST(ShmStatsTest, GetShmStatsPath) {
+  EXPECT_EQ(GetShmStatsPath("livox_stats"), "/livox_stats");
+  EXPECT_EQ(GetShmStatsPath("/livox_stats"), "/livox_stats");
+}
+
+TEST(ShmStatsTest, ReadWhatWasWritten) {
+  std::string name = GetTestName("read");
+  ShmStatsWriter writer;
+  ASSERT_TRUE(writer.Open(name));
+  ShmStatsReader reader;
+  ASSERT_TRUE(reader.Open(name));
+
+  // a freshly opened block reads as zeros
+  ShmStatsData data;
+  memset(&data, 0xff, sizeof(data));
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ(data.lidar_num, 0u);
+  EXPECT_EQ(data.update_time_ns, 0u);
+
+  ShmStatsData written;
+  FillData(7, written);
+  written.pid = 1234;
+  written.lidars[3].packet_rate = 1000.5;
+  writer.Write(written);
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ(memcmp(&data, &written, sizeof(data)), 0);
+}
+
+TEST(ShmStatsTest, OpenFailures) {
+  std::string name = GetTestName("open");
+  ShmStatsReader reader;
+  EXPECT_FALSE(reader.Open(name));
+  ShmStatsData data;
+  EXPECT_FALSE(reader.Read(data));
+
+  ShmStatsWriter writer;
+  ASSERT_TRUE(writer.Open(name));
+  ShmStatsBlock* block = MapBlock(name);
+  ASSERT_NE(block, nullptr);
+  block->version = kShmStatsVersion + 1;
+  EXPECT_FALSE(reader.Open(name));
+  block->version = kShmStatsVersion;
+  EXPECT_TRUE(reader.Open(name));
+  munmap(block, sizeof(ShmStatsBlock));
+
+  // the writer unlinks the object, new readers no longer find it
+  writer.Close();
+  ShmStatsReader late_reader;
+  EXPECT_FALSE(late_reader.Open(name));
+}
+
+TEST(ShmStatsTest, ReaderGivesUpOnBusyWriter) {
+  std::string name = GetTestName("busy");
+  ShmStatsWriter writer;
+  ASSERT_TRUE(writer.Open(name));
+  ShmStatsReader reader;
+  ASSERT_TRUE(reader.Open(name));
+  ShmStatsBlock* block = MapBlock(name);
+  ASSERT_NE(block, nullptr);
+
+  // an odd sequence is a write in progress, e.g. of a writer that died in the middle of it
+  uint32_t sequence = block->sequence.load();
+  block->sequence.store(sequence + 1);
+  ShmStatsData data;
+  EXPECT_FALSE(reader.Read(data));
+  block->sequence.store(sequence + 2);
+  EXPECT_TRUE(reader.Read(data));
+  munmap(block, sizeof(ShmStatsBlock));
+}
+
+TEST(ShmStatsTest, ConcurrentReadsAreConsistent) {
+  std::string name = GetTestName("concurrent");
+  ShmStatsWriter writer;
+  ASSERT_TRUE(writer.Open(name));
+  ShmStatsReader reader;
+  ASSERT_TRUE(reader.Open(name));
+
+  // the writer keeps updating until the reader has seen enough of its generations
+  const uint64_t kReadNum = 20000;
+  std::atomic<bool> is_done{false};
+  std::atomic<uint64_t> last_written{0};
+  std::thread writer_thread([&writer, &is_done, &last_written]() {
+    std::unique_ptr<ShmStatsData> data(new ShmStatsData);
+    for (uint64_t generation = 1; !is_done.load(); ++generation) {
+      FillData(generation, *data);
+      writer.Write(*data);
+      last_written.store(generation);
+    }
+  });
+
+  // asserting here would leave the writer thread running, inconsistencies are counted instead
+  std::unique_ptr<ShmStatsData> data(new ShmStatsData);
+  uint64_t torn_num = 0;
+  uint64_t last_generation = 0;
+  for (uint64_t read_num = 0; read_num < kReadNum;) {
+    if (!reader.Read(*data)) {
+      continue;
+    }
+    // reads before the first write do not count
+    uint64_t generation = data->update_time_ns;
+    if (generation == 0) {
+      continue;
+    }
+    ++read_num;
+    // generations never go back, and all counters belong to the same one
+    bool is_consistent = generation >= last_generation && data->lidar_num == kShmStatsMaxLidars;
+    last_generation = generation;
+    for (uint32_t i = 0; i < kShmStatsMaxLidars; ++i) {
+      is_consistent = is_consistent && data->lidars[i].packets == generation &&
+          data->lidars[i].points == generation && data->lidars[i].frames == generation;
+    }
+    if (!is_consistent) {
+      ++torn_num;
+    }
+  }
+  is_done.store(true);
+  writer_thread.join();
+  EXPECT_EQ(torn_num, 0u);
+  ASSERT_TRUE(reader.Read(*data));
+  EXPECT_EQ(data->update_time_ns, last_written.load());
+}
+
+}  // namespace
+}  // namespace livox_ros
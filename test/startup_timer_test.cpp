@@ -0,0 +1,162 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "comm/startup_timer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace livox_ros {
+
+/** Sees the phase accounting of the singleton, every case starts it over */
+class StartupTimerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { timer_.Start(); }
+
+  uint32_t GetMask(uint32_t handle) {
+    std::lock_guard<std::mutex> lock(timer_.mutex_);
+    auto it = timer_.masks_.find(handle);
+    return (it != timer_.masks_.end()) ? it->second : 0;
+  }
+
+  uint64_t GetPhaseTime(uint32_t handle) {
+    std::lock_guard<std::mutex> lock(timer_.mutex_);
+    auto it = timer_.phases_.find(handle);
+    return (it != timer_.phases_.end()) ? it->second : 0;
+  }
+
+  uint64_t GetStartTime() { return timer_.start_time_; }
+  uint64_t GetStepTime() { return timer_.step_time_; }
+
+  StartupTimer& timer_ = StartupTimer::GetInstance();
+};
+
+namespace {
+
+const uint32_t kHandle = 0x6401A8C0;  // 192.168.1.100
+const uint32_t kOtherHandle = 0x6501A8C0;
+
+uint32_t CountLines(const std::string& output, const std::string& text) {
+  uint32_t count = 0;
+  for (size_t pos = output.find(text); pos != std::string::npos; pos = output.find(text, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+TEST_F(StartupTimerTest, OnlyTheFirstMarkOfAPhaseCounts) {
+  testing::internal::CaptureStdout();
+  timer_.Mark(kHandle, kStartupDiscovered);
+  uint64_t discovered_time = GetPhaseTime(kHandle);
+  timer_.Mark(kHandle, kStartupDiscovered);
+  std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(CountLines(output, "192.168.1.100 discovered"), 1u);
+  EXPECT_EQ(GetMask(kHandle), 1u << kStartupDiscovered);
+  // the repeated mark keeps the time of the first one
+  EXPECT_GE(discovered_time, GetStepTime());
+  EXPECT_EQ(GetPhaseTime(kHandle), discovered_time);
+}
+
+TEST_F(StartupTimerTest, PhasesAreAccountedPerLidar) {
+  testing::internal::CaptureStdout();
+  timer_.Mark(kHandle, kStartupDiscovered);
+  timer_.Mark(kHandle, kStartupConfigured);
+  uint64_t configured_time = GetPhaseTime(kHandle);
+  timer_.Mark(kOtherHandle, kStartupDiscovered);
+  timer_.Mark(kHandle, kStartupFirstPoint);
+  timer_.Mark(kHandle, kStartupConfigured);
+  std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(GetMask(kHandle),
+            (1u << kStartupDiscovered) | (1u << kStartupConfigured) | (1u << kStartupFirstPoint));
+  EXPECT_EQ(GetMask(kOtherHandle), 1u << kStartupDiscovered);
+  // phases may be skipped, a replayed lidar is never discovered
+  EXPECT_EQ(GetMask(0), 0u);
+  EXPECT_GE(GetPhaseTime(kHandle), configured_time);
+  EXPECT_EQ(CountLines(output, "Startup: lidar"), 4u);
+  EXPECT_EQ(CountLines(output, "192.168.1.101 discovered"), 1u);
+  EXPECT_EQ(CountLines(output, "192.168.1.100 configured"), 1u);
+}
+
+TEST_F(StartupTimerTest, StartForgetsReachedPhases) {
+  testing::internal::CaptureStdout();
+  timer_.Mark(kHandle, kStartupFirstPublish);
+  uint64_t first_start_time = GetStartTime();
+  timer_.Start();
+  EXPECT_EQ(GetMask(kHandle), 0u);
+  EXPECT_EQ(GetPhaseTime(kHandle), 0u);
+  EXPECT_GE(GetStartTime(), first_start_time);
+
+  // a restarted driver logs the phases again
+  timer_.Mark(kHandle, kStartupFirstPublish);
+  std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(CountLines(output, "192.168.1.100 first publish"), 2u);
+  EXPECT_EQ(GetMask(kHandle), 1u << kStartupFirstPublish);
+}
+
+TEST_F(StartupTimerTest, MarkStepMovesTheStepTime) {
+  testing::internal::CaptureStdout();
+  uint64_t start_time = GetStartTime();
+  EXPECT_EQ(GetStepTime(), start_time);
+  timer_.MarkStep("sdk init");
+  uint64_t step_time = GetStepTime();
+  std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(CountLines(output, "Startup: sdk init took"), 1u);
+  EXPECT_GE(step_time, start_time);
+  EXPECT_EQ(GetStartTime(), start_time);
+}
+
+TEST_F(StartupTimerTest, ConcurrentMarksCountOnce) {
+  const uint32_t kThreadNum = 8;
+  const uint32_t kLidarNum = 16;
+  testing::internal::CaptureStdout();
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([this, kLidarNum]() {
+      for (uint32_t handle = 1; handle <= kLidarNum; ++handle) {
+        for (uint32_t phase = 0; phase < kStartupPhaseNum; ++phase) {
+          timer_.Mark(handle, static_cast<StartupPhase>(phase));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::string output = testing::internal::GetCapturedStdout();
+
+  EXPECT_EQ(CountLines(output, "Startup: lidar"), kLidarNum * kStartupPhaseNum);
+  for (uint32_t handle = 1; handle <= kLidarNum; ++handle) {
+    EXPECT_EQ(GetMask(handle), (1u << kStartupPhaseNum) - 1);
+  }
+}
+
+}  // namespace
+}  // namespace livox_ros
@@ -0,0 +1,732 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "emulator.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "rapidjson/document.h"
+#include "rapidjson/filereadstream.h"
+
+namespace livox_emulator {
+
+namespace {
+
+const uint32_t kMaxPointsPerPacket = 100;
+const size_t kMaxPacketSize = 1500;
+const size_t kMaxCommandSize = 1400;
+const uint32_t kSendBatchSize = 64;
+const uint32_t kPatternSize = 20000;
+const uint32_t kLidarsPerThread = 8;
+const uint64_t kIdleSleepNs = 1000000;         /**< 1 ms */
+const uint64_t kMaxCatchUpNs = 100000000;      /**< 100 ms, older packets are skipped */
+const uint64_t kFrameTimeNs = 100000000;       /**< 10 Hz frame counter */
+const uint64_t kPushIntervalNs = 1000000000;   /**< 1 s */
+const int kPollTimeoutMs = 100;
+const double kDegToRad = M_PI / 180.0;
+
+uint64_t SteadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+sockaddr_in MakeAddr(uint32_t addr, uint16_t port) {
+  sockaddr_in sock_addr;
+  memset(&sock_addr, 0, sizeof(sock_addr));
+  sock_addr.sin_family = AF_INET;
+  sock_addr.sin_addr.s_addr = addr;
+  sock_addr.sin_port = htons(port);
+  return sock_addr;
+}
+
+int OpenUdpSocket(uint32_t addr, uint16_t port, bool is_nonblock) {
+  int fd = socket(AF_INET, SOCK_DGRAM | (is_nonblock ? SOCK_NONBLOCK : 0), 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int enable = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  sockaddr_in sock_addr = MakeAddr(addr, port);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&sock_addr), sizeof(sock_addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void AtomicMax(std::atomic<uint64_t>& value, uint64_t candidate) {
+  uint64_t current = value.load();
+  while (candidate > current && !value.compare_exchange_weak(current, candidate)) {
+  }
+}
+
+}  // namespace
+
+bool ParsePortLayout(const std::string& config_path, EmulatorConfig& config) {
+  FILE* file = fopen(config_path.c_str(), "rb");
+  if (file == nullptr) {
+    printf("Open config failed: %s\n", config_path.c_str());
+    return false;
+  }
+  char read_buffer[32768];
+  rapidjson::FileReadStream config_file(file, read_buffer, sizeof(read_buffer));
+  rapidjson::Document doc;
+  doc.ParseStream(config_file);
+  fclose(file);
+  if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("MID360") || !doc["MID360"].IsObject()) {
+    printf("Config has no MID360 section: %s\n", config_path.c_str());
+    return false;
+  }
+
+  const rapidjson::Value& mid360 = doc["MID360"];
+  if (mid360.HasMember("lidar_net_info") && mid360["lidar_net_info"].IsObject()) {
+    const rapidjson::Value& lidar = mid360["lidar_net_info"];
+    if (lidar.HasMember("cmd_data_port")) config.lidar_cmd_port = lidar["cmd_data_port"].GetUint();
+    if (lidar.HasMember("push_msg_port")) config.lidar_push_port = lidar["push_msg_port"].GetUint();
+    if (lidar.HasMember("point_data_port")) config.lidar_point_port = lidar["point_data_port"].GetUint();
+    if (lidar.HasMember("imu_data_port")) config.lidar_imu_port = lidar["imu_data_port"].GetUint();
+  }
+  if (mid360.HasMember("host_net_info") && mid360["host_net_info"].IsObject()) {
+    const rapidjson::Value& host = mid360["host_net_info"];
+    if (host.HasMember("cmd_data_ip") && config.host_ip.empty()) config.host_ip = host["cmd_data_ip"].GetString();
+    if (host.HasMember("cmd_data_port")) config.host_cmd_port = host["cmd_data_port"].GetUint();
+    if (host.HasMember("push_msg_port")) config.host_push_port = host["push_msg_port"].GetUint();
+    if (host.HasMember("point_data_port")) config.host_point_port = host["point_data_port"].GetUint();
+    if (host.HasMember("imu_data_port")) config.host_imu_port = host["imu_data_port"].GetUint();
+  }
+  return true;
+}
+
+Emulator::Emulator(const EmulatorConfig& config)
+    : config_(config), detection_fd_(-1), start_time_(0), is_quit_(false) {
+  config_.points_per_packet = std::max(1u, std::min(config_.points_per_packet, kMaxPointsPerPacket));
+  config_.point_rate = std::max(config_.point_rate, config_.points_per_packet);
+  if (config_.thread_num == 0) {
+    config_.thread_num = (config_.lidar_count + kLidarsPerThread - 1) / kLidarsPerThread;
+  }
+  config_.thread_num = std::max(1u, std::min(config_.thread_num, config_.lidar_count));
+}
+
+Emulator::~Emulator() {
+  Stop();
+  for (auto& lidar : lidars_) {
+    close(lidar->cmd_fd);
+    close(lidar->push_fd);
+    close(lidar->point_fd);
+    close(lidar->imu_fd);
+  }
+  if (detection_fd_ >= 0) {
+    close(detection_fd_);
+  }
+}
+
+bool Emulator::Start() {
+  uint32_t base_ip = ntohl(inet_addr(config_.base_ip.c_str()));
+  uint32_t host_addr = inet_addr(config_.host_ip.c_str());
+  start_time_ = SteadyNs();
+  for (uint32_t i = 0; i < config_.lidar_count; ++i) {
+    std::unique_ptr<VirtualLidar> lidar(new VirtualLidar);
+    lidar->index = i;
+    lidar->addr = htonl(base_ip + i);
+    in_addr addr;
+    addr.s_addr = lidar->addr;
+    lidar->ip = inet_ntoa(addr);
+    memset(lidar->sn, 0, sizeof(lidar->sn));
+    snprintf(lidar->sn, sizeof(lidar->sn), "EMU%011u", i);
+    lidar->work_mode = config_.start_sampling ? kWorkModeSampling : 0;
+    lidar->data_type = config_.data_type;
+    lidar->point_send_enable = true;
+    lidar->imu_enable = config_.start_sampling;
+    lidar->point_host_addr = host_addr;
+    lidar->point_host_port = config_.host_point_port;
+    lidar->imu_host_addr = host_addr;
+    lidar->imu_host_port = config_.host_imu_port;
+    lidar->push_host_addr = host_addr;
+    lidar->push_host_port = config_.host_push_port;
+    lidar->is_connected = false;
+    lidar->push_seq = 0;
+    lidar->udp_cnt = 0;
+    lidar->point_index = 0;
+    lidar->time_offset = (i * 7919ULL % 1000) * 1000000ULL;
+    lidar->next_point_time = start_time_;
+    lidar->next_imu_time = start_time_;
+    if (!OpenSockets(*lidar)) {
+      printf("Bind lidar %s failed: %s\n", lidar->ip.c_str(), strerror(errno));
+      return false;
+    }
+    lidars_.push_back(std::move(lidar));
+  }
+
+  detection_fd_ = OpenUdpSocket(htonl(INADDR_ANY), kDetectionPort, false);
+  if (detection_fd_ < 0) {
+    printf("Bind detection port %u failed, only announcing lidars: %s\n", kDetectionPort, strerror(errno));
+  }
+
+  BuildPattern();
+  for (uint32_t i = 0; i < config_.thread_num; ++i) {
+    statistics_.emplace_back(new DataThreadStatistics());
+    statistics_.back()->point_packets = 0;
+    statistics_.back()->bytes = 0;
+    statistics_.back()->imu_packets = 0;
+    statistics_.back()->send_errors = 0;
+    statistics_.back()->late_ns = 0;
+  }
+  for (uint32_t i = 0; i < config_.thread_num; ++i) {
+    data_threads_.emplace_back(&Emulator::DataProcess, this, i);
+  }
+
+  printf("Emulating %u lidars from %s, host %s, %u data threads, %u points/s, %u points/packet\n",
+         config_.lidar_count, config_.base_ip.c_str(), config_.host_ip.c_str(), config_.thread_num,
+         config_.point_rate, config_.points_per_packet);
+  return true;
+}
+
+void Emulator::Stop() {
+  is_quit_ = true;
+  for (auto& thread : data_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  data_threads_.clear();
+}
+
+bool Emulator::OpenSockets(VirtualLidar& lidar) {
+  lidar.cmd_fd = OpenUdpSocket(lidar.addr, config_.lidar_cmd_port, false);
+  lidar.push_fd = OpenUdpSocket(lidar.addr, config_.lidar_push_port, true);
+  lidar.point_fd = OpenUdpSocket(lidar.addr, config_.lidar_point_port, true);
+  lidar.imu_fd = OpenUdpSocket(lidar.addr, config_.lidar_imu_port, true);
+  if (lidar.cmd_fd < 0 || lidar.push_fd < 0 || lidar.point_fd < 0 || lidar.imu_fd < 0) {
+    return false;
+  }
+  if (config_.send_buffer_size > 0) {
+    setsockopt(lidar.point_fd, SOL_SOCKET, SO_SNDBUF, &config_.send_buffer_size, sizeof(config_.send_buffer_size));
+  }
+  return true;
+}
+
+void Emulator::BuildPattern() {
+  high_pattern_.resize(kPatternSize);
+  low_pattern_.resize(kPatternSize);
+  spherical_pattern_.resize(kPatternSize);
+  for (uint32_t i = 0; i < kPatternSize; ++i) {
+    /** Mid-360 field of view, golden angle azimuth and evenly spread elevation */
+    double azimuth = fmod(i * 137.50776405, 360.0);
+    double elevation = -7.0 + 59.0 * fmod(i * 0.61803398875, 1.0);
+    double zenith = 90.0 - elevation;
+    double depth = 5000.0 + 3000.0 * (0.5 + 0.5 * sin(azimuth * 4.0 * kDegToRad));
+    double x = depth * sin(zenith * kDegToRad) * cos(azimuth * kDegToRad);
+    double y = depth * sin(zenith * kDegToRad) * sin(azimuth * kDegToRad);
+    double z = depth * cos(zenith * kDegToRad);
+    uint8_t reflectivity = static_cast<uint8_t>(i % 256);
+
+    high_pattern_[i] = {static_cast<int32_t>(x), static_cast<int32_t>(y), static_cast<int32_t>(z), reflectivity, 0};
+    low_pattern_[i] = {static_cast<int16_t>(x / 10.0), static_cast<int16_t>(y / 10.0),
+                       static_cast<int16_t>(z / 10.0), reflectivity, 0};
+    spherical_pattern_[i] = {static_cast<uint32_t>(depth), static_cast<uint16_t>(zenith * 100.0),
+                             static_cast<uint16_t>(azimuth * 100.0), reflectivity, 0};
+  }
+}
+
+void Emulator::DataProcess(uint32_t thread_index) {
+  DataThreadStatistics& statistics = *statistics_[thread_index];
+  SendBatch batch;
+  batch.buffers.assign(kSendBatchSize, std::vector<uint8_t>(kMaxPacketSize, 0));
+  batch.iovs.resize(kSendBatchSize);
+  batch.msgs.resize(kSendBatchSize);
+  batch.count = 0;
+
+  while (!is_quit_) {
+    uint64_t now = SteadyNs();
+    uint64_t next_time = now + kIdleSleepNs;
+    for (uint32_t i = thread_index; i < lidars_.size(); i += config_.thread_num) {
+      next_time = std::min(next_time, SendDuePackets(*lidars_[i], now, batch, statistics));
+    }
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next_time)));
+  }
+}
+
+uint64_t Emulator::SendDuePackets(VirtualLidar& lidar, uint64_t now, SendBatch& batch,
+                                  DataThreadStatistics& statistics) {
+  uint64_t next_time = now + kIdleSleepNs;
+
+  if (lidar.work_mode == kWorkModeSampling && lidar.point_send_enable) {
+    uint64_t packet_interval = 1000000000ULL * config_.points_per_packet / config_.point_rate;
+    if (now > lidar.next_point_time + kMaxCatchUpNs) {
+      lidar.next_point_time = now - kMaxCatchUpNs;
+    }
+    if (now > lidar.next_point_time) {
+      AtomicMax(statistics.late_ns, now - lidar.next_point_time);
+    }
+    batch.to = MakeAddr(lidar.point_host_addr, lidar.point_host_port);
+    uint64_t packet_num = 0;
+    while (lidar.next_point_time <= now) {
+      uint8_t* buffer = batch.buffers[batch.count].data();
+      batch.iovs[batch.count].iov_len = FillPointPacket(lidar, lidar.next_point_time, buffer);
+      ++batch.count;
+      ++packet_num;
+      lidar.next_point_time += packet_interval;
+      if (batch.count == kSendBatchSize) {
+        FlushBatch(lidar.point_fd, batch, statistics);
+      }
+    }
+    statistics.point_packets += packet_num;
+    FlushBatch(lidar.point_fd, batch, statistics);
+    next_time = std::min(next_time, lidar.next_point_time);
+  } else {
+    lidar.next_point_time = now;
+  }
+
+  if (lidar.work_mode == kWorkModeSampling && lidar.imu_enable && config_.imu_rate != 0) {
+    uint64_t imu_interval = 1000000000ULL / config_.imu_rate;
+    if (now > lidar.next_imu_time + kMaxCatchUpNs) {
+      lidar.next_imu_time = now - kMaxCatchUpNs;
+    }
+    batch.to = MakeAddr(lidar.imu_host_addr, lidar.imu_host_port);
+    while (lidar.next_imu_time <= now && batch.count < kSendBatchSize) {
+      uint8_t* buffer = batch.buffers[batch.count].data();
+      batch.iovs[batch.count].iov_len = FillImuPacket(lidar, lidar.next_imu_time, buffer);
+      ++batch.count;
+      lidar.next_imu_time += imu_interval;
+    }
+    statistics.imu_packets += batch.count;
+    FlushBatch(lidar.imu_fd, batch, statistics);
+    next_time = std::min(next_time, lidar.next_imu_time);
+  } else {
+    lidar.next_imu_time = now;
+  }
+  return next_time;
+}
+
+void Emulator::FlushBatch(int fd, SendBatch& batch, DataThreadStatistics& statistics) {
+  if (batch.count == 0) {
+    return;
+  }
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < batch.count; ++i) {
+    batch.iovs[i].iov_base = batch.buffers[i].data();
+    memset(&batch.msgs[i], 0, sizeof(mmsghdr));
+    batch.msgs[i].msg_hdr.msg_name = &batch.to;
+    batch.msgs[i].msg_hdr.msg_namelen = sizeof(batch.to);
+    batch.msgs[i].msg_hdr.msg_iov = &batch.iovs[i];
+    batch.msgs[i].msg_hdr.msg_iovlen = 1;
+    bytes += batch.iovs[i].iov_len;
+  }
+
+  /** Non-blocking, a full socket buffer drops the rest of the batch like a congested link would */
+  int sent = sendmmsg(fd, batch.msgs.data(), batch.count, 0);
+  if (sent < 0) {
+    sent = 0;
+  }
+  if (static_cast<uint32_t>(sent) < batch.count) {
+    statistics.send_errors += batch.count - sent;
+  }
+  statistics.bytes += bytes;
+  batch.count = 0;
+}
+
+size_t Emulator::FillPointPacket(VirtualLidar& lidar, uint64_t packet_time, uint8_t* buffer) {
+  EthPacket* packet = reinterpret_cast<EthPacket*>(buffer);
+  uint8_t data_type = lidar.data_type;
+  uint32_t dot_num = config_.points_per_packet;
+  uint64_t device_time = GetDeviceTime(lidar, packet_time);
+
+  const uint8_t* pattern = reinterpret_cast<const uint8_t*>(high_pattern_.data());
+  size_t point_size = sizeof(CartesianHighPoint);
+  if (data_type == kCartesianLowData) {
+    pattern = reinterpret_cast<const uint8_t*>(low_pattern_.data());
+    point_size = sizeof(CartesianLowPoint);
+  } else if (data_type == kSphericalData) {
+    pattern = reinterpret_cast<const uint8_t*>(spherical_pattern_.data());
+    point_size = sizeof(SphericalPoint);
+  } else {
+    data_type = kCartesianHighData;
+  }
+
+  uint32_t start = static_cast<uint32_t>(lidar.point_index % kPatternSize);
+  uint32_t first_part = std::min(dot_num, kPatternSize - start);
+  memcpy(packet->data, pattern + start * point_size, first_part * point_size);
+  if (first_part < dot_num) {
+    memcpy(packet->data + first_part * point_size, pattern, (dot_num - first_part) * point_size);
+  }
+  lidar.point_index += dot_num;
+
+  size_t size = kEthPacketHeaderSize + dot_num * point_size;
+  packet->version = 0;
+  packet->length = static_cast<uint16_t>(size);
+  packet->time_interval = static_cast<uint16_t>(10000000ULL * dot_num / config_.point_rate);
+  packet->dot_num = static_cast<uint16_t>(dot_num);
+  packet->udp_cnt = lidar.udp_cnt++;
+  packet->frame_cnt = static_cast<uint8_t>(device_time / kFrameTimeNs);
+  packet->data_type = data_type;
+  packet->time_type = 0;
+  memset(packet->rsvd, 0, sizeof(packet->rsvd));
+  memcpy(packet->timestamp, &device_time, sizeof(device_time));
+  packet->crc32 = Crc32(buffer + kEthPacketCrc32Offset, size - kEthPacketCrc32Offset);
+  return size;
+}
+
+size_t Emulator::FillImuPacket(VirtualLidar& lidar, uint64_t packet_time, uint8_t* buffer) {
+  EthPacket* packet = reinterpret_cast<EthPacket*>(buffer);
+  uint64_t device_time = GetDeviceTime(lidar, packet_time);
+  double phase = (device_time % 1000000000ULL) * 2.0 * M_PI / 1000000000.0;
+  ImuPoint imu = {static_cast<float>(0.01 * sin(phase)), static_cast<float>(0.01 * cos(phase)), 0.0f,
+                  0.0f, 0.0f, 1.0f};
+  memcpy(packet->data, &imu, sizeof(imu));
+
+  size_t size = kEthPacketHeaderSize + sizeof(ImuPoint);
+  packet->version = 0;
+  packet->length = static_cast<uint16_t>(size);
+  packet->time_interval = 0;
+  packet->dot_num = 1;
+  packet->udp_cnt = 0;
+  packet->frame_cnt = 0;
+  packet->data_type = kImuData;
+  packet->time_type = 0;
+  memset(packet->rsvd, 0, sizeof(packet->rsvd));
+  memcpy(packet->timestamp, &device_time, sizeof(device_time));
+  packet->crc32 = Crc32(buffer + kEthPacketCrc32Offset, size - kEthPacketCrc32Offset);
+  return size;
+}
+
+uint64_t Emulator::GetDeviceTime(const VirtualLidar& lidar, uint64_t now) const {
+  return lidar.time_offset + (now - start_time_);
+}
+
+void Emulator::Run() {
+  std::vector<pollfd> fds;
+  for (auto& lidar : lidars_) {
+    fds.push_back({lidar->cmd_fd, POLLIN, 0});
+  }
+  if (detection_fd_ >= 0) {
+    fds.push_back({detection_fd_, POLLIN, 0});
+  }
+
+  uint8_t buffer[kMaxCommandSize];
+  uint64_t last_push_time = SteadyNs();
+  while (!is_quit_) {
+    int ready = poll(fds.data(), fds.size(), kPollTimeoutMs);
+    for (size_t i = 0; ready > 0 && i < fds.size(); ++i) {
+      if (!(fds[i].revents & POLLIN)) {
+        continue;
+      }
+      sockaddr_in from;
+      socklen_t from_len = sizeof(from);
+      ssize_t size = recvfrom(fds[i].fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&from), &from_len);
+      if (size < static_cast<ssize_t>(kSdkPacketHeaderSize)) {
+        continue;
+      }
+      const SdkPacket* request = reinterpret_cast<const SdkPacket*>(buffer);
+      if (request->sof != kSdkPacketSof || request->length != size ||
+          request->crc16_h != Crc16(buffer, kSdkPacketCrc16Size) ||
+          request->cmd_type != kCommandTypeRequest) {
+        continue;
+      }
+      if (fds[i].fd == detection_fd_) {
+        if (request->cmd_id == kCommandDetection) {
+          OnDetection(request, from);
+        }
+      } else {
+        OnCommand(*lidars_[i], request, size, from);
+      }
+    }
+
+    uint64_t now = SteadyNs();
+    if (now - last_push_time >= kPushIntervalNs) {
+      for (auto& lidar : lidars_) {
+        if (!lidar->is_connected) {
+          Announce(*lidar);
+        }
+        PushState(*lidar);
+      }
+      ReportStatistics(now - last_push_time);
+      last_push_time = now;
+    }
+  }
+}
+
+void Emulator::Announce(VirtualLidar& lidar) {
+  /** Broadcast detection rarely reaches loopback addresses, offer the lidar to the host directly */
+  DetectionAck ack;
+  memset(&ack, 0, sizeof(ack));
+  ack.ret_code = 0;
+  ack.dev_type = kDeviceTypeMid360;
+  memcpy(ack.sn, lidar.sn, sizeof(ack.sn));
+  memcpy(ack.lidar_ip, &lidar.addr, sizeof(ack.lidar_ip));
+  ack.cmd_port = config_.lidar_cmd_port;
+  SendCommand(lidar.cmd_fd, MakeAddr(inet_addr(config_.host_ip.c_str()), config_.host_cmd_port),
+              kCommandDetection, kCommandTypeAck, 0, reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+}
+
+void Emulator::OnDetection(const SdkPacket* request, const sockaddr_in& from) {
+  for (auto& lidar : lidars_) {
+    DetectionAck ack;
+    memset(&ack, 0, sizeof(ack));
+    ack.ret_code = 0;
+    ack.dev_type = kDeviceTypeMid360;
+    memcpy(ack.sn, lidar->sn, sizeof(ack.sn));
+    memcpy(ack.lidar_ip, &lidar->addr, sizeof(ack.lidar_ip));
+    ack.cmd_port = config_.lidar_cmd_port;
+    SendCommand(lidar->cmd_fd, from, kCommandDetection, kCommandTypeAck, request->seq_num,
+                reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+  }
+}
+
+void Emulator::OnCommand(VirtualLidar& lidar, const SdkPacket* request, size_t size, const sockaddr_in& from) {
+  lidar.is_connected = true;
+  const uint8_t* data = request->data;
+  size_t data_size = size - kSdkPacketHeaderSize;
+  uint8_t ack[kMaxCommandSize];
+  size_t ack_size = 0;
+
+  if (request->cmd_id == kCommandWorkModeControl) {
+    uint16_t error_key = 0;
+    SetParameters(lidar, data, data_size, error_key);
+    ack[0] = 0;
+    memcpy(ack + 1, &error_key, sizeof(error_key));
+    ack_size = 1 + sizeof(error_key);
+  } else if (request->cmd_id == kCommandGetInternalInfo) {
+    ack_size = GetParameters(lidar, data, data_size, ack);
+  } else {
+    ack[0] = 0;
+    ack_size = 1;
+  }
+  SendCommand(lidar.cmd_fd, from, request->cmd_id, kCommandTypeAck, request->seq_num, ack, ack_size);
+}
+
+void Emulator::SetParameters(VirtualLidar& lidar, const uint8_t* data, size_t size, uint16_t& error_key) {
+  if (size < 4) {
+    return;
+  }
+  uint16_t key_num = 0;
+  memcpy(&key_num, data, sizeof(key_num));
+  size_t offset = 4;
+  for (uint16_t i = 0; i < key_num && offset + 4 <= size; ++i) {
+    uint16_t key = 0;
+    uint16_t length = 0;
+    memcpy(&key, data + offset, sizeof(key));
+    memcpy(&length, data + offset + 2, sizeof(length));
+    const uint8_t* value = data + offset + 4;
+    offset += 4 + length;
+    if (offset > size || length == 0) {
+      error_key = key;
+      return;
+    }
+
+    HostIpCfg ip_cfg;
+    uint32_t host_addr = 0;
+    switch (key) {
+      case kKeyPclDataType:
+        lidar.data_type = value[0];
+        break;
+      case kKeyPointSendEnable:
+        lidar.point_send_enable = (value[0] != 0);
+        break;
+      case kKeyWorkTargetMode:
+        lidar.work_mode = value[0];
+        break;
+      case kKeyImuDataEnable:
+        lidar.imu_enable = (value[0] != 0);
+        break;
+      case kKeyPointDataHostIpCfg:
+      case kKeyImuDataHostIpCfg:
+      case kKeyStateInfoHostIpCfg:
+        if (length < sizeof(ip_cfg)) {
+          error_key = key;
+          return;
+        }
+        memcpy(&ip_cfg, value, sizeof(ip_cfg));
+        memcpy(&host_addr, ip_cfg.host_ip, sizeof(host_addr));
+        if (key == kKeyPointDataHostIpCfg) {
+          lidar.point_host_addr = host_addr;
+          lidar.point_host_port = ip_cfg.host_port;
+        } else if (key == kKeyImuDataHostIpCfg) {
+          lidar.imu_host_addr = host_addr;
+          lidar.imu_host_port = ip_cfg.host_port;
+        } else {
+          lidar.push_host_addr = host_addr;
+          lidar.push_host_port = ip_cfg.host_port;
+        }
+        break;
+      default:
+        /** Scan pattern, dual emit, blind spot, attitude... have no effect on the emulated data */
+        break;
+    }
+  }
+}
+
+size_t Emulator::GetParameters(VirtualLidar& lidar, const uint8_t* data, size_t size, uint8_t* out) {
+  uint16_t key_num = 0;
+  if (size >= 4) {
+    memcpy(&key_num, data, sizeof(key_num));
+  }
+  out[0] = 0;
+  size_t out_size = 3;
+  uint16_t out_num = 0;
+  for (uint16_t i = 0; i < key_num && 4 + (i + 1) * sizeof(uint16_t) <= size; ++i) {
+    uint16_t key = 0;
+    memcpy(&key, data + 4 + i * sizeof(uint16_t), sizeof(key));
+    if (out_size + 4 + 64 > kMaxCommandSize) {
+      break;
+    }
+    size_t kv_size = PutParameter(lidar, key, out + out_size);
+    if (kv_size != 0) {
+      out_size += kv_size;
+      ++out_num;
+    }
+  }
+  memcpy(out + 1, &out_num, sizeof(out_num));
+  return out_size;
+}
+
+size_t Emulator::PutParameter(VirtualLidar& lidar, uint16_t key, uint8_t* out) {
+  uint8_t value[64];
+  uint16_t length = 1;
+  HostIpCfg ip_cfg;
+  uint32_t host_addr = 0;
+  memset(value, 0, sizeof(value));
+  switch (key) {
+    case kKeyPclDataType:
+      value[0] = lidar.data_type;
+      break;
+    case kKeyPatternMode:
+      value[0] = 0;
+      break;
+    case kKeyPointSendEnable:
+      value[0] = lidar.point_send_enable ? 1 : 0;
+      break;
+    case kKeyWorkTargetMode:
+    case kKeyCurWorkState:
+      value[0] = lidar.work_mode;
+      break;
+    case kKeyImuDataEnable:
+      value[0] = lidar.imu_enable ? 1 : 0;
+      break;
+    case kKeySn:
+      length = sizeof(lidar.sn);
+      memcpy(value, lidar.sn, sizeof(lidar.sn));
+      break;
+    case kKeyProductInfo:
+      length = 64;
+      snprintf(reinterpret_cast<char*>(value), sizeof(value), "Mid-360 emulator");
+      break;
+    case kKeyPointDataHostIpCfg:
+    case kKeyImuDataHostIpCfg:
+    case kKeyStateInfoHostIpCfg:
+      if (key == kKeyPointDataHostIpCfg) {
+        host_addr = lidar.point_host_addr;
+        ip_cfg.host_port = lidar.point_host_port;
+        ip_cfg.lidar_port = config_.lidar_point_port;
+      } else if (key == kKeyImuDataHostIpCfg) {
+        host_addr = lidar.imu_host_addr;
+        ip_cfg.host_port = lidar.imu_host_port;
+        ip_cfg.lidar_port = config_.lidar_imu_port;
+      } else {
+        host_addr = lidar.push_host_addr;
+        ip_cfg.host_port = lidar.push_host_port;
+        ip_cfg.lidar_port = config_.lidar_push_port;
+      }
+      memcpy(ip_cfg.host_ip, &host_addr, sizeof(ip_cfg.host_ip));
+      length = sizeof(ip_cfg);
+      memcpy(value, &ip_cfg, sizeof(ip_cfg));
+      break;
+    default:
+      return 0;
+  }
+  memcpy(out, &key, sizeof(key));
+  memcpy(out + 2, &length, sizeof(length));
+  memcpy(out + 4, value, length);
+  return 4 + length;
+}
+
+void Emulator::PushState(VirtualLidar& lidar) {
+  static const uint16_t kPushKeys[] = {kKeyPclDataType, kKeyPatternMode, kKeyPointDataHostIpCfg,
+                                       kKeyImuDataHostIpCfg, kKeyStateInfoHostIpCfg, kKeyWorkTargetMode,
+                                       kKeyImuDataEnable, kKeySn, kKeyCurWorkState};
+  uint8_t data[kMaxCommandSize];
+  size_t size = 4;
+  uint16_t key_num = 0;
+  for (uint16_t key : kPushKeys) {
+    size += PutParameter(lidar, key, data + size);
+    ++key_num;
+  }
+  memcpy(data, &key_num, sizeof(key_num));
+  data[2] = 0;
+  data[3] = 0;
+  SendCommand(lidar.push_fd, MakeAddr(lidar.push_host_addr, lidar.push_host_port), kCommandPushMsg,
+              kCommandTypeRequest, lidar.push_seq++, data, size);
+}
+
+void Emulator::SendCommand(int fd, const sockaddr_in& to, uint16_t cmd_id, uint8_t cmd_type,
+                           uint32_t seq_num, const uint8_t* data, size_t size) {
+  uint8_t buffer[kMaxCommandSize + kSdkPacketHeaderSize];
+  SdkPacket* packet = reinterpret_cast<SdkPacket*>(buffer);
+  packet->sof = kSdkPacketSof;
+  packet->version = kSdkPacketVersion;
+  packet->length = static_cast<uint16_t>(kSdkPacketHeaderSize + size);
+  packet->seq_num = seq_num;
+  packet->cmd_id = cmd_id;
+  packet->cmd_type = cmd_type;
+  packet->sender_type = kSenderLidar;
+  memset(packet->rsvd, 0, sizeof(packet->rsvd));
+  packet->crc16_h = Crc16(buffer, kSdkPacketCrc16Size);
+  packet->crc32_d = Crc32(data, size);
+  memcpy(packet->data, data, size);
+  sendto(fd, buffer, packet->length, 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+}
+
+void Emulator::ReportStatistics(uint64_t period_ns) {
+  uint64_t point_packets = 0;
+  uint64_t imu_packets = 0;
+  uint64_t bytes = 0;
+  uint64_t send_errors = 0;
+  uint64_t late_ns = 0;
+  for (auto& statistics : statistics_) {
+    point_packets += statistics->point_packets.exchange(0);
+    imu_packets += statistics->imu_packets.exchange(0);
+    bytes += statistics->bytes.exchange(0);
+    send_errors += statistics->send_errors.exchange(0);
+    late_ns = std::max(late_ns, statistics->late_ns.exchange(0));
+  }
+  double seconds = period_ns / 1e9;
+  uint32_t connected = 0;
+  for (auto& lidar : lidars_) {
+    connected += lidar->is_connected ? 1 : 0;
+  }
+  printf("lidars %u/%u connected, point %.0f pkt/s, imu %.0f pkt/s, %.1f Mbit/s, dropped %lu, max late %.3f ms\n",
+         connected, static_cast<uint32_t>(lidars_.size()), point_packets / seconds, imu_packets / seconds,
+         bytes * 8 / seconds / 1e6, static_cast<unsigned long>(send_errors), late_ns / 1e6);
+  fflush(stdout);
+}
+
+}  // namespace livox_emulator
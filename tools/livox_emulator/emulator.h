@@ -0,0 +1,172 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Virtual Mid-360 lidars speaking the UDP protocol on loopback addresses */
+
+#ifndef LIVOX_EMULATOR_EMULATOR_H_
+#define LIVOX_EMULATOR_EMULATOR_H_
+
+#include <netinet/in.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "livox_protocol.h"
+
+namespace livox_emulator {
+
+typedef struct {
+  std::string config_path;    /**< port layout from a MID360 user config */
+  std::string base_ip;        /**< ip of the first virtual lidar, the others count up */
+  std::string host_ip;        /**< initial destination of data and push messages */
+  uint32_t lidar_count;
+  uint32_t thread_num;        /**< data threads, 0 for one per 8 lidars */
+  uint32_t point_rate;        /**< points/s of each lidar */
+  uint32_t points_per_packet;
+  uint32_t imu_rate;          /**< Hz */
+  uint8_t data_type;          /**< until set by the host */
+  bool start_sampling;        /**< stream before the host sets the work mode */
+  int send_buffer_size;       /**< SO_SNDBUF of the data sockets, 0 keeps the system default */
+  uint16_t lidar_cmd_port;
+  uint16_t lidar_push_port;
+  uint16_t lidar_point_port;
+  uint16_t lidar_imu_port;
+  uint16_t host_cmd_port;
+  uint16_t host_push_port;
+  uint16_t host_point_port;
+  uint16_t host_imu_port;
+} EmulatorConfig;
+
+/** Counters of one data thread, reported by the command thread */
+typedef struct {
+  std::atomic<uint64_t> point_packets;
+  std::atomic<uint64_t> bytes;
+  std::atomic<uint64_t> imu_packets;
+  std::atomic<uint64_t> send_errors;   /**< EAGAIN/ENOBUFS, the packet is dropped */
+  std::atomic<uint64_t> late_ns;       /**< worst lateness of a packet in the period */
+} DataThreadStatistics;
+
+typedef struct {
+  uint32_t index;
+  std::string ip;
+  uint32_t addr;                       /**< network byte order */
+  char sn[16];
+  int cmd_fd;
+  int push_fd;
+  int point_fd;
+  int imu_fd;
+
+  /** Written by the command thread, read by the data thread */
+  std::atomic<uint8_t> work_mode;
+  std::atomic<uint8_t> data_type;
+  std::atomic<bool> point_send_enable;
+  std::atomic<bool> imu_enable;
+  std::atomic<uint32_t> point_host_addr;
+  std::atomic<uint16_t> point_host_port;
+  std::atomic<uint32_t> imu_host_addr;
+  std::atomic<uint16_t> imu_host_port;
+  std::atomic<uint32_t> push_host_addr;
+  std::atomic<uint16_t> push_host_port;
+
+  /** Owned by the command thread */
+  bool is_connected;                   /**< a host command was received, stop announcing */
+  uint32_t push_seq;
+
+  /** Owned by the data thread */
+  uint16_t udp_cnt;
+  uint64_t point_index;
+  uint64_t time_offset;                /**< ns, device clock at emulator start */
+  uint64_t next_point_time;
+  uint64_t next_imu_time;
+} VirtualLidar;
+
+/** Packets of one lidar socket sent with a single sendmmsg */
+typedef struct {
+  std::vector<std::vector<uint8_t>> buffers;
+  std::vector<iovec> iovs;
+  std::vector<mmsghdr> msgs;
+  sockaddr_in to;
+  uint32_t count;
+} SendBatch;
+
+class Emulator {
+ public:
+  explicit Emulator(const EmulatorConfig& config);
+  ~Emulator();
+
+  bool Start();
+  void Stop();
+  /** Runs the command handling and statistics loop until Stop */
+  void Run();
+
+ private:
+  bool OpenSockets(VirtualLidar& lidar);
+  void DataProcess(uint32_t thread_index);
+  uint64_t SendDuePackets(VirtualLidar& lidar, uint64_t now, SendBatch& batch,
+                          DataThreadStatistics& statistics);
+  void FlushBatch(int fd, SendBatch& batch, DataThreadStatistics& statistics);
+  size_t FillPointPacket(VirtualLidar& lidar, uint64_t packet_time, uint8_t* buffer);
+  size_t FillImuPacket(VirtualLidar& lidar, uint64_t packet_time, uint8_t* buffer);
+  void BuildPattern();
+
+  void OnDetection(const SdkPacket* request, const sockaddr_in& from);
+  void OnCommand(VirtualLidar& lidar, const SdkPacket* request, size_t size, const sockaddr_in& from);
+  void SetParameters(VirtualLidar& lidar, const uint8_t* data, size_t size, uint16_t& error_key);
+  size_t GetParameters(VirtualLidar& lidar, const uint8_t* data, size_t size, uint8_t* out);
+  size_t PutParameter(VirtualLidar& lidar, uint16_t key, uint8_t* out);
+  void PushState(VirtualLidar& lidar);
+  void Announce(VirtualLidar& lidar);
+  void SendCommand(int fd, const sockaddr_in& to, uint16_t cmd_id, uint8_t cmd_type,
+                   uint32_t seq_num, const uint8_t* data, size_t size);
+  void ReportStatistics(uint64_t period_ns);
+
+  uint64_t GetDeviceTime(const VirtualLidar& lidar, uint64_t now) const;
+
+  EmulatorConfig config_;
+  std::vector<std::unique_ptr<VirtualLidar>> lidars_;
+  int detection_fd_;
+  uint64_t start_time_;
+
+  /** One scan of the synthetic pattern, indexed by point_index modulo its size */
+  std::vector<CartesianHighPoint> high_pattern_;
+  std::vector<CartesianLowPoint> low_pattern_;
+  std::vector<SphericalPoint> spherical_pattern_;
+
+  std::atomic<bool> is_quit_;
+  std::vector<std::unique_ptr<DataThreadStatistics>> statistics_;
+  std::vector<std::thread> data_threads_;
+};
+
+/** Reads the port layout and host ip of the "MID360" section into config */
+bool ParsePortLayout(const std::string& config_path, EmulatorConfig& config);
+
+}  // namespace livox_emulator
+
+#endif  // LIVOX_EMULATOR_EMULATOR_H_
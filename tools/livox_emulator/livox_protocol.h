@@ -0,0 +1,174 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Wire format of the Mid-360 command and data UDP protocol */
+
+#ifndef LIVOX_EMULATOR_LIVOX_PROTOCOL_H_
+#define LIVOX_EMULATOR_LIVOX_PROTOCOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace livox_emulator {
+
+const uint8_t kSdkPacketSof = 0xAA;
+const uint8_t kSdkPacketVersion = 0;
+const uint16_t kDetectionPort = 56000;
+
+/** cmd_type */
+const uint8_t kCommandTypeRequest = 0;
+const uint8_t kCommandTypeAck = 1;
+
+/** sender_type */
+const uint8_t kSenderHost = 0;
+const uint8_t kSenderLidar = 1;
+
+/** cmd_id */
+const uint16_t kCommandDetection = 0x0000;
+const uint16_t kCommandWorkModeControl = 0x0100;
+const uint16_t kCommandGetInternalInfo = 0x0101;
+const uint16_t kCommandPushMsg = 0x0102;
+
+/** Parameter keys of the key-value lists */
+const uint16_t kKeyPclDataType = 0x0000;
+const uint16_t kKeyPatternMode = 0x0001;
+const uint16_t kKeyDualEmitEnable = 0x0002;
+const uint16_t kKeyPointSendEnable = 0x0003;
+const uint16_t kKeyStateInfoHostIpCfg = 0x0005;
+const uint16_t kKeyPointDataHostIpCfg = 0x0006;
+const uint16_t kKeyImuDataHostIpCfg = 0x0007;
+const uint16_t kKeyWorkTargetMode = 0x001A;
+const uint16_t kKeyImuDataEnable = 0x001C;
+const uint16_t kKeySn = 0x8000;
+const uint16_t kKeyProductInfo = 0x8001;
+const uint16_t kKeyCurWorkState = 0x8006;
+
+/** Point data types */
+const uint8_t kImuData = 0x00;
+const uint8_t kCartesianHighData = 0x01;
+const uint8_t kCartesianLowData = 0x02;
+const uint8_t kSphericalData = 0x03;
+
+const uint8_t kDeviceTypeMid360 = 9;
+const uint8_t kWorkModeSampling = 0x01;
+
+#pragma pack(1)
+
+typedef struct {
+  uint8_t sof;
+  uint8_t version;
+  uint16_t length;       /**< header and data */
+  uint32_t seq_num;
+  uint16_t cmd_id;
+  uint8_t cmd_type;
+  uint8_t sender_type;
+  uint8_t rsvd[6];
+  uint16_t crc16_h;      /**< over the header bytes before it */
+  uint32_t crc32_d;      /**< over data */
+  uint8_t data[1];
+} SdkPacket;
+
+typedef struct {
+  uint8_t ret_code;
+  uint8_t dev_type;
+  char sn[16];
+  uint8_t lidar_ip[4];
+  uint16_t cmd_port;
+} DetectionAck;
+
+typedef struct {
+  uint16_t key;
+  uint16_t length;
+  uint8_t value[1];
+} KeyValue;
+
+typedef struct {
+  uint8_t host_ip[4];
+  uint16_t host_port;
+  uint16_t lidar_port;
+} HostIpCfg;
+
+typedef struct {
+  uint8_t version;
+  uint16_t length;
+  uint16_t time_interval;  /**< unit 0.1 us */
+  uint16_t dot_num;
+  uint16_t udp_cnt;
+  uint8_t frame_cnt;
+  uint8_t data_type;
+  uint8_t time_type;
+  uint8_t rsvd[12];
+  uint32_t crc32;          /**< over timestamp and data */
+  uint8_t timestamp[8];
+  uint8_t data[1];
+} EthPacket;
+
+typedef struct {
+  int32_t x;
+  int32_t y;
+  int32_t z;
+  uint8_t reflectivity;
+  uint8_t tag;
+} CartesianHighPoint;
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+  uint8_t reflectivity;
+  uint8_t tag;
+} CartesianLowPoint;
+
+typedef struct {
+  uint32_t depth;
+  uint16_t theta;
+  uint16_t phi;
+  uint8_t reflectivity;
+  uint8_t tag;
+} SphericalPoint;
+
+typedef struct {
+  float gyro_x;
+  float gyro_y;
+  float gyro_z;
+  float acc_x;
+  float acc_y;
+  float acc_z;
+} ImuPoint;
+
+#pragma pack()
+
+const size_t kSdkPacketHeaderSize = sizeof(SdkPacket) - 1;
+const size_t kSdkPacketCrc16Size = offsetof(SdkPacket, crc16_h);
+const size_t kEthPacketHeaderSize = sizeof(EthPacket) - 1;
+const size_t kEthPacketCrc32Offset = offsetof(EthPacket, timestamp);
+
+/** CRC-16/CCITT-FALSE */
+uint16_t Crc16(const uint8_t* data, size_t size);
+/** CRC-32 (IEEE 802.3) */
+uint32_t Crc32(const uint8_t* data, size_t size);
+
+}  // namespace livox_emulator
+
+#endif  // LIVOX_EMULATOR_LIVOX_PROTOCOL_H_
@@ -0,0 +1,141 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "emulator.h"
+
+using livox_emulator::Emulator;
+using livox_emulator::EmulatorConfig;
+
+namespace {
+
+Emulator* g_emulator = nullptr;
+
+void SignalHandler(int signal) {
+  (void)signal;
+  if (g_emulator != nullptr) {
+    g_emulator->Stop();
+  }
+}
+
+void PrintUsage(const char* name) {
+  printf("Usage: %s [options]\n"
+         "  -c, --config FILE          read the port layout and host ip of the MID360 section\n"
+         "  -n, --count N              number of virtual lidars (1)\n"
+         "  -b, --base-ip IP           ip of the first lidar, the others count up (127.0.0.2)\n"
+         "  -H, --host-ip IP           initial destination of data and push messages (127.0.0.1)\n"
+         "  -t, --threads N            data threads, 0 for one per 8 lidars (0)\n"
+         "  -r, --point-rate N         points per second of each lidar (200000)\n"
+         "  -p, --points-per-packet N  (96)\n"
+         "  -i, --imu-rate N           IMU packets per second, 0 disables (200)\n"
+         "  -d, --data-type N          1 cartesian high, 2 cartesian low, 3 spherical (1)\n"
+         "  -s, --sndbuf BYTES         SO_SNDBUF of the point data sockets\n"
+         "  -w, --wait                 stay idle until the host sets the work mode\n",
+         name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  EmulatorConfig config;
+  config.base_ip = "127.0.0.2";
+  config.lidar_count = 1;
+  config.thread_num = 0;
+  config.point_rate = 200000;
+  config.points_per_packet = 96;
+  config.imu_rate = 200;
+  config.data_type = livox_emulator::kCartesianHighData;
+  config.start_sampling = true;
+  config.send_buffer_size = 0;
+  config.lidar_cmd_port = 56100;
+  config.lidar_push_port = 56200;
+  config.lidar_point_port = 56300;
+  config.lidar_imu_port = 56400;
+  config.host_cmd_port = 56101;
+  config.host_push_port = 56201;
+  config.host_point_port = 56301;
+  config.host_imu_port = 56401;
+
+  static const option kOptions[] = {
+    {"config", required_argument, nullptr, 'c'},
+    {"count", required_argument, nullptr, 'n'},
+    {"base-ip", required_argument, nullptr, 'b'},
+    {"host-ip", required_argument, nullptr, 'H'},
+    {"threads", required_argument, nullptr, 't'},
+    {"point-rate", required_argument, nullptr, 'r'},
+    {"points-per-packet", required_argument, nullptr, 'p'},
+    {"imu-rate", required_argument, nullptr, 'i'},
+    {"data-type", required_argument, nullptr, 'd'},
+    {"sndbuf", required_argument, nullptr, 's'},
+    {"wait", no_argument, nullptr, 'w'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "c:n:b:H:t:r:p:i:d:s:wh", kOptions, nullptr)) != -1) {
+    switch (opt) {
+      case 'c': config.config_path = optarg; break;
+      case 'n': config.lidar_count = strtoul(optarg, nullptr, 10); break;
+      case 'b': config.base_ip = optarg; break;
+      case 'H': config.host_ip = optarg; break;
+      case 't': config.thread_num = strtoul(optarg, nullptr, 10); break;
+      case 'r': config.point_rate = strtoul(optarg, nullptr, 10); break;
+      case 'p': config.points_per_packet = strtoul(optarg, nullptr, 10); break;
+      case 'i': config.imu_rate = strtoul(optarg, nullptr, 10); break;
+      case 'd': config.data_type = static_cast<uint8_t>(strtoul(optarg, nullptr, 10)); break;
+      case 's': config.send_buffer_size = atoi(optarg); break;
+      case 'w': config.start_sampling = false; break;
+      default:
+        PrintUsage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  if (!config.config_path.empty() && !livox_emulator::ParsePortLayout(config.config_path, config)) {
+    return 1;
+  }
+  if (config.host_ip.empty()) {
+    config.host_ip = "127.0.0.1";
+  }
+  if (config.lidar_count == 0) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  Emulator emulator(config);
+  if (!emulator.Start()) {
+    return 1;
+  }
+  g_emulator = &emulator;
+  signal(SIGINT, SignalHandler);
+  signal(SIGTERM, SignalHandler);
+  emulator.Run();
+  g_emulator = nullptr;
+  return 0;
+}
@@ -0,0 +1,115 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** The subset of livox_lidar_api.h used by the driver, backed by MockSdk */
+
+#include "livox_lidar_api.h"
+#include "livox_lidar_def.h"
+
+#include "mock_sdk.h"
+
+using livox_mock::MockLidar;
+using livox_mock::MockSdk;
+
+bool LivoxLidarSdkInit(const char* path, const char* host_ip, const LivoxLidarLoggerCfgInfo* log_cfg_info) {
+  (void)host_ip;
+  (void)log_cfg_info;
+  return MockSdk::GetInstance().Init(path);
+}
+
+bool LivoxLidarSdkStart() {
+  return true;
+}
+
+void LivoxLidarSdkUninit() {
+  MockSdk::GetInstance().Uninit();
+}
+
+void DisableLivoxSdkConsoleLogger() {
+}
+
+uint16_t LivoxLidarAddPointCloudObserver(LivoxLidarPointCloudObserver cb, void* client_data) {
+  return MockSdk::GetInstance().AddObserver(cb, client_data);
+}
+
+void LivoxLidarRemovePointCloudObserver(uint16_t id) {
+  MockSdk::GetInstance().RemoveObserver(id);
+}
+
+void SetLivoxLidarInfoChangeCallback(LivoxLidarInfoChangeCallback cb, void* client_data) {
+  MockSdk::GetInstance().SetInfoChangeCallback(cb, client_data);
+}
+
+livox_status SetLivoxLidarWorkMode(uint32_t handle, LivoxLidarWorkMode work_mode,
+                                   LivoxLidarAsyncControlCallback cb, void* client_data) {
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [work_mode](MockLidar& lidar) {
+    lidar.is_sampling = (work_mode == kLivoxLidarNormal);
+  });
+}
+
+livox_status SetLivoxLidarPclDataType(uint32_t handle, LivoxLidarPointDataType data_type,
+                                      LivoxLidarAsyncControlCallback cb, void* client_data) {
+  if (data_type == kLivoxLidarImuData) {
+    return kLivoxLidarStatusNotSupported;
+  }
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [data_type](MockLidar& lidar) {
+    lidar.data_type = data_type;
+  });
+}
+
+livox_status SetLivoxLidarScanPattern(uint32_t handle, LivoxLidarScanPattern scan_pattern,
+                                      LivoxLidarAsyncControlCallback cb, void* client_data) {
+  (void)scan_pattern;
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar&) {});
+}
+
+livox_status SetLivoxLidarDualEmit(uint32_t handle, bool enable,
+                                   LivoxLidarAsyncControlCallback cb, void* client_data) {
+  (void)enable;
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar&) {});
+}
+
+livox_status SetLivoxLidarBlindSpot(uint32_t handle, uint32_t blind_spot,
+                                    LivoxLidarAsyncControlCallback cb, void* client_data) {
+  (void)blind_spot;
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar&) {});
+}
+
+livox_status SetLivoxLidarInstallAttitude(uint32_t handle, LivoxLidarInstallAttitude* install_attitude,
+                                          LivoxLidarAsyncControlCallback cb, void* client_data) {
+  (void)install_attitude;
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar&) {});
+}
+
+livox_status EnableLivoxLidarImuData(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar& lidar) {
+    lidar.is_imu_enabled = true;
+  });
+}
+
+livox_status DisableLivoxLidarImuData(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  return MockSdk::GetInstance().Control(handle, cb, client_data, [](MockLidar& lidar) {
+    lidar.is_imu_enabled = false;
+  });
+}
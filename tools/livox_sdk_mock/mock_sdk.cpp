@@ -0,0 +1,502 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "mock_sdk.h"
+
+#include <arpa/inet.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "rapidjson/document.h"
+#include "rapidjson/filereadstream.h"
+
+namespace livox_mock {
+
+namespace {
+
+const uint32_t kMaxPointsPerPacket = 96 * 4;
+const uint32_t kPacketHeaderSize = sizeof(LivoxLidarEthernetPacket) - 1;
+const uint64_t kMaxCatchUpNs = 100000000;     /**< 100 ms */
+const uint64_t kIdleSleepNs = 10000000;       /**< 10 ms */
+const uint64_t kFrameTimeNs = 100000000;      /**< 10 Hz frame counter */
+const uint32_t kMid360PointRate = 200000;
+const uint32_t kHapPointRate = 452000;
+const double kGoldenAngleDeg = 137.50776405;
+const double kGoldenRatio = 0.61803398875;
+const double kDegToRad = M_PI / 180.0;
+
+uint64_t SteadyNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t SystemNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/** Deterministic scan pattern: golden angle in azimuth, evenly spread elevation */
+void GetSyntheticPoint(uint8_t dev_type, uint64_t index, double& depth_mm,
+                       double& zenith_deg, double& azimuth_deg) {
+  double min_elevation = -7.0;
+  double max_elevation = 52.0;
+  if (dev_type != kLivoxLidarTypeMid360) {
+    min_elevation = -12.5;
+    max_elevation = 12.5;
+  }
+  double fraction = fmod(index * kGoldenRatio, 1.0);
+  double elevation = min_elevation + (max_elevation - min_elevation) * fraction;
+  azimuth_deg = fmod(index * kGoldenAngleDeg, 360.0);
+  zenith_deg = 90.0 - elevation;
+  depth_mm = 5000.0 + 3000.0 * (0.5 + 0.5 * sin(azimuth_deg * 4.0 * kDegToRad));
+}
+
+}  // namespace
+
+MockSdk& MockSdk::GetInstance() {
+  static MockSdk mock_sdk;
+  return mock_sdk;
+}
+
+bool MockSdk::Init(const char* config_path) {
+  if (generate_thread_) {
+    return false;
+  }
+  if (!ParseConfig(config_path)) {
+    return false;
+  }
+
+  random_.seed(config_.seed);
+  packet_buffer_.assign(kPacketHeaderSize + kMaxPointsPerPacket * sizeof(LivoxLidarCartesianHighRawPoint), 0);
+  start_time_ = SteadyNs();
+  for (auto& lidar : lidars_) {
+    lidar.boot_offset = (random_() % 1000) * 1000000ULL;
+    lidar.next_packet_time = start_time_;
+    lidar.next_imu_time = start_time_;
+  }
+
+  printf("Livox mock sdk started, lidar count:%zu dev type:%u point rate:%u loss rate:%f\n",
+         lidars_.size(), config_.device_type, config_.point_rate, config_.loss_rate);
+
+  is_quit_ = false;
+  generate_thread_ = std::make_shared<std::thread>(&MockSdk::GenerateProcess, this);
+  return true;
+}
+
+void MockSdk::Uninit() {
+  is_quit_ = true;
+  if (generate_thread_ && generate_thread_->joinable()) {
+    generate_thread_->join();
+  }
+  generate_thread_ = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  lidars_.clear();
+  pending_acks_.clear();
+  std::lock_guard<std::mutex> callback_lock(callback_mutex_);
+  observers_.clear();
+  info_callback_ = nullptr;
+  info_client_data_ = nullptr;
+}
+
+bool MockSdk::ParseConfig(const char* config_path) {
+  config_.lidar_count = 0;
+  config_.base_ip = "192.168.1.100";
+  config_.device_type = kLivoxLidarTypeMid360;
+  config_.data_type = kLivoxLidarCartesianCoordinateHighData;
+  config_.points_per_packet = 96;
+  config_.point_rate = 0;
+  config_.imu_rate = 200;
+  config_.loss_rate = 0.0;
+  config_.loss_burst = 1;
+  config_.time_type = 0;
+  config_.clock_skew_ppm = 0.0;
+  config_.seed = 1;
+
+  FILE* file = fopen(config_path, "rb");
+  if (file == nullptr) {
+    printf("Livox mock sdk open config failed: %s\n", config_path);
+    return false;
+  }
+  char read_buffer[32768];
+  rapidjson::FileReadStream config_file(file, read_buffer, sizeof(read_buffer));
+  rapidjson::Document doc;
+  doc.ParseStream(config_file);
+  fclose(file);
+  if (doc.HasParseError() || !doc.IsObject()) {
+    printf("Livox mock sdk parse config failed: %s\n", config_path);
+    return false;
+  }
+
+  if (doc.HasMember("mock_sdk") && doc["mock_sdk"].IsObject()) {
+    const rapidjson::Value& mock = doc["mock_sdk"];
+    if (mock.HasMember("lidar_count") && mock["lidar_count"].IsUint()) {
+      config_.lidar_count = mock["lidar_count"].GetUint();
+    }
+    if (mock.HasMember("base_ip") && mock["base_ip"].IsString()) {
+      config_.base_ip = mock["base_ip"].GetString();
+    }
+    if (mock.HasMember("device_type") && mock["device_type"].IsUint()) {
+      config_.device_type = static_cast<uint8_t>(mock["device_type"].GetUint());
+    }
+    if (mock.HasMember("data_type") && mock["data_type"].IsUint()) {
+      config_.data_type = static_cast<uint8_t>(mock["data_type"].GetUint());
+    }
+    if (mock.HasMember("points_per_packet") && mock["points_per_packet"].IsUint()) {
+      config_.points_per_packet = mock["points_per_packet"].GetUint();
+    }
+    if (mock.HasMember("point_rate") && mock["point_rate"].IsUint()) {
+      config_.point_rate = mock["point_rate"].GetUint();
+    }
+    if (mock.HasMember("imu_rate") && mock["imu_rate"].IsUint()) {
+      config_.imu_rate = mock["imu_rate"].GetUint();
+    }
+    if (mock.HasMember("loss_rate") && mock["loss_rate"].IsNumber()) {
+      config_.loss_rate = mock["loss_rate"].GetDouble();
+    }
+    if (mock.HasMember("loss_burst") && mock["loss_burst"].IsUint()) {
+      config_.loss_burst = mock["loss_burst"].GetUint();
+    }
+    if (mock.HasMember("time_type") && mock["time_type"].IsUint()) {
+      config_.time_type = static_cast<uint8_t>(mock["time_type"].GetUint());
+    }
+    if (mock.HasMember("clock_skew_ppm") && mock["clock_skew_ppm"].IsNumber()) {
+      config_.clock_skew_ppm = mock["clock_skew_ppm"].GetDouble();
+    }
+    if (mock.HasMember("seed") && mock["seed"].IsUint()) {
+      config_.seed = mock["seed"].GetUint();
+    }
+  }
+  config_.points_per_packet = std::max(1u, std::min(config_.points_per_packet, kMaxPointsPerPacket));
+  config_.loss_burst = std::max(1u, config_.loss_burst);
+  config_.loss_rate = std::max(0.0, std::min(config_.loss_rate, 1.0));
+
+  std::vector<std::string> ips;
+  if (config_.lidar_count == 0) {
+    if (doc.HasMember("lidar_configs") && doc["lidar_configs"].IsArray()) {
+      const rapidjson::Value& lidar_configs = doc["lidar_configs"];
+      for (rapidjson::SizeType i = 0; i < lidar_configs.Size(); ++i) {
+        if (lidar_configs[i].HasMember("ip") && lidar_configs[i]["ip"].IsString()) {
+          ips.push_back(lidar_configs[i]["ip"].GetString());
+        }
+      }
+    }
+  } else {
+    uint32_t base_ip = ntohl(inet_addr(config_.base_ip.c_str()));
+    for (uint32_t i = 0; i < config_.lidar_count && i < kMaxLidarCount; ++i) {
+      struct in_addr addr;
+      addr.s_addr = htonl(base_ip + i);
+      ips.push_back(inet_ntoa(addr));
+    }
+  }
+  if (ips.empty()) {
+    printf("Livox mock sdk has no lidar, set mock_sdk.lidar_count or lidar_configs\n");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  lidars_.clear();
+  for (const auto& ip : ips) {
+    MockLidar lidar;
+    lidar.handle = inet_addr(ip.c_str());
+    lidar.ip = ip;
+    lidar.dev_type = config_.device_type;
+    lidar.data_type = config_.data_type;
+    lidar.is_announced = false;
+    lidar.is_sampling = false;
+    lidar.is_imu_enabled = false;
+    lidar.udp_cnt = 0;
+    lidar.loss_left = 0;
+    lidar.point_index = 0;
+    lidar.boot_offset = 0;
+    lidar.next_packet_time = 0;
+    lidar.next_imu_time = 0;
+    lidars_.push_back(lidar);
+  }
+  return true;
+}
+
+uint16_t MockSdk::AddObserver(LivoxLidarPointCloudObserver cb, void* client_data) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  uint16_t id = next_observer_id_++;
+  observers_[id] = std::make_pair(cb, client_data);
+  return id;
+}
+
+void MockSdk::RemoveObserver(uint16_t id) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  observers_.erase(id);
+}
+
+void MockSdk::SetInfoChangeCallback(LivoxLidarInfoChangeCallback cb, void* client_data) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  info_callback_ = cb;
+  info_client_data_ = client_data;
+}
+
+livox_status MockSdk::Control(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data,
+                              const std::function<void(MockLidar&)>& apply) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(lidars_.begin(), lidars_.end(),
+                         [handle](const MockLidar& lidar) { return lidar.handle == handle; });
+  if (it == lidars_.end()) {
+    return kLivoxLidarStatusNotConnected;
+  }
+  apply(*it);
+  if (cb != nullptr) {
+    pending_acks_.push_back([cb, handle, client_data]() {
+      LivoxLidarAsyncControlResponse response;
+      response.ret_code = 0;
+      response.error_key = 0;
+      cb(kLivoxLidarStatusSuccess, handle, &response, client_data);
+    });
+  }
+  return kLivoxLidarStatusSuccess;
+}
+
+void MockSdk::GenerateProcess() {
+  while (!is_quit_) {
+    AnnounceLidars();
+    RunPendingAcks();
+    uint64_t now = SteadyNs();
+    uint64_t next_time = SendDuePackets(now);
+    uint64_t sleep_until = std::min(next_time, now + kIdleSleepNs);
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds(sleep_until)));
+  }
+}
+
+void MockSdk::AnnounceLidars() {
+  LivoxLidarInfoChangeCallback info_callback = nullptr;
+  void* info_client_data = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    info_callback = info_callback_;
+    info_client_data = info_client_data_;
+  }
+  if (info_callback == nullptr) {
+    return;
+  }
+
+  std::vector<std::pair<uint32_t, LivoxLidarInfo>> announces;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < lidars_.size(); ++i) {
+      MockLidar& lidar = lidars_[i];
+      if (lidar.is_announced) {
+        continue;
+      }
+      lidar.is_announced = true;
+      LivoxLidarInfo info;
+      memset(&info, 0, sizeof(info));
+      info.dev_type = lidar.dev_type;
+      snprintf(info.sn, sizeof(info.sn), "MOCK%010u", static_cast<unsigned>(i));
+      snprintf(info.lidar_ip, sizeof(info.lidar_ip), "%s", lidar.ip.c_str());
+      announces.push_back(std::make_pair(lidar.handle, info));
+    }
+  }
+  for (const auto& announce : announces) {
+    info_callback(announce.first, &announce.second, info_client_data);
+  }
+}
+
+void MockSdk::RunPendingAcks() {
+  std::deque<std::function<void()>> acks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    acks.swap(pending_acks_);
+  }
+  for (auto& ack : acks) {
+    ack();
+  }
+}
+
+uint64_t MockSdk::SendDuePackets(uint64_t now) {
+  uint64_t next_time = now + kIdleSleepNs;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& lidar : lidars_) {
+    if (lidar.is_sampling) {
+      uint64_t packet_interval = 1000000000ULL * config_.points_per_packet / GetPointRate(lidar);
+      if (now > lidar.next_packet_time + kMaxCatchUpNs) {
+        lidar.next_packet_time = now - kMaxCatchUpNs;
+      }
+      while (lidar.next_packet_time <= now) {
+        SendPointPacket(lidar, lidar.next_packet_time);
+        lidar.next_packet_time += packet_interval;
+      }
+      next_time = std::min(next_time, lidar.next_packet_time);
+    }
+    if (lidar.is_imu_enabled && config_.imu_rate != 0) {
+      uint64_t imu_interval = 1000000000ULL / config_.imu_rate;
+      if (now > lidar.next_imu_time + kMaxCatchUpNs) {
+        lidar.next_imu_time = now - kMaxCatchUpNs;
+      }
+      while (lidar.next_imu_time <= now) {
+        SendImuPacket(lidar, lidar.next_imu_time);
+        lidar.next_imu_time += imu_interval;
+      }
+      next_time = std::min(next_time, lidar.next_imu_time);
+    }
+  }
+  return next_time;
+}
+
+void MockSdk::SendPointPacket(MockLidar& lidar, uint64_t now) {
+  uint32_t point_rate = GetPointRate(lidar);
+  uint32_t point_size = GetPointSize(lidar.data_type);
+  uint32_t dot_num = config_.points_per_packet;
+  uint64_t first_index = lidar.point_index;
+  lidar.point_index += dot_num;
+  if (IsLost(lidar)) {
+    return;
+  }
+
+  LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(packet_buffer_.data());
+  uint64_t device_time = GetDeviceTime(lidar, now);
+  packet->version = 0;
+  packet->length = static_cast<uint16_t>(kPacketHeaderSize + dot_num * point_size);
+  packet->time_interval = static_cast<uint16_t>(10000000ULL * dot_num / point_rate);  /**< 0.1 us */
+  packet->dot_num = static_cast<uint16_t>(dot_num);
+  packet->udp_cnt = lidar.udp_cnt - 1;
+  packet->frame_cnt = static_cast<uint8_t>(device_time / kFrameTimeNs);
+  packet->data_type = lidar.data_type;
+  packet->time_type = config_.time_type;
+  memcpy(packet->timestamp, &device_time, sizeof(device_time));
+
+  for (uint32_t i = 0; i < dot_num; ++i) {
+    uint64_t index = first_index + i;
+    double depth = 0.0;
+    double zenith = 0.0;
+    double azimuth = 0.0;
+    GetSyntheticPoint(lidar.dev_type, index, depth, zenith, azimuth);
+    double x = depth * sin(zenith * kDegToRad) * cos(azimuth * kDegToRad);
+    double y = depth * sin(zenith * kDegToRad) * sin(azimuth * kDegToRad);
+    double z = depth * cos(zenith * kDegToRad);
+    uint8_t reflectivity = static_cast<uint8_t>(index % 256);
+
+    if (lidar.data_type == kLivoxLidarCartesianCoordinateHighData) {
+      LivoxLidarCartesianHighRawPoint* point =
+          reinterpret_cast<LivoxLidarCartesianHighRawPoint*>(packet->data) + i;
+      point->x = static_cast<int32_t>(x);
+      point->y = static_cast<int32_t>(y);
+      point->z = static_cast<int32_t>(z);
+      point->reflectivity = reflectivity;
+      point->tag = 0;
+    } else if (lidar.data_type == kLivoxLidarCartesianCoordinateLowData) {
+      LivoxLidarCartesianLowRawPoint* point =
+          reinterpret_cast<LivoxLidarCartesianLowRawPoint*>(packet->data) + i;
+      point->x = static_cast<int16_t>(x / 10.0);
+      point->y = static_cast<int16_t>(y / 10.0);
+      point->z = static_cast<int16_t>(z / 10.0);
+      point->reflectivity = reflectivity;
+      point->tag = 0;
+    } else {
+      LivoxLidarSpherPoint* point = reinterpret_cast<LivoxLidarSpherPoint*>(packet->data) + i;
+      point->depth = static_cast<uint32_t>(depth);
+      point->theta = static_cast<uint16_t>(zenith * 100.0);
+      point->phi = static_cast<uint16_t>(azimuth * 100.0);
+      point->reflectivity = reflectivity;
+      point->tag = 0;
+    }
+  }
+  Deliver(lidar.handle, lidar.dev_type, packet);
+}
+
+void MockSdk::SendImuPacket(MockLidar& lidar, uint64_t now) {
+  LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(packet_buffer_.data());
+  uint64_t device_time = GetDeviceTime(lidar, now);
+  packet->version = 0;
+  packet->length = static_cast<uint16_t>(kPacketHeaderSize + sizeof(LivoxLidarImuRawPoint));
+  packet->time_interval = 0;
+  packet->dot_num = 1;
+  packet->udp_cnt = 0;
+  packet->frame_cnt = 0;
+  packet->data_type = kLivoxLidarImuData;
+  packet->time_type = config_.time_type;
+  memcpy(packet->timestamp, &device_time, sizeof(device_time));
+
+  double phase = (device_time % 1000000000ULL) * 2.0 * M_PI / 1000000000.0;
+  LivoxLidarImuRawPoint* imu = reinterpret_cast<LivoxLidarImuRawPoint*>(packet->data);
+  imu->gyro_x = static_cast<float>(0.01 * sin(phase));
+  imu->gyro_y = static_cast<float>(0.01 * cos(phase));
+  imu->gyro_z = 0.0f;
+  imu->acc_x = 0.0f;
+  imu->acc_y = 0.0f;
+  imu->acc_z = 1.0f;
+  Deliver(lidar.handle, lidar.dev_type, packet);
+}
+
+void MockSdk::Deliver(uint32_t handle, uint8_t dev_type, LivoxLidarEthernetPacket* packet) {
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  for (const auto& observer : observers_) {
+    observer.second.first(handle, dev_type, packet, observer.second.second);
+  }
+}
+
+bool MockSdk::IsLost(MockLidar& lidar) {
+  ++lidar.udp_cnt;
+  if (lidar.loss_left > 0) {
+    --lidar.loss_left;
+    return true;
+  }
+  if (config_.loss_rate <= 0.0) {
+    return false;
+  }
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  if (distribution(random_) < config_.loss_rate / config_.loss_burst) {
+    lidar.loss_left = config_.loss_burst - 1;
+    return true;
+  }
+  return false;
+}
+
+uint64_t MockSdk::GetDeviceTime(const MockLidar& lidar, uint64_t now) const {
+  uint64_t elapsed = now - start_time_;
+  if (config_.time_type != 0) {
+    return SystemNs() - (SteadyNs() - now);
+  }
+  return lidar.boot_offset + static_cast<uint64_t>(elapsed * (1.0 + config_.clock_skew_ppm * 1e-6));
+}
+
+uint32_t MockSdk::GetPointRate(const MockLidar& lidar) const {
+  if (config_.point_rate != 0) {
+    return config_.point_rate;
+  }
+  return (lidar.dev_type == kLivoxLidarTypeMid360) ? kMid360PointRate : kHapPointRate;
+}
+
+uint32_t MockSdk::GetPointSize(uint8_t data_type) const {
+  if (data_type == kLivoxLidarCartesianCoordinateHighData) {
+    return sizeof(LivoxLidarCartesianHighRawPoint);
+  } else if (data_type == kLivoxLidarCartesianCoordinateLowData) {
+    return sizeof(LivoxLidarCartesianLowRawPoint);
+  }
+  return sizeof(LivoxLidarSpherPoint);
+}
+
+}  // namespace livox_mock
@@ -0,0 +1,133 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Stand-in for the Livox SDK2, synthesizes lidar packets and calls the registered callbacks */
+
+#ifndef LIVOX_SDK_MOCK_MOCK_SDK_H_
+#define LIVOX_SDK_MOCK_MOCK_SDK_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "livox_lidar_api.h"
+#include "livox_lidar_def.h"
+
+namespace livox_mock {
+
+/** The "mock_sdk" section of the config passed to LivoxLidarSdkInit */
+typedef struct {
+  uint32_t lidar_count;       /**< 0 uses the ips of "lidar_configs", otherwise ips from base_ip up */
+  std::string base_ip;
+  uint8_t device_type;        /**< LivoxLidarDeviceType */
+  uint8_t data_type;          /**< Until set by SetLivoxLidarPclDataType */
+  uint32_t points_per_packet;
+  uint32_t point_rate;        /**< points/s of each lidar, 0 for the rate of the device type */
+  uint32_t imu_rate;          /**< Hz */
+  double loss_rate;           /**< Fraction of packets dropped, udp_cnt still advances */
+  uint32_t loss_burst;        /**< Consecutive packets dropped per loss event */
+  uint8_t time_type;          /**< 0 free-running device clock, 1 ptp, 2 gps */
+  double clock_skew_ppm;      /**< Drift of the free-running device clock */
+  uint32_t seed;
+} MockConfig;
+
+typedef struct {
+  uint32_t handle;
+  std::string ip;
+  uint8_t dev_type;
+  uint8_t data_type;
+  bool is_announced;
+  bool is_sampling;
+  bool is_imu_enabled;
+  uint16_t udp_cnt;
+  uint32_t loss_left;
+  uint64_t point_index;
+  uint64_t boot_offset;       /**< ns, device clock at mock start */
+  uint64_t next_packet_time;  /**< ns, steady clock */
+  uint64_t next_imu_time;
+} MockLidar;
+
+class MockSdk {
+ public:
+  static MockSdk& GetInstance();
+
+  bool Init(const char* config_path);
+  void Uninit();
+
+  uint16_t AddObserver(LivoxLidarPointCloudObserver cb, void* client_data);
+  void RemoveObserver(uint16_t id);
+  void SetInfoChangeCallback(LivoxLidarInfoChangeCallback cb, void* client_data);
+
+  /** Applies a control command and acknowledges it asynchronously, as the sdk does */
+  livox_status Control(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data,
+                       const std::function<void(MockLidar&)>& apply);
+
+ private:
+  MockSdk() = default;
+  MockSdk(const MockSdk&) = delete;
+  MockSdk& operator=(const MockSdk&) = delete;
+
+  bool ParseConfig(const char* config_path);
+  void GenerateProcess();
+  void AnnounceLidars();
+  void RunPendingAcks();
+  uint64_t SendDuePackets(uint64_t now);
+  void SendPointPacket(MockLidar& lidar, uint64_t now);
+  void SendImuPacket(MockLidar& lidar, uint64_t now);
+  void Deliver(uint32_t handle, uint8_t dev_type, LivoxLidarEthernetPacket* packet);
+  bool IsLost(MockLidar& lidar);
+  uint64_t GetDeviceTime(const MockLidar& lidar, uint64_t now) const;
+  uint32_t GetPointRate(const MockLidar& lidar) const;
+  uint32_t GetPointSize(uint8_t data_type) const;
+
+  MockConfig config_;
+  uint64_t start_time_ = 0;
+  std::mt19937 random_;
+  std::vector<uint8_t> packet_buffer_;
+
+  std::mutex mutex_;  /**< guards lidars_ and pending_acks_ */
+  std::vector<MockLidar> lidars_;
+  std::deque<std::function<void()>> pending_acks_;
+
+  std::mutex callback_mutex_;
+  std::map<uint16_t, std::pair<LivoxLidarPointCloudObserver, void*>> observers_;
+  uint16_t next_observer_id_ = 1;
+  LivoxLidarInfoChangeCallback info_callback_ = nullptr;
+  void* info_client_data_ = nullptr;
+
+  std::atomic<bool> is_quit_{false};
+  std::shared_ptr<std::thread> generate_thread_;
+};
+
+}  // namespace livox_mock
+
+#endif  // LIVOX_SDK_MOCK_MOCK_SDK_H_
@@ -0,0 +1,197 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+/** Live view of the statistics block a running driver keeps in shared memory (shm_stats_name) */
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "comm/shm_stats.h"
+
+using livox_ros::ShmLidarStats;
+using livox_ros::ShmStatsData;
+using livox_ros::ShmStatsReader;
+using livox_ros::ShmThreadStats;
+
+namespace {
+
+/** An update older than this marks the driver as stalled */
+const double kStaleSeconds = 3.0;
+
+volatile sig_atomic_t g_is_quit = 0;
+
+void SignalHandler(int signal) {
+  (void)signal;
+  g_is_quit = 1;
+}
+
+const char* GetConnectStateName(uint8_t state) {
+  switch (state) {
+    case 0: return "off";
+    case 1: return "on";
+    case 2: return "config";
+    case 3: return "sampling";
+    case 4: return "lost";
+    default: return "?";
+  }
+}
+
+const char* GetSyncTypeName(uint8_t time_type) {
+  switch (time_type) {
+    case 1: return "ptp";
+    case 2: return "gps";
+    default: return "none";
+  }
+}
+
+std::string GetIp(uint32_t handle) {
+  struct in_addr addr;
+  addr.s_addr = handle;
+  char ip[INET_ADDRSTRLEN] = {0};
+  inet_ntop(AF_INET, &addr, ip, sizeof(ip));
+  return ip;
+}
+
+double GetAge(const ShmStatsData& data) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  double now_sec = now.tv_sec + now.tv_nsec / 1e9;
+  return now_sec - data.update_time_ns / 1e9;
+}
+
+void Render(const std::string& name, const ShmStatsData& data, bool clear_screen) {
+  if (clear_screen) {
+    printf("\033[H\033[2J");
+  }
+  double age = GetAge(data);
+  bool is_alive = (kill(data.pid, 0) == 0);
+  printf("livox_top  %s  pid %d  publish_freq %.1f Hz  updated %.1f s ago%s\n", name.c_str(), data.pid,
+         data.publish_freq, age, !is_alive ? "  [driver exited]" : (age > kStaleSeconds ? "  [STALLED]" : ""));
+  printf("decode queue %u packets\n\n", data.raw_queue_depth);
+
+  printf("%-15s %-8s %-4s %9s %10s %8s %7s %11s %6s %9s %9s %7s %10s\n", "LIDAR", "STATE", "SYNC", "PKT/s",
+         "PTS/s", "IMU/s", "FPS", "QUEUE", "IMU_Q", "DROPPED", "LOST", "REORD", "DRIFT_PPM");
+  for (uint32_t i = 0; i < data.lidar_num && i < livox_ros::kShmStatsMaxLidars; ++i) {
+    const ShmLidarStats& lidar = data.lidars[i];
+    char queue[24];
+    snprintf(queue, sizeof(queue), "%u/%u", lidar.queue_depth, lidar.queue_size);
+    bool is_slow = lidar.connect_state == 3 && lidar.frame_rate < 0.9 * data.publish_freq;
+    printf("%-15s %-8s %-4s %9.0f %10.0f %8.0f %6.1f%s %11s %6u %9llu %9llu %7llu %10.2f\n",
+           GetIp(lidar.handle).c_str(), GetConnectStateName(lidar.connect_state), GetSyncTypeName(lidar.time_type),
+           lidar.packet_rate, lidar.point_rate, lidar.imu_rate, lidar.frame_rate, is_slow ? "!" : " ", queue,
+           lidar.imu_queue_depth, static_cast<unsigned long long>(lidar.dropped_frames),
+           static_cast<unsigned long long>(lidar.lost_packets),
+           static_cast<unsigned long long>(lidar.reordered_packets), lidar.clock_drift_ppm);
+  }
+
+  std::vector<ShmThreadStats> threads(data.threads,
+      data.threads + std::min(data.thread_num, livox_ros::kShmStatsMaxThreads));
+  std::sort(threads.begin(), threads.end(), [](const ShmThreadStats& a, const ShmThreadStats& b) {
+    return a.cpu_usage > b.cpu_usage;
+  });
+  printf("\n%-8s %-16s %7s %11s\n", "TID", "THREAD", "CPU%", "CPU_TIME_s");
+  for (const ShmThreadStats& thread : threads) {
+    printf("%-8d %-16.16s %7.1f %11.2f\n", thread.tid, thread.name, thread.cpu_usage * 100.0,
+           thread.cpu_time_ns / 1e9);
+  }
+  fflush(stdout);
+}
+
+void PrintUsage(const char* name) {
+  printf("Usage: %s [options]\n"
+         "  -n, --name NAME       shared memory name, the shm_stats_name of the driver (livox_ros_driver2)\n"
+         "  -d, --delay SEC       refresh interval (1)\n"
+         "  -1, --once            print once and exit\n",
+         name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string name = "livox_ros_driver2";
+  double delay = 1.0;
+  bool is_once = false;
+
+  const struct option long_options[] = {
+    {"name", required_argument, nullptr, 'n'},
+    {"delay", required_argument, nullptr, 'd'},
+    {"once", no_argument, nullptr, '1'},
+    {"help", no_argument, nullptr, 'h'},
+    {nullptr, 0, nullptr, 0}
+  };
+  int opt = 0;
+  while ((opt = getopt_long(argc, argv, "n:d:1h", long_options, nullptr)) != -1) {
+    switch (opt) {
+      case 'n': name = optarg; break;
+      case 'd': delay = std::max(0.1, atof(optarg)); break;
+      case '1': is_once = true; break;
+      default:
+        PrintUsage(argv[0]);
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  signal(SIGINT, SignalHandler);
+  signal(SIGTERM, SignalHandler);
+
+  ShmStatsReader reader;
+  bool is_open = false;
+  while (!g_is_quit) {
+    ShmStatsData data;
+    /** the driver unlinks and recreates the block when restarted, so reopen until it reads */
+    if (!is_open) {
+      is_open = reader.Open(name);
+    }
+    if (is_open && reader.Read(data)) {
+      Render(livox_ros::GetShmStatsPath(name), data, !is_once);
+      if (data.pid > 0 && kill(data.pid, 0) != 0) {
+        reader.Close();
+        is_open = false;
+      }
+    } else {
+      if (!is_once) {
+        printf("\033[H\033[2J");
+      }
+      printf("waiting for %s, is the driver running with shm_stats_name set?\n",
+             livox_ros::GetShmStatsPath(name).c_str());
+      fflush(stdout);
+      reader.Close();
+      is_open = false;
+    }
+    if (is_once) {
+      return is_open ? 0 : 1;
+    }
+    usleep(static_cast<useconds_t>(delay * 1e6));
+  }
+  return 0;
+}